@@ -15,6 +15,13 @@ int main(int argc, char* argv[])
     app.require_subcommand(1); // require 1 connection type subcommand
     auto display_version = [](int) { std::cout << "DNP3 Client Action Library " << PROJECT_VER << std::endl; };
     app.add_flag_function("--version", display_version, "display version");
+    auto flush_interval = [](unsigned int ms) {
+        StdErrSink::Instance().SetFlushInterval(std::chrono::milliseconds(ms));
+    };
+    app.add_option_function<unsigned int>("--log-flush-interval",
+                                          flush_interval,
+                                          "milliseconds between writes of the log to stderr (default: 50)")
+        ->check(CLI::PositiveNumber);
 
     opendnp3::DNP3Manager manager(1, StdErrLogger::Create());
     std::shared_ptr<opendnp3::IMaster> client;
@@ -8,11 +8,24 @@
 
 #include <date/date.h>
 
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 class SOEHandler : public opendnp3::ISOEHandler
 {
@@ -340,6 +353,253 @@ public:
     }
 };
 
+/**
+ * LogRecord is a log message captured without formatting it.
+ *
+ * Loggers only copy the message into a record on the thread logging it;
+ * the text is built by FormatLogRecord for the lines actually shown or
+ * written. Records are reused, so once their strings have grown large
+ * enough capturing a message does not allocate.
+ */
+struct LogRecord
+{
+    std::chrono::system_clock::time_point time;
+    opendnp3::LogLevel level = opendnp3::flags::INFO;
+    char const* location = nullptr; // only kept when the location is printed
+    std::string id;
+    std::string message;
+
+    void Capture(std::chrono::system_clock::time_point now,
+                 const char* id,
+                 opendnp3::LogLevel level,
+                 char const* location,
+                 char const* message)
+    {
+        this->time = now;
+        this->level = level;
+        this->location = location;
+        this->id.assign(id);
+        this->message.assign(message);
+    }
+};
+
+inline std::string FormatLogRecord(const LogRecord& record)
+{
+    using namespace date;
+    std::ostringstream oss;
+
+    oss << record.time << "Z ";
+    oss << "[ " << LogFlagToString(record.level) << "] ";
+    oss << "(" << record.id << ") ";
+    if (record.location)
+    {
+        oss << record.location << " ";
+    }
+    oss << record.message;
+    return oss.str();
+}
+
+/**
+ * StdErrSink writes log records to stderr from a thread of its own.
+ *
+ * Every StdErrLogger of the process pushes its records into the sink's
+ * bounded ring, so their lines stay in order. Pushing is lock-free: the
+ * ring is a multi-producer queue of preallocated slots, each with a
+ * sequence number telling whose turn it is to use it. A record pushed while
+ * the ring is full is dropped and counted. Every flush interval the writer
+ * thread formats the pending records and writes them in batches, reporting
+ * how many were dropped since its last write; it is woken early when half of
+ * the ring has been filled. Records still pending when
+ * the process exits are written first.
+ */
+class StdErrSink
+{
+public:
+    static constexpr size_t CAPACITY = 8192; // a power of two
+    static constexpr size_t BATCH_BYTES = 64 * 1024;
+    static constexpr std::chrono::milliseconds DEFAULT_FLUSH_INTERVAL{50};
+
+    static StdErrSink& Instance()
+    {
+        static StdErrSink sink;
+        return sink;
+    }
+
+    void Push(const char* id, opendnp3::LogLevel level, char const* location, char const* message)
+    {
+        auto now = std::chrono::system_clock::now();
+
+        // Claim the next slot once the writer has released it
+        auto pos = enqueuePos.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true)
+        {
+            slot = &slots[pos & (CAPACITY - 1)];
+            auto sequence = slot->sequence.load(std::memory_order_acquire);
+            if (sequence == pos)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (sequence < pos)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->record.Capture(now, id, level, location, message);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+
+        // Wake the writer early every half ring, so bursts are written before the ring fills
+        if ((pos & (CAPACITY / 2 - 1)) == CAPACITY / 2 - 1)
+        {
+            wake.notify_one();
+        }
+    }
+
+    void SetFlushInterval(std::chrono::milliseconds interval)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        flushInterval = interval;
+    }
+
+    uint64_t NumDropped() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    ~StdErrSink()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        writer.join();
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence{0};
+        LogRecord record;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<size_t> enqueuePos{0};
+    size_t dequeuePos = 0; // only used by the writer
+    std::atomic<uint64_t> dropped{0};
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::chrono::milliseconds flushInterval = DEFAULT_FLUSH_INTERVAL;
+    bool stopping = false;
+    std::thread writer;
+
+    StdErrSink() : slots(new Slot[CAPACITY])
+    {
+        for (size_t i = 0; i < CAPACITY; ++i)
+        {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        writer = std::thread([this]() { Run(); });
+    }
+
+    void Run()
+    {
+        std::string text;
+        text.reserve(2 * BATCH_BYTES);
+        uint64_t reported = 0;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            // Whatever was pushed before stopping is written by this last pass
+            auto last = stopping;
+            lock.unlock();
+
+            Drain(text);
+            auto lost = dropped.load(std::memory_order_relaxed);
+            if (lost != reported)
+            {
+                LogRecord notice;
+                auto message = std::to_string(lost - reported) + " log messages dropped";
+                notice.Capture(std::chrono::system_clock::now(), "logger", opendnp3::flags::WARN, nullptr,
+                               message.c_str());
+                text += FormatLogRecord(notice);
+                text += '\n';
+                reported = lost;
+            }
+            WriteOut(text);
+
+            lock.lock();
+            if (last)
+            {
+                return;
+            }
+            if (!stopping)
+            {
+                wake.wait_for(lock, flushInterval);
+            }
+        }
+    }
+
+    void Drain(std::string& text)
+    {
+        while (true)
+        {
+            auto& slot = slots[dequeuePos & (CAPACITY - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+            {
+                return;
+            }
+
+            text += FormatLogRecord(slot.record);
+            text += '\n';
+            slot.sequence.store(dequeuePos + CAPACITY, std::memory_order_release);
+            dequeuePos++;
+
+            if (text.size() >= BATCH_BYTES)
+            {
+                WriteOut(text);
+            }
+        }
+    }
+
+    static void WriteOut(std::string& text)
+    {
+#ifdef _WIN32
+        std::fwrite(text.data(), 1, text.size(), stderr);
+        std::fflush(stderr);
+#else
+        const char* data = text.data();
+        size_t remaining = text.size();
+        while (remaining > 0)
+        {
+            auto written = ::write(STDERR_FILENO, data, remaining);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                break;
+            }
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+#endif
+        text.clear();
+    }
+};
+
 class StdErrLogger final : public opendnp3::ILogHandler, public opendnp3::IChannelListener
 {
 public:
@@ -351,21 +611,7 @@ public:
              char const* location,
              char const* message) override
     {
-        using namespace date;
-        std::ostringstream oss;
-
-        auto now = std::chrono::system_clock::now();
-        oss << now << "Z ";
-        oss << "[ " << LogFlagToString(level) << "] ";
-        oss << "(" << id << ") ";
-        if (printLocation)
-        {
-            oss << location << " ";
-        }
-        oss << message;
-
-        std::unique_lock<std::mutex> lock(mutex);
-        std::cerr << oss.str() << std::endl;
+        StdErrSink::Instance().Push(id, level, printLocation ? location : nullptr, message);
     }
 
     static std::shared_ptr<StdErrLogger> Create(bool printLocation = false)
@@ -375,17 +621,12 @@ public:
 
     void OnStateChange(opendnp3::ChannelState state) override
     {
-        using namespace date;
-
-        auto now = std::chrono::system_clock::now();
-        std::cerr << now
-                  << "Z [ INFO   ] (channel) state change: " << opendnp3::ChannelStateSpec::to_human_string(state)
-                  << std::endl;
+        auto message = std::string("state change: ") + opendnp3::ChannelStateSpec::to_human_string(state);
+        StdErrSink::Instance().Push("channel", opendnp3::flags::INFO, nullptr, message.c_str());
     }
 
 private:
     bool printLocation;
-    std::mutex mutex;
 };
 
 class ResultCallback : public opendnp3::StaticOnly
@@ -0,0 +1,182 @@
+#include "outstation/historian.h"
+#include "outstation/point_index.h"
+
+#include <CLI11/CLI11.hpp>
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace
+{
+PointType pointType(EventType type)
+{
+    switch (type)
+    {
+    case EventType::BINARY:
+        return PointType::BINARY_INPUT;
+    case EventType::DOUBLE_BIT:
+        return PointType::DOUBLE_BIT_INPUT;
+    case EventType::ANALOG:
+        return PointType::ANALOG_INPUT;
+    default:
+        return PointType::UNDEFINED;
+    }
+}
+
+// ISO 8601 in UTC with milliseconds
+std::string formatTime(uint64_t ms)
+{
+    auto seconds = static_cast<std::time_t>(ms / 1000);
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+    char text[32];
+    auto length = std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &utc);
+    std::snprintf(text + length, sizeof(text) - length, ".%03uZ", static_cast<unsigned>(ms % 1000));
+    return text;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string input;
+    std::string output;
+    std::optional<double> from;
+    std::optional<double> to;
+    std::string typeName;
+    std::optional<uint16_t> index;
+    bool wide = false;
+
+    CLI::App cli{"MITRE Caldera for OT DNP3 Historian Export"};
+    cli.add_option("file", input, "historian file recorded by the outstation")->required();
+    cli.add_option("-o,--output", output, "CSV file to write (default: standard output)");
+    cli.add_option("--from", from, "first time to export, in seconds since the epoch");
+    cli.add_option("--to", to, "time to stop exporting at, in seconds since the epoch");
+    cli.add_option("--type", typeName, "only export one point type (bi, dbi or ai)")
+        ->check(CLI::IsMember({"bi", "dbi", "ai"}));
+    cli.add_option("--index", index, "only export the points with this index");
+    cli.add_flag("--wide", wide,
+                 "write one column per point and one row per timestamp, the format read by --playback");
+    CLI11_PARSE(cli, argc, argv);
+
+    auto type = typeName.empty() ? PointType::UNDEFINED : PointTypeSpec::from_string(typeName);
+    auto fromMs = from.has_value() ? static_cast<uint64_t>(*from * 1000.0) : 0;
+    auto toMs = to.has_value() ? static_cast<uint64_t>(*to * 1000.0) : UINT64_MAX;
+
+    std::ofstream file;
+    if (!output.empty())
+    {
+        file.open(output);
+        if (!file.is_open())
+        {
+            std::cerr << "cannot open " << output << std::endl;
+            std::cout << "failed to write the export, exiting" << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = output.empty() ? std::cout : file;
+
+    auto selected = [&](const HistorianRecord& record) {
+        auto recordType = pointType(record.type);
+        return (record.time >= fromMs) && (record.time < toMs)
+            && ((type == PointType::UNDEFINED) || (recordType == type))
+            && (!index.has_value() || (record.index == *index));
+    };
+
+    try
+    {
+        HistorianRecord record;
+        out.precision(15);
+
+        if (!wide)
+        {
+            HistorianReader reader(input);
+            out << "timestamp,type,index,value,flags\n";
+            while (reader.Next(record))
+            {
+                if (selected(record))
+                {
+                    out << formatTime(record.time) << ',' << PointTypeSpec::to_string(pointType(record.type)) << ','
+                        << record.index << ',' << record.value << ',' << static_cast<unsigned>(record.flags) << '\n';
+                }
+            }
+            return EXIT_SUCCESS;
+        }
+
+        // The columns are only known once the whole log has been read, so it is read twice
+        // rather than held in memory
+        std::map<std::pair<PointType, uint16_t>, size_t> columns;
+        {
+            HistorianReader reader(input);
+            while (reader.Next(record))
+            {
+                if (selected(record))
+                {
+                    columns.emplace(std::make_pair(pointType(record.type), record.index), 0);
+                }
+            }
+        }
+
+        out << "timestamp";
+        size_t column = 0;
+        for (auto& entry : columns)
+        {
+            entry.second = column++;
+            out << ',' << PointTypeSpec::to_string(entry.first.first) << ':' << entry.first.second;
+        }
+        out << '\n';
+
+        // Points that did not change at a timestamp are left empty, which playback leaves unchanged
+        std::vector<std::optional<double>> row(columns.size());
+        std::optional<uint64_t> rowTime;
+        auto flush = [&]() {
+            if (!rowTime.has_value())
+            {
+                return;
+            }
+            out << formatTime(*rowTime);
+            for (auto& cell : row)
+            {
+                out << ',';
+                if (cell.has_value())
+                {
+                    out << *cell;
+                }
+                cell.reset();
+            }
+            out << '\n';
+        };
+
+        HistorianReader reader(input);
+        while (reader.Next(record))
+        {
+            if (!selected(record))
+            {
+                continue;
+            }
+            if (rowTime != record.time)
+            {
+                flush();
+                rowTime = record.time;
+            }
+            row[columns.at(std::make_pair(pointType(record.type), record.index))] = record.value;
+        }
+        flush();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cout << "failed to read the historian, exiting" << std::endl;
+        return 1;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,144 +1,609 @@
 #include "logger.hpp"
+#include "outstation/application.h"
+#include "outstation/control_api.h"
+#include "outstation/control_server.h"
+#include "outstation/historian.h"
 #include "outstation/io_table.h"
+#include "outstation/metrics.h"
+#include "outstation/metrics_server.h"
+#include "outstation/playback.h"
+#include "outstation/point_history.h"
+#include "outstation/profile.h"
+#include "outstation/resources.h"
+#include "outstation/shared_points.h"
+#include "outstation/state_region.h"
+
+#ifndef DNP3_OUTSTATION_HEADLESS
 #include "ui/renderer.h"
+#endif
 
 #include <opendnp3/DNP3Manager.h>
-#include <opendnp3/outstation/DefaultOutstationApplication.h>
 
 #include <CLI11/CLI11.hpp>
 #include <fcntl.h>
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <csignal>
 #include <cstdio>
+#include <iomanip>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// Ends the process once stdin is closed: set by SIGINT or SIGTERM, or by `quit` on the control socket
+volatile std::sig_atomic_t signalled = 0;
+std::atomic<bool> quitRequested{false};
+
+void onSignal(int)
+{
+    signalled = 1;
+}
+
+struct HostedOutstation
+{
+    std::string endpoint;
+    std::shared_ptr<Profile> profile;
+    std::shared_ptr<opendnp3::IChannel> channel;
+    std::shared_ptr<opendnp3::IOutstation> outstation;
+    uint16_t linkAddr;
+    ResourceUsage usage;        // of the outstation, including its channel when it is the first drop
+    ResourceUsage profileUsage; // of its profile instance alone
+    std::shared_ptr<SharedPointBridge> bridge;
+    std::shared_ptr<Historian> historian;
+    std::shared_ptr<OutstationMetrics> metrics;
+};
+
+void printUsage(const std::vector<HostedOutstation>& hosts, const ResourceUsage& baseline, size_t pointsPerOutstation)
+{
+    auto total = ResourceUsage::Read();
+    auto used = total - baseline;
+    size_t profileKb = 0;
+    for (size_t i = 0; i < hosts.size(); ++i)
+    {
+        std::cout << "outstation " << std::setw(4) << i << "  " << std::setw(21) << std::left << hosts[i].endpoint
+                  << std::right << "  link " << std::setw(5) << hosts[i].linkAddr << "  rss +" << hosts[i].usage.rssKb
+                  << " KiB (profile +" << hosts[i].profileUsage.rssKb << " KiB)  threads +" << hosts[i].usage.threads
+                  << std::endl;
+        profileKb += hosts[i].profileUsage.rssKb;
+    }
+    std::cout << "total: " << hosts.size() << " outstations, rss " << total.rssKb << " KiB (+" << used.rssKb
+              << " KiB), " << total.threads << " threads" << std::endl;
+
+    // Only the profile instances count: channels, stacks and threads are not per point
+    auto points = hosts.size() * pointsPerOutstation;
+    if (points > 0)
+    {
+        std::cout << "memory per point: " << profileKb * 1024 / points << " bytes, measured over the profile instances"
+                  << std::endl;
+    }
+}
+
+void printEvents(const std::vector<HostedOutstation>& hosts)
+{
+    // Counters are summed over all outstations; peak is the largest of any single outstation
+    for (auto type : {EventType::BINARY, EventType::DOUBLE_BIT, EventType::ANALOG})
+    {
+        EventCounters sum;
+        for (const auto& host : hosts)
+        {
+            auto counters = host.profile->GetIOTable()->GetEventStats()->Get(type);
+            sum.capacity = counters.capacity;
+            sum.queued += counters.queued;
+            sum.confirmed += counters.confirmed;
+            sum.occupancy += counters.occupancy;
+            sum.peak = std::max(sum.peak, counters.peak);
+            sum.overflows += counters.overflows;
+        }
+        std::cout << std::setw(18) << std::left << EventTypeSpec::to_human_string(type) << std::right
+                  << "  size " << std::setw(5) << sum.capacity << "  queued " << std::setw(8) << sum.queued
+                  << "  confirmed " << std::setw(8) << sum.confirmed << "  buffered " << std::setw(6) << sum.occupancy
+                  << "  peak " << std::setw(5) << sum.peak << "  overflows " << sum.overflows << std::endl;
+    }
+}
+} // namespace
 
 int main(int argc, char* argv[])
 {
+#ifndef DNP3_OUTSTATION_HEADLESS
     bool tuiEnabled = false;
-    std::string addr = "127.0.0.1";
+    size_t logLines = LogDisplayer::DEFAULT_CAPACITY;
+    unsigned int tuiFps = RedrawCoalescer::DEFAULT_FPS;
+    size_t historyDepth = PointHistory::DEFAULT_DEPTH;
+#endif
+    std::vector<std::string> addrs = {"127.0.0.1"};
     uint16_t clientLink = 1;
     uint16_t outstationLink = 1024;
     uint16_t port = 20000;
+    size_t numOutstations = 1;
+    size_t numDrops = 1;
+    uint32_t numThreads = 1;
+    bool pinThreads = false;
+    size_t simThreads = 1;
+    double clockScale = 1.0;
+    bool freeRun = false;
+    uint64_t seed = 0;
+    unsigned int analogInterval = 1000;
+    bool powerModel = false;
+    uint16_t eventBuffer = 10;
+    uint16_t binaryEvents = 0;
+    uint16_t doubleBitEvents = 0;
+    uint16_t analogEvents = 0;
+    std::string controlSocket;
+    std::string sharedMemory;
+    unsigned int sharedInterval = 10;
+    std::string playbackFile;
+    double playbackSpeed = 1.0;
+    std::string historianFile;
+    std::optional<uint16_t> metricsPort;
+    std::string metricsAddress = "127.0.0.1";
+    std::string metricsJson;
+    unsigned int metricsInterval = 10;
+    unsigned int logFlushInterval = 50;
+    std::string publishState;
+    unsigned int publishInterval = 50;
 
     auto logLevels = opendnp3::levels::NORMAL | opendnp3::levels::ALL_COMMS;
 
     CLI::App cli{"MITRE Caldera for OT DNP3 Outstation Simulator"};
+#ifndef DNP3_OUTSTATION_HEADLESS
     cli.add_flag("--tui", tuiEnabled, "enable the outstation visualization");
-    cli.add_option("--ip", addr, "IP address to serve the outstation on (default: 127.0.0.1)")->check(CLI::ValidIPV4);
-    cli.add_option("-p,--port", port, "port number of the outstation (default: 20000)");
+    cli.add_option("--log-lines", logLines, "number of log lines kept by the visualization (default: 10000)")
+        ->check(CLI::PositiveNumber);
+    cli.add_option("--tui-fps", tuiFps, "maximum redraws per second of the visualization (default: 30)")
+        ->check(CLI::PositiveNumber);
+    cli.add_option("--history-depth", historyDepth, "changes of each point kept for the trends (default: 64)")
+        ->check(CLI::PositiveNumber);
+#endif
+    cli.add_option("--ip", addrs, "IP address(es) to serve the outstations on (default: 127.0.0.1)")
+        ->check(CLI::ValidIPV4);
+    cli.add_option("-p,--port", port, "port number of the first outstation (default: 20000)");
     cli.add_option("--local", clientLink, "link layer address of the DNP3 client (default: 1)");
-    cli.add_option("--remote", outstationLink, "link layer address of the DNP3 outstation (default: 1024)");
+    cli.add_option("--remote", outstationLink, "link layer address of the (first) DNP3 outstation (default: 1024)");
+    cli.add_option("-n,--outstations",
+                   numOutstations,
+                   "number of outstation servers, spread across the IP addresses, then ports (default: 1)")
+        ->check(CLI::PositiveNumber);
+    cli.add_option("--drops",
+                   numDrops,
+                   "number of outstations sharing each channel, on consecutive link addresses (default: 1)")
+        ->check(CLI::PositiveNumber);
+    cli.add_option("--threads", numThreads, "number of threads serving DNP3 communications (default: 1)")
+        ->check(CLI::PositiveNumber);
+    cli.add_flag("--pin-threads", pinThreads, "pin each communication thread to its own CPU (Linux only)");
+    cli.add_option("--sim-threads", simThreads, "number of threads running device simulation (default: 1)")
+        ->check(CLI::PositiveNumber);
+    cli.add_option("--clock-scale", clockScale, "run the simulation clock faster than real time (default: 1)")
+        ->check(CLI::PositiveNumber);
+    cli.add_flag("--free-run", freeRun, "advance the simulation clock to each deadline without waiting");
+    auto seedOpt = cli.add_option("--seed", seed, "seed for generated analog noise (default: random)");
+    cli.add_option("--analog-interval", analogInterval, "milliseconds between generated analog updates (default: 1000)")
+        ->check(CLI::PositiveNumber);
+    cli.add_option("--event-buffer", eventBuffer, "event buffer size for every point type (default: 10)");
+    auto binaryEventsOpt = cli.add_option("--binary-events", binaryEvents, "binary input event buffer size");
+    auto doubleBitEventsOpt
+        = cli.add_option("--double-bit-events", doubleBitEvents, "double-bit binary input event buffer size");
+    auto analogEventsOpt = cli.add_option("--analog-events", analogEvents, "analog input event buffer size");
+    cli.add_flag("--power-model", powerModel, "derive bus voltage, frequency and feeder loads from breaker states");
+    cli.add_option("--control-socket", controlSocket, "UNIX socket path serving the point control protocol");
+    cli.add_option("--shared-memory",
+                   sharedMemory,
+                   "file to map for co-simulation; outstations after the first add -<n> to the name");
+    cli.add_option("--shared-interval", sharedInterval, "milliseconds between shared memory scans (default: 10)")
+        ->check(CLI::PositiveNumber);
+    cli.add_option("--playback", playbackFile, "CSV recording replayed into the points of the first outstation");
+    cli.add_option("--playback-speed", playbackSpeed, "playback speed relative to the recording (default: 1)")
+        ->check(CLI::PositiveNumber);
+    cli.add_option("--historian",
+                   historianFile,
+                   "file recording every point change; outstations after the first add -<n> to the name");
+    cli.add_option("--metrics-port", metricsPort, "port serving /metrics (Prometheus) and /metrics.json over HTTP");
+    cli.add_option("--metrics-address", metricsAddress, "address serving the metrics (default: 127.0.0.1)")
+        ->check(CLI::ValidIPV4);
+    cli.add_option("--metrics-json", metricsJson, "file the metrics are written to as JSON periodically");
+    cli.add_option("--metrics-interval", metricsInterval, "seconds between JSON metrics dumps (default: 10)")
+        ->check(CLI::PositiveNumber);
+    cli.add_option("--publish-state",
+                   publishState,
+                   "file the state of the first outstation is published to, for dnp3-outstation-view");
+    cli.add_option("--publish-interval", publishInterval, "milliseconds between state publications (default: 50)")
+        ->check(CLI::PositiveNumber);
+    cli.add_option("--log-flush-interval",
+                   logFlushInterval,
+                   "milliseconds between writes of the log to stderr (default: 50)")
+        ->check(CLI::PositiveNumber);
     CLI11_PARSE(cli, argc, argv);
 
-    std::shared_ptr<TuiRenderer> tui = nullptr;
+    // Outstations fill every IP address on one port before moving to the next port
+    size_t lastPort = port + (numOutstations - 1) / addrs.size();
+    if (lastPort > UINT16_MAX)
+    {
+        std::cout << "not enough ports for " << numOutstations << " servers, exiting" << std::endl;
+        return 1;
+    }
+
+    // DNP3 link addresses above 0xFFEF are reserved
+    if (outstationLink + numDrops - 1 > 0xFFEF)
+    {
+        std::cout << "not enough link addresses for " << numDrops << " drops, exiting" << std::endl;
+        return 1;
+    }
+
     std::shared_ptr<opendnp3::ILogHandler> logHandler;
     std::shared_ptr<opendnp3::IChannelListener> chListener;
 
+#ifndef DNP3_OUTSTATION_HEADLESS
+    std::shared_ptr<TuiRenderer> tui = nullptr;
     if (tuiEnabled)
     {
         tui = TuiRenderer::Create();
+        tui->SetLogCapacity(logLines);
+        tui->SetFrameRate(tuiFps);
         auto logger = tui->GetLogger();
         logHandler = logger;
         chListener = logger;
     }
     else
+#endif
     {
+        StdErrSink::Instance().SetFlushInterval(std::chrono::milliseconds(logFlushInterval));
         auto logger = StdErrLogger::Create();
         logHandler = logger;
         chListener = logger;
     }
 
-    const int numThreads = 1;
-    opendnp3::DNP3Manager manager(numThreads, logHandler);
-    auto channel = std::shared_ptr<opendnp3::IChannel>(nullptr);
-    auto ip = opendnp3::IPEndpoint(addr, port);
-    try
+    // Application headers are counted from the log before it is displayed
+    std::shared_ptr<MetricsRegistry> metrics;
+    bool collectMetrics = metricsPort.has_value() || !metricsJson.empty();
+#ifndef DNP3_OUTSTATION_HEADLESS
+    collectMetrics = collectMetrics || tuiEnabled;
+#endif
+    if (collectMetrics)
     {
-        channel = manager.AddTCPServer("server", logLevels, opendnp3::ServerAcceptMode::CloseExisting, ip, chListener);
+        // opendnp3 has no hook for every request, so the header levels stay on whatever else is logged
+        metrics = MetricsRegistry::Create();
+        logHandler = MetricsLogTap::Create(logHandler, metrics);
+        logLevels = logLevels | opendnp3::flags::APP_HEADER_RX | opendnp3::flags::APP_HEADER_TX;
     }
-    catch (const std::exception& e)
+
+    // Viewers read the log from the published state as well, once it is created
+    std::shared_ptr<StateLogTap> stateLog;
+    if (!publishState.empty())
     {
-        std::cerr << e.what() << std::endl;
-        std::cout << "failed to start server, exiting" << std::endl;
-        return 1;
+        stateLog = StateLogTap::Create(logHandler);
+        logHandler = stateLog;
     }
 
-    // Add devices to the outstation
-    auto table = IOTable::Create();
-    std::vector<std::shared_ptr<IDevice>> devices;
+    auto baseline = ResourceUsage::Read();
 
-    auto temp = table->CreateSetpointController("Temperature", 62, 0.5, true);
-    devices.push_back(temp);
+    auto onThreadStart = [pinThreads](uint32_t id) {
+        if (pinThreads)
+        {
+            PinCurrentThread(id);
+        }
+    };
+    opendnp3::DNP3Manager manager(numThreads, logHandler, onThreadStart);
 
-    auto voltage = table->CreateSetpointController("Voltage", 480, 0.4, false);
-    devices.push_back(voltage);
+    // Install the simulation clock before any device timeline or timestamp is created
+    auto clockMode = ClockMode::REAL_TIME;
+    if (freeRun)
+    {
+        clockMode = ClockMode::FREE_RUN;
+    }
+    else if (clockScale != 1.0)
+    {
+        clockMode = ClockMode::SCALED;
+    }
+    SimClock::SetDefault(SimClock::Create(clockMode, clockScale));
 
-    auto freq = table->CreateSetpointController("Frequency", 60, 0.2, false);
-    devices.push_back(freq);
+    // All outstations share one simulation scheduler
+    auto scheduler = Scheduler::Create(simThreads, SimClock::Default());
 
-    for (int i = 0; i < 5; ++i)
+    // Every outstation is an instance of the same template
+    ProfileOptions options;
+    options.powerModel = powerModel;
+    options.analogInterval = std::chrono::milliseconds(analogInterval);
+    options.eventBuffers = opendnp3::EventBufferConfig::AllTypes(eventBuffer);
+    if (*binaryEventsOpt)
+    {
+        options.eventBuffers.max_binary_events = binaryEvents;
+    }
+    if (*doubleBitEventsOpt)
+    {
+        options.eventBuffers.max_double_binary_events = doubleBitEvents;
+    }
+    if (*analogEventsOpt)
     {
-        auto name = "Device " + std::to_string(i);
-        auto device = table->CreateSimpleDevice(name);
-        devices.push_back(device);
+        options.eventBuffers.max_analog_events = analogEvents;
     }
+    auto profileTemplate = ProfileTemplate::Create(scheduler, options);
 
-    int breaker_num = 0;
-    for (int i = 0; i < 5; ++i)
+    // One stack configuration serves every outstation; only the link address changes from one to the next
+    opendnp3::OutstationStackConfig config(profileTemplate->GetDatabaseConfig());
+    config.outstation.eventBufferConfig = options.eventBuffers;
+    config.outstation.params.allowUnsolicited = true;
+    config.link.KeepAliveTimeout = opendnp3::TimeDuration::Max();
+    config.link.RemoteAddr = clientLink;
+
+    std::vector<HostedOutstation> hosts;
+    size_t total = numOutstations * numDrops;
+    for (size_t i = 0; i < numOutstations; ++i)
     {
-        auto name = "Breaker " + std::to_string(breaker_num);
-        auto device = table->CreateBreaker(name, TwoSignalControlModel::COMPLEMENTARY_TWO_OUTPUT);
-        devices.push_back(device);
-        breaker_num++;
+        auto before = ResourceUsage::Read();
+
+        auto addr = addrs[i % addrs.size()];
+        auto ip = opendnp3::IPEndpoint(addr, static_cast<uint16_t>(port + i / addrs.size()));
+        auto endpoint = addr + ":" + std::to_string(ip.port);
+        auto channelSuffix = (numOutstations > 1) ? "-" + std::to_string(i) : std::string();
+        std::shared_ptr<opendnp3::IChannel> channel;
+        std::shared_ptr<ChannelMetrics> channelMetrics;
+        auto listener = chListener;
+        if (metrics)
+        {
+            channelMetrics = ChannelMetrics::Create("server" + channelSuffix, chListener);
+            metrics->AddChannel(channelMetrics);
+            listener = channelMetrics;
+        }
+        try
+        {
+            channel = manager.AddTCPServer(
+                "server" + channelSuffix, logLevels, opendnp3::ServerAcceptMode::CloseExisting, ip, listener);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            std::cout << "failed to start server on " << endpoint << ", exiting" << std::endl;
+            return 1;
+        }
+        if (channelMetrics)
+        {
+            channelMetrics->SetChannel(channel);
+        }
+
+        // Every drop on the channel is a separate outstation answering its own link address
+        for (size_t drop = 0; drop < numDrops; ++drop)
+        {
+            HostedOutstation host;
+            host.endpoint = endpoint;
+            host.channel = channel;
+            host.linkAddr = static_cast<uint16_t>(outstationLink + drop);
+
+            // Add devices to the outstation
+            size_t n = hosts.size();
+            std::optional<uint64_t> instanceSeed;
+            if (*seedOpt)
+            {
+                instanceSeed = seed + n;
+            }
+            auto beforeProfile = ResourceUsage::Read();
+            host.profile = profileTemplate->Instantiate(scheduler, instanceSeed);
+            host.profileUsage = ResourceUsage::Read() - beforeProfile;
+            auto table = host.profile->GetIOTable();
+
+            // Configure outstation
+            config.link.LocalAddr = host.linkAddr;
+
+            // Initialize the outstation and add the outstation to the channel
+            auto suffix = (total > 1) ? "-" + std::to_string(n) : std::string();
+            auto stats = EventStats::Create(config.outstation.eventBufferConfig);
+            table->RegisterEventStats(stats);
+            if (!historianFile.empty())
+            {
+                auto path = (n > 0) ? historianFile + "-" + std::to_string(n) : historianFile;
+                try
+                {
+                    host.historian = Historian::Create(path, scheduler);
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << e.what() << std::endl;
+                    std::cout << "failed to open the historian, exiting" << std::endl;
+                    return 1;
+                }
+                table->RegisterHistorian(host.historian);
+            }
+#ifndef DNP3_OUTSTATION_HEADLESS
+            // Only the points of the outstation the visualization follows keep a history for its trends
+            if (tui && n == 0)
+            {
+                table->RegisterHistory(PointHistory::Create(table->NumPoints(), historyDepth));
+            }
+#endif
+            auto app = OutstationApplication::Create(stats);
+            host.outstation = channel->AddOutstation("outstation" + suffix, table, app, config);
+            table->RegisterOutstation(host.outstation);
+            if (metrics)
+            {
+                host.metrics = OutstationMetrics::Create("outstation" + suffix, channelMetrics, stats);
+                host.metrics->SetOutstation(host.outstation);
+                table->RegisterMetrics(host.metrics);
+                metrics->AddOutstation(host.metrics);
+            }
+            host.outstation->Enable();
+
+            // Points can also be written by a co-simulator through shared memory
+            if (!sharedMemory.empty())
+            {
+                auto path = (n > 0) ? sharedMemory + "-" + std::to_string(n) : sharedMemory;
+                try
+                {
+                    host.bridge = SharedPointBridge::Create(table, scheduler, path);
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << e.what() << std::endl;
+                    std::cout << "failed to map the shared memory region, exiting" << std::endl;
+                    return 1;
+                }
+                host.bridge->SetStarvationListener([path](uint32_t ticks) {
+                    std::cerr << "error: the writer of " << path << " overlapped " << ticks
+                              << " reads in a row, applying its values without the seqlock" << std::endl;
+                });
+                host.bridge->Start(std::chrono::milliseconds(sharedInterval));
+            }
+
+            // The channel itself is accounted to its first drop
+            auto after = ResourceUsage::Read();
+            host.usage = after - before;
+            before = after;
+            hosts.push_back(std::move(host));
+        }
     }
-    for (int i = 0; i < 5; ++i)
+
+    // Points of every outstation can be driven from stdin or the control socket
+    auto control = ControlApi::Create(scheduler);
+    for (const auto& host : hosts)
     {
-        auto name = "Breaker " + std::to_string(breaker_num);
-        auto device = table->CreateBreaker(name, TwoSignalControlModel::ACTIVATION);
-        devices.push_back(device);
-        breaker_num++;
+        control->AddProfile(host.profile);
     }
-    for (int i = 0; i < 3; ++i)
+    auto controlServer = ControlServer::Create(control);
+    controlServer->SetQuitListener([]() { quitRequested = true; });
+    if (!controlSocket.empty())
     {
-        auto name = "Switch " + std::to_string(i);
-        auto device = table->CreateSlowDevice(name, 10000, TwoSignalControlModel::ACTIVATION);
-        devices.push_back(device);
+        try
+        {
+            controlServer->Listen(controlSocket);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            std::cout << "failed to open the control socket, exiting" << std::endl;
+            return 1;
+        }
     }
 
-    if (tui)
+    auto metricsServer = metrics ? MetricsServer::Create(metrics) : nullptr;
+    if (metricsPort.has_value())
+    {
+        try
+        {
+            metricsServer->Listen(metricsAddress, metricsPort.value());
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            std::cout << "failed to serve the metrics, exiting" << std::endl;
+            return 1;
+        }
+    }
+    if (!metricsJson.empty())
     {
-        tui->RegisterDevices(devices);
-        tui->RegisterIOTable(table);
+        metricsServer->DumpJson(metricsJson, std::chrono::seconds(metricsInterval));
     }
 
-    // Configure outstation
-    opendnp3::OutstationStackConfig config(table->ConfigureDatabase());
-    config.outstation.eventBufferConfig = opendnp3::EventBufferConfig::AllTypes(10);
-    config.outstation.params.allowUnsolicited = true;
-    config.link.KeepAliveTimeout = opendnp3::TimeDuration::Max();
-    config.link.LocalAddr = outstationLink;
-    config.link.RemoteAddr = clientLink;
+    // Viewers follow the first outstation, like the visualization
+    std::shared_ptr<StatePublisher> publisher;
+    if (!publishState.empty())
+    {
+        const auto& first = hosts.front().profile;
+        try
+        {
+            publisher = StatePublisher::Create(first->GetIOTable(), first->GetDevices(), scheduler, publishState);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            std::cout << "failed to publish the state, exiting" << std::endl;
+            return 1;
+        }
+        stateLog->Attach(publisher->GetRegion());
+        publisher->Start(std::chrono::milliseconds(publishInterval));
+    }
 
-    // Initialize the outstation and add the outstation to the channel
-    auto app = opendnp3::DefaultOutstationApplication::Create();
-    auto outstation = channel->AddOutstation("outstation", table, app, config);
-    table->RegisterOutstation(outstation);
-    outstation->Enable();
+    // Recorded process data drives the first outstation
+    std::shared_ptr<Playback> playback;
+    if (!playbackFile.empty())
+    {
+        playback = Playback::Create(hosts.front().profile->GetIOTable(), scheduler);
+        try
+        {
+            playback->Open(playbackFile);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            std::cout << "failed to open the playback file, exiting" << std::endl;
+            return 1;
+        }
+        for (const auto& column : playback->GetUnmappedColumns())
+        {
+            std::cerr << "playback column " << column << " does not match a point, ignored" << std::endl;
+        }
+        playback->SetSpeed(playbackSpeed);
+        playback->SetLagListener(1.0, [](double lag) {
+            std::cerr << "playback is " << lag << " s behind the recording" << std::endl;
+        });
+        playback->Start();
+    }
 
+#ifndef DNP3_OUTSTATION_HEADLESS
     if (tui)
     {
+        // The visualization follows the first outstation
+        tui->RegisterDevices(hosts.front().profile->GetDevices());
+        tui->RegisterIOTable(hosts.front().profile->GetIOTable());
+        tui->RegisterMetrics(hosts.front().metrics);
         tui->Init();
+        return EXIT_SUCCESS;
     }
-    else
+#endif
+
+    printUsage(hosts, baseline, profileTemplate->NumPoints());
+
+    ControlSession session;
+    std::string input;
+    bool quit = false;
+    while (!quitRequested && std::getline(std::cin, input))
     {
-        std::string input;
-        while (true)
+        if ((input == "quit") || (input == "x") || (input == "exit") || (input == "q"))
         {
-            std::cin >> input;
-            if ((input == "quit") || (input == "x") || (input == "exit") || (input == "q"))
-            {
-                return 0;
-            }
+            quit = true;
+            break;
+        }
+        if (input == "stats")
+        {
+            printUsage(hosts, baseline, profileTemplate->NumPoints());
+            continue;
+        }
+        if (input == "events")
+        {
+            printEvents(hosts);
+            continue;
+        }
+        if ((input == "playback") && playback)
+        {
+            auto status = playback->GetStatus();
+            std::cout << "playback: " << status.position << " s, " << status.rows << " rows in " << status.batches
+                      << " batches, " << status.rejected << " rejected, lag " << status.lag << " s (max "
+                      << status.maxLag << " s)" << (status.finished ? ", finished" : "") << std::endl;
+            continue;
+        }
+        std::cout << control->Execute(session, input) << std::flush;
+    }
+
+    // Without a console, e.g. started in the background with stdin from /dev/null, the outstation
+    // keeps serving. The handlers are only installed now so Ctrl-C still ends an interactive session.
+    if (!quit && !quitRequested)
+    {
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+        while (!signalled && !quitRequested)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+
+    // Changes still buffered would otherwise wait for the historian to be destroyed
+    for (const auto& host : hosts)
+    {
+        if (host.historian)
+        {
+            host.historian->Flush();
         }
     }
     return EXIT_SUCCESS;
@@ -0,0 +1,17 @@
+#include "outstation/application.h"
+
+OutstationApplication::OutstationApplication(std::shared_ptr<EventStats> stats) : stats(std::move(stats)) {}
+
+std::shared_ptr<OutstationApplication> OutstationApplication::Create(std::shared_ptr<EventStats> stats)
+{
+    return std::make_shared<OutstationApplication>(std::move(stats));
+}
+
+void OutstationApplication::OnConfirmProcessed(bool isUnsolicited,
+                                               uint32_t numClass1,
+                                               uint32_t numClass2,
+                                               uint32_t numClass3)
+{
+    // The counts are the events of each class still in the buffer, not the ones just confirmed
+    stats->Confirmed(numClass1, numClass2, numClass3);
+}
@@ -0,0 +1,27 @@
+#ifndef CALDERADNP3_OUTSTATION_APPLICATION_H
+#define CALDERADNP3_OUTSTATION_APPLICATION_H
+
+#include "outstation/event_stats.h"
+
+#include <opendnp3/outstation/DefaultOutstationApplication.h>
+
+#include <cstdint>
+#include <memory>
+
+/**
+ * OutstationApplication is the default outstation application, reporting
+ * the events confirmed by the master to the outstation's EventStats.
+ */
+class OutstationApplication final : public opendnp3::DefaultOutstationApplication
+{
+private:
+    std::shared_ptr<EventStats> stats;
+
+public:
+    explicit OutstationApplication(std::shared_ptr<EventStats> stats);
+    static std::shared_ptr<OutstationApplication> Create(std::shared_ptr<EventStats> stats);
+
+    void OnConfirmProcessed(bool isUnsolicited, uint32_t numClass1, uint32_t numClass2, uint32_t numClass3) override;
+};
+
+#endif // CALDERADNP3_OUTSTATION_APPLICATION_H
@@ -0,0 +1,671 @@
+#include "outstation/control_api.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+namespace
+{
+std::vector<std::string> split(const std::string& line)
+{
+    std::vector<std::string> tokens;
+    size_t pos = 0;
+    while (pos < line.size())
+    {
+        pos = line.find_first_not_of(" \t\r\n", pos);
+        if (pos == std::string::npos)
+        {
+            break;
+        }
+        auto end = line.find_first_of(" \t\r\n", pos);
+        if (end == std::string::npos)
+        {
+            end = line.size();
+        }
+        tokens.push_back(line.substr(pos, end - pos));
+        pos = end;
+    }
+    return tokens;
+}
+
+// Device names are matched the way point names are stored, with spaces as underscores
+std::string deviceKey(std::string name)
+{
+    std::replace_if(name.begin(), name.end(), [](char ch) { return (ch == ' ') || (ch == '.') || (ch == ','); }, '_');
+    return name;
+}
+
+bool parseDouble(const std::string& text, double& value)
+{
+    errno = 0;
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return (errno == 0) && (end != text.c_str()) && (*end == '\0');
+}
+
+// Plain decimal digits only, where strtoull would also take a sign, spaces or a 0x prefix
+bool parseIndex(const std::string& text, size_t& value)
+{
+    if (text.empty() || (text.find_first_not_of("0123456789") != std::string::npos))
+    {
+        return false;
+    }
+    errno = 0;
+    value = static_cast<size_t>(std::strtoull(text.c_str(), nullptr, 10));
+    return errno == 0;
+}
+
+// Parses waveform components from args[first] on; each name is followed by its parameters
+bool parseWaveform(const std::vector<std::string>& args, size_t first, Waveform& waveform, std::string& error)
+{
+    if (first >= args.size())
+    {
+        error = "no waveform component";
+        return false;
+    }
+    for (size_t i = first; i < args.size();)
+    {
+        const auto& component = args[i++];
+        size_t count = 0;
+        if ((component == "sine") || (component == "step"))
+        {
+            count = 2;
+        }
+        else if ((component == "ramp") || (component == "walk") || (component == "noise") || (component == "uniform"))
+        {
+            count = 1;
+        }
+        else if (component != "constant")
+        {
+            error = "unknown waveform component " + component;
+            return false;
+        }
+
+        double params[2] = {0.0, 0.0};
+        for (size_t p = 0; p < count; ++p, ++i)
+        {
+            if ((i >= args.size()) || !parseDouble(args[i], params[p]))
+            {
+                error = "bad parameters for " + component;
+                return false;
+            }
+        }
+
+        if (component == "sine")
+        {
+            if (params[1] <= 0)
+            {
+                error = "the period of a sine must be positive";
+                return false;
+            }
+            waveform.sineAmplitude = params[0];
+            waveform.sinePeriod = params[1];
+        }
+        else if (component == "ramp")
+        {
+            waveform.rampRate = params[0];
+        }
+        else if (component == "step")
+        {
+            waveform.stepHeight = params[0];
+            waveform.stepTime = params[1];
+        }
+        else if (component == "walk")
+        {
+            waveform.walkSigma = params[0];
+        }
+        else if (component == "noise")
+        {
+            waveform.noiseSigma = params[0];
+        }
+        else if (component == "uniform")
+        {
+            waveform.uniformNoise = params[0];
+        }
+    }
+    return true;
+}
+
+std::string ok(const std::string& detail = "")
+{
+    return detail.empty() ? "OK\n" : "OK " + detail + "\n";
+}
+
+std::string err(const std::string& detail)
+{
+    return "ERR " + detail + "\n";
+}
+
+/**
+ * Collects the name, kind and state of a device.
+ */
+class DeviceDescription : public DeviceVisitor
+{
+public:
+    std::string name;
+    std::string kind;
+    std::string state;
+
+    void Visit(SimpleDevice& device) override
+    {
+        name = device.GetName();
+        kind = "device";
+        state = device.IsOn() ? "on" : "off";
+    }
+
+    void Visit(Breaker& device) override
+    {
+        name = device.GetName();
+        kind = "breaker";
+        state = device.IsClosed() ? "closed" : "tripped";
+    }
+
+    void Visit(SlowDevice& device) override
+    {
+        name = device.GetName();
+        kind = "switch";
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2) << device.Position();
+        state = out.str();
+    }
+
+    void Visit(SetpointController& device) override
+    {
+        name = device.GetName();
+        kind = device.IsReadOnly() ? "sensor" : "setpoint";
+        std::ostringstream out;
+        out << device.Read();
+        state = out.str();
+    }
+};
+
+/**
+ * Runs a protocol action on a device, leaving error set when the device does not support it.
+ */
+class DeviceOperation : public DeviceVisitor
+{
+public:
+    DeviceOperation(const std::string& action, double value) : action(action), value(value) {}
+
+    std::string error;
+
+    void Visit(SimpleDevice& device) override
+    {
+        unsupported(device.GetName());
+    }
+
+    void Visit(Breaker& device) override
+    {
+        if (action == "trip")
+        {
+            device.Trip();
+        }
+        else if (action == "close")
+        {
+            device.Close();
+        }
+        else
+        {
+            unsupported(device.GetName());
+        }
+    }
+
+    void Visit(SlowDevice& device) override
+    {
+        if (action == "trip")
+        {
+            device.Trip();
+        }
+        else if (action == "close")
+        {
+            device.Close();
+        }
+        else
+        {
+            unsupported(device.GetName());
+        }
+    }
+
+    void Visit(SetpointController& device) override
+    {
+        if ((action == "setpoint") && !device.IsReadOnly())
+        {
+            device.Set(value);
+        }
+        else
+        {
+            unsupported(device.GetName());
+        }
+    }
+
+private:
+    std::string action;
+    double value;
+
+    void unsupported(const std::string& name)
+    {
+        error = name + " does not support " + action;
+    }
+};
+
+/**
+ * Gives a setpoint controller a new waveform, leaving error set for any other device.
+ */
+class WaveformAssignment : public DeviceVisitor
+{
+public:
+    explicit WaveformAssignment(const Waveform& waveform) : waveform(waveform) {}
+
+    std::string error;
+
+    void Visit(SimpleDevice& device) override
+    {
+        unsupported(device.GetName());
+    }
+
+    void Visit(Breaker& device) override
+    {
+        unsupported(device.GetName());
+    }
+
+    void Visit(SlowDevice& device) override
+    {
+        unsupported(device.GetName());
+    }
+
+    void Visit(SetpointController& device) override
+    {
+        device.SetWaveform(waveform);
+    }
+
+private:
+    Waveform waveform;
+
+    void unsupported(const std::string& name)
+    {
+        error = name + " does not support waveform";
+    }
+};
+} // namespace
+
+// ControlApi
+
+ControlApi::ControlApi(std::shared_ptr<Scheduler> scheduler) : scheduler(std::move(scheduler)) {}
+
+ControlApi::~ControlApi()
+{
+    Stop();
+}
+
+std::shared_ptr<ControlApi> ControlApi::Create(std::shared_ptr<Scheduler> scheduler)
+{
+    return std::make_shared<ControlApi>(std::move(scheduler));
+}
+
+ControlApi::Target::Target(std::shared_ptr<Profile> profile)
+    : profile(profile), table(profile->GetIOTable()), points(std::make_shared<PointIndex>(profile->GetIOTable()))
+{
+    for (const auto& device : profile->GetDevices())
+    {
+        DeviceDescription description;
+        device->Accept(description);
+        devices[deviceKey(description.name)] = device;
+    }
+}
+
+void ControlApi::AddProfile(std::shared_ptr<Profile> profile)
+{
+    Target target(std::move(profile));
+
+    std::lock_guard<std::mutex> lock(mtx);
+    targets.push_back(std::move(target));
+}
+
+size_t ControlApi::Size()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return targets.size();
+}
+
+void ControlApi::Stop()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto& ramp : ramps)
+    {
+        scheduler->Cancel(ramp.second);
+    }
+    ramps.clear();
+}
+
+std::string ControlApi::Execute(ControlSession& session, const std::string& line)
+{
+    auto tokens = split(line);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (session.target >= targets.size())
+    {
+        return err("no outstation");
+    }
+    auto& target = targets[session.target];
+
+    if (session.inBulk)
+    {
+        if (tokens.empty())
+        {
+            return "";
+        }
+        if (tokens[0] == "end")
+        {
+            return endBulk(session, target);
+        }
+        return bulkLine(session, target, tokens);
+    }
+
+    if (tokens.empty())
+    {
+        return "";
+    }
+
+    const auto& command = tokens[0];
+    std::vector<std::string> args(tokens.begin() + 1, tokens.end());
+    if (command == "set")
+    {
+        return set(target, args);
+    }
+    if (command == "bulk")
+    {
+        session.inBulk = true;
+        session.bulkCount = 0;
+        session.bulkErrors = 0;
+        session.firstError.clear();
+        return "";
+    }
+    if (command == "ramp")
+    {
+        return ramp(target, args);
+    }
+    if (command == "get")
+    {
+        return get(target, args);
+    }
+    if (command == "list")
+    {
+        return list(target);
+    }
+    if (command == "devices")
+    {
+        return listDevices(target);
+    }
+    if ((command == "trip") || (command == "close") || (command == "setpoint"))
+    {
+        return operate(target, command, args);
+    }
+    if (command == "waveform")
+    {
+        return shape(target, args);
+    }
+    if (command == "use")
+    {
+        size_t index = 0;
+        if ((args.size() != 1) || !parseIndex(args[0], index) || (index >= targets.size()))
+        {
+            return err("use <0-" + std::to_string(targets.size() - 1) + ">");
+        }
+        session.target = index;
+        return ok(std::to_string(session.target));
+    }
+    return err("unknown command " + command);
+}
+
+bool ControlApi::write(Target& target,
+                       const PointRef& ref,
+                       const std::string& value,
+                       opendnp3::UpdateBuilder& builder,
+                       std::string& error)
+{
+    // A value set directly replaces any ramp in progress on the point
+    if (ref.type == PointType::ANALOG_INPUT)
+    {
+        cancelRamp(target.table->GetAnalogInputs()[ref.index].get());
+    }
+    return target.points->Write(ref, value, builder, error);
+}
+
+void ControlApi::cancelRamp(const Analog* point)
+{
+    auto it = ramps.find(point);
+    if (it == ramps.end())
+    {
+        return;
+    }
+    scheduler->Cancel(it->second);
+    ramps.erase(it);
+}
+
+std::string ControlApi::set(Target& target, const std::vector<std::string>& args)
+{
+    if (args.empty() || (args.size() % 2 != 0))
+    {
+        return err("set <point> <value> [<point> <value> ...]");
+    }
+
+    auto builder = opendnp3::UpdateBuilder();
+    std::string error;
+    for (size_t i = 0; i < args.size(); i += 2)
+    {
+        PointRef ref;
+        if (!target.points->Resolve(args[i], ref, error) || !write(target, ref, args[i + 1], builder, error))
+        {
+            // Values written so far are still reported, so the outstation matches the points
+            target.table->Apply(builder.Build());
+            return err(error);
+        }
+    }
+    target.table->Apply(builder.Build());
+    return ok(std::to_string(args.size() / 2));
+}
+
+std::string ControlApi::bulkLine(ControlSession& session, Target& target, const std::vector<std::string>& args)
+{
+    std::string error;
+    PointRef ref;
+    if ((args.size() != 2) || !target.points->Resolve(args[0], ref, error)
+        || !write(target, ref, args[1], session.bulk, error))
+    {
+        if (error.empty())
+        {
+            error = "expected <point> <value>";
+        }
+        if (session.bulkErrors == 0)
+        {
+            session.firstError = error;
+        }
+        session.bulkErrors++;
+        return "";
+    }
+    session.bulkCount++;
+    return "";
+}
+
+std::string ControlApi::endBulk(ControlSession& session, Target& target)
+{
+    target.table->Apply(session.bulk.Build());
+    session.inBulk = false;
+    if (session.bulkErrors > 0)
+    {
+        return err(std::to_string(session.bulkErrors) + " rejected, " + std::to_string(session.bulkCount)
+                   + " applied, first: " + session.firstError);
+    }
+    return ok(std::to_string(session.bulkCount));
+}
+
+std::string ControlApi::ramp(Target& target, const std::vector<std::string>& args)
+{
+    PointRef ref;
+    std::string error;
+    double goal = 0.0;
+    double seconds = 0.0;
+    if (args.size() != 3)
+    {
+        return err("ramp <point> <target> <seconds>");
+    }
+    if (!target.points->Resolve(args[0], ref, error))
+    {
+        return err(error);
+    }
+    if ((ref.type != PointType::ANALOG_INPUT) || !parseDouble(args[1], goal) || !parseDouble(args[2], seconds)
+        || (seconds <= 0))
+    {
+        return err("ramp <analog> <target> <seconds>");
+    }
+
+    auto point = target.table->GetAnalogInputs()[ref.index];
+    auto table = target.table;
+    auto points = target.points;
+    cancelRamp(point.get());
+
+    // Finished ramps are dropped here rather than by their last step, which cannot take mtx
+    // while a command holding it waits in Cancel for that step to return
+    for (auto it = ramps.begin(); it != ramps.end();)
+    {
+        it = scheduler->IsScheduled(it->second) ? std::next(it) : ramps.erase(it);
+    }
+
+    // Each step recomputes the value from the elapsed time, so late steps do not slow the ramp down
+    auto start = point->Read();
+    auto startTime = scheduler->Now();
+    auto duration = std::chrono::duration<double>(seconds);
+    auto schedulerRef = scheduler;
+    ramps[point.get()] = scheduler->ScheduleRepeating(
+        RAMP_STEP, RAMP_STEP, [schedulerRef, table, points, ref, start, goal, startTime, duration]() {
+            auto fraction = std::chrono::duration<double>(schedulerRef->Now() - startTime) / duration;
+            fraction = std::min(fraction, 1.0);
+            auto builder = opendnp3::UpdateBuilder();
+            points->Write(ref, start + (goal - start) * fraction, builder);
+            table->Apply(builder.Build());
+            return fraction < 1.0;
+        });
+    return ok();
+}
+
+std::string ControlApi::get(const Target& target, const std::vector<std::string>& args) const
+{
+    PointRef ref;
+    std::string error;
+    if (args.size() != 1)
+    {
+        return err("get <point>");
+    }
+    if (!target.points->Resolve(args[0], ref, error))
+    {
+        return err(error);
+    }
+
+    std::ostringstream out;
+    out << target.points->Read(ref);
+    return ok(out.str());
+}
+
+std::string ControlApi::list(const Target& target) const
+{
+    std::ostringstream out;
+    const auto& binaries = target.table->GetBinaryInputs();
+    for (size_t i = 0; i < binaries.size(); ++i)
+    {
+        out << "bi:" << i << " " << binaries[i]->GetName() << " " << (binaries[i]->Read() ? 1 : 0) << "\n";
+    }
+    const auto& doubleBits = target.table->GetDoubleBitInputs();
+    for (size_t i = 0; i < doubleBits.size(); ++i)
+    {
+        out << "dbi:" << i << " " << doubleBits[i]->GetName() << " "
+            << static_cast<int>(opendnp3::DoubleBitSpec::to_type(doubleBits[i]->Read())) << "\n";
+    }
+    const auto& analogs = target.table->GetAnalogInputs();
+    for (size_t i = 0; i < analogs.size(); ++i)
+    {
+        out << "ai:" << i << " " << analogs[i]->GetName() << " " << analogs[i]->Read() << "\n";
+    }
+    out << ok(std::to_string(binaries.size() + doubleBits.size() + analogs.size()));
+    return out.str();
+}
+
+std::string ControlApi::listDevices(const Target& target) const
+{
+    std::ostringstream out;
+    for (const auto& device : target.profile->GetDevices())
+    {
+        DeviceDescription description;
+        device->Accept(description);
+        out << deviceKey(description.name) << " " << description.kind << " "
+            << description.state << "\n";
+    }
+    out << ok(std::to_string(target.profile->GetDevices().size()));
+    return out.str();
+}
+
+std::string ControlApi::operate(Target& target, const std::string& action, const std::vector<std::string>& args)
+{
+    double value = 0.0;
+    auto nameEnd = args.end();
+    if (action == "setpoint")
+    {
+        if ((args.size() < 2) || !parseDouble(args.back(), value))
+        {
+            return err("setpoint <device> <value>");
+        }
+        nameEnd = args.end() - 1;
+    }
+    if (args.begin() == nameEnd)
+    {
+        return err(action + " <device>");
+    }
+
+    std::string name;
+    for (auto arg = args.begin(); arg != nameEnd; ++arg)
+    {
+        name += (arg == args.begin()) ? *arg : " " + *arg;
+    }
+    auto key = deviceKey(name);
+    auto it = target.devices.find(key);
+    if (it == target.devices.end())
+    {
+        return err("no device " + key);
+    }
+
+    DeviceOperation operation(action, value);
+    it->second->Accept(operation);
+    if (!operation.error.empty())
+    {
+        return err(operation.error);
+    }
+    return ok();
+}
+
+std::string ControlApi::shape(Target& target, const std::vector<std::string>& args)
+{
+    // Device names with spaces are written with underscores here, as the components follow the name
+    Waveform waveform;
+    std::string error;
+    if (args.empty() || !parseWaveform(args, 1, waveform, error))
+    {
+        return err(error.empty() ? "waveform <device> <component> [...]" : error);
+    }
+
+    auto key = deviceKey(args[0]);
+    auto it = target.devices.find(key);
+    if (it == target.devices.end())
+    {
+        return err("no device " + key);
+    }
+
+    WaveformAssignment assignment(waveform);
+    it->second->Accept(assignment);
+    if (!assignment.error.empty())
+    {
+        return err(assignment.error);
+    }
+    return ok();
+}
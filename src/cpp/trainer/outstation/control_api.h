@@ -0,0 +1,118 @@
+#ifndef CALDERADNP3_OUTSTATION_CONTROL_API_H
+#define CALDERADNP3_OUTSTATION_CONTROL_API_H
+
+#include "outstation/devices.h"
+#include "outstation/io_table.h"
+#include "outstation/point_index.h"
+#include "outstation/profile.h"
+#include "outstation/scheduler.h"
+
+#include <opendnp3/outstation/UpdateBuilder.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * ControlSession is the state of one client of the ControlApi.
+ *
+ * Each connection (or stdin) owns a session, which holds the selected
+ * outstation and any bulk load in progress.
+ */
+class ControlSession
+{
+private:
+    friend class ControlApi;
+
+    size_t target = 0;
+    bool inBulk = false;
+    opendnp3::UpdateBuilder bulk;
+    size_t bulkCount = 0;
+    size_t bulkErrors = 0;
+    std::string firstError;
+};
+
+/**
+ * ControlApi is a line protocol for driving point values from a test harness.
+ *
+ * Points are addressed by type and index (ai:3, bi:0, dbi:1) or by name
+ * (Voltage_status), and devices by name, with spaces written as underscores
+ * (Breaker_0). Every command answers with a line starting with OK or ERR;
+ * list-style commands print their rows first.
+ *
+ *   set <point> <value> [<point> <value> ...]   one Apply for all pairs
+ *   bulk ... end                                 one "<point> <value>" per line, applied at end
+ *   ramp <point> <target> <seconds>              moves an analog linearly in simulation time
+ *   get <point>
+ *   list                                         points of the selected outstation
+ *   devices                                      devices of the selected outstation
+ *   trip|close <device>                          breakers and slow devices
+ *   setpoint <device> <value>                    setpoint controllers
+ *   waveform <device> <component> [...]          shapes a setpoint controller around its setpoint, as
+ *                                                the sum of: constant, sine <amplitude> <period>,
+ *                                                ramp <rate>, step <height> <seconds>, walk <sigma>,
+ *                                                noise <sigma> and uniform <half-width>; seconds and
+ *                                                rates are in simulation time since the outstation started
+ *   use <n>                                      selects an outstation
+ *
+ * All values set by one command reach the outstation in a single Apply, so
+ * a bulk load of thousands of points costs one database update. Setting a
+ * generated analog pins it to the value until its device changes it again.
+ */
+class ControlApi
+{
+public:
+    static constexpr std::chrono::milliseconds RAMP_STEP{100};
+
+    explicit ControlApi(std::shared_ptr<Scheduler> scheduler);
+    ~ControlApi();
+    static std::shared_ptr<ControlApi> Create(std::shared_ptr<Scheduler> scheduler);
+
+    // Outstations are numbered in the order they are added
+    void AddProfile(std::shared_ptr<Profile> profile);
+    size_t Size();
+
+    // Runs one line and returns the response, or an empty string for the body of a bulk load
+    std::string Execute(ControlSession& session, const std::string& line);
+    void Stop();
+
+private:
+    struct Target
+    {
+        explicit Target(std::shared_ptr<Profile> profile);
+
+        std::shared_ptr<Profile> profile;
+        std::shared_ptr<IOTable> table;
+        std::shared_ptr<PointIndex> points;
+        std::unordered_map<std::string, std::shared_ptr<IDevice>> devices;
+    };
+
+    std::shared_ptr<Scheduler> scheduler;
+
+    std::mutex mtx;
+    std::vector<Target> targets;
+    std::unordered_map<const Analog*, Scheduler::TaskId> ramps;
+
+    bool write(Target& target,
+               const PointRef& ref,
+               const std::string& value,
+               opendnp3::UpdateBuilder& builder,
+               std::string& error);
+    void cancelRamp(const Analog* point);
+
+    std::string set(Target& target, const std::vector<std::string>& args);
+    std::string bulkLine(ControlSession& session, Target& target, const std::vector<std::string>& args);
+    std::string endBulk(ControlSession& session, Target& target);
+    std::string ramp(Target& target, const std::vector<std::string>& args);
+    std::string get(const Target& target, const std::vector<std::string>& args) const;
+    std::string list(const Target& target) const;
+    std::string listDevices(const Target& target) const;
+    std::string operate(Target& target, const std::string& action, const std::vector<std::string>& args);
+    std::string shape(Target& target, const std::vector<std::string>& args);
+};
+
+#endif // CALDERADNP3_OUTSTATION_CONTROL_API_H
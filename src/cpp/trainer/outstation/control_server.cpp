@@ -0,0 +1,258 @@
+#include "outstation/control_server.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+constexpr size_t READ_SIZE = 64 * 1024;
+} // namespace
+
+ControlServer::ControlServer(std::shared_ptr<ControlApi> api) : api(std::move(api)) {}
+
+ControlServer::~ControlServer()
+{
+    Stop();
+}
+
+std::shared_ptr<ControlServer> ControlServer::Create(std::shared_ptr<ControlApi> api)
+{
+    return std::make_shared<ControlServer>(std::move(api));
+}
+
+void ControlServer::SetQuitListener(std::function<void()> listener)
+{
+    quitListener = std::move(listener);
+}
+
+#ifdef _WIN32
+
+void ControlServer::Listen(const std::string&)
+{
+    throw std::runtime_error("control sockets are not supported on this platform");
+}
+
+void ControlServer::Stop() {}
+
+void ControlServer::acceptLoop() {}
+
+void ControlServer::reap() {}
+
+void ControlServer::serve(Client&) {}
+
+#else
+
+void ControlServer::Listen(const std::string& socketPath)
+{
+    sockaddr_un addr{};
+    if (socketPath.size() >= sizeof(addr.sun_path))
+    {
+        throw std::runtime_error("control socket path is too long: " + socketPath);
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        throw std::runtime_error("cannot create control socket: " + std::string(std::strerror(errno)));
+    }
+
+    // A socket left behind by a previous run would make bind fail
+    // The socket accepts arbitrary point writes, so only its owner may connect
+    unlink(socketPath.c_str());
+    if ((bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) || (chmod(socketPath.c_str(), 0600) < 0)
+        || (listen(fd, 8) < 0))
+    {
+        auto error = std::string(std::strerror(errno));
+        close(fd);
+        throw std::runtime_error("cannot listen on " + socketPath + ": " + error);
+    }
+
+    // The listening socket is non-blocking, so a connection reset between poll and accept
+    // cannot leave the accept loop blocked where Stop cannot wake it
+    if ((fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0) || (pipe(wakeFds) < 0))
+    {
+        auto error = std::string(std::strerror(errno));
+        close(fd);
+        unlink(socketPath.c_str());
+        throw std::runtime_error("cannot listen on " + socketPath + ": " + error);
+    }
+
+    path = socketPath;
+    listenFd = fd;
+    acceptThread = std::thread([this]() { acceptLoop(); });
+}
+
+void ControlServer::Stop()
+{
+    if (stopping.exchange(true) || (listenFd < 0))
+    {
+        return;
+    }
+
+    // The pipe wakes the accept loop, and shutting the connections down wakes the threads blocked in recv
+    const char wakeup = 0;
+    while ((write(wakeFds[1], &wakeup, 1) < 0) && (errno == EINTR))
+    {
+    }
+    if (acceptThread.joinable())
+    {
+        acceptThread.join();
+    }
+    close(listenFd);
+    close(wakeFds[0]);
+    close(wakeFds[1]);
+    unlink(path.c_str());
+
+    std::list<Client> remaining;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto& client : clients)
+        {
+            if (!client.finished)
+            {
+                shutdown(client.fd, SHUT_RDWR);
+            }
+        }
+        remaining.swap(clients);
+    }
+    for (auto& client : remaining)
+    {
+        client.thread.join();
+    }
+}
+
+void ControlServer::acceptLoop()
+{
+    while (!stopping)
+    {
+        pollfd fds[2] = {{listenFd, POLLIN, 0}, {wakeFds[0], POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+        if (fds[1].revents != 0)
+        {
+            return;
+        }
+
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ECONNABORTED))
+            {
+                continue;
+            }
+            return;
+        }
+
+        // Some platforms pass the non-blocking flag of the listening socket on to the connection
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+
+        reap();
+
+        // List elements stay in place, so the thread may keep a reference to its own entry
+        std::lock_guard<std::mutex> lock(mtx);
+        auto& client = clients.emplace_back();
+        client.fd = fd;
+        client.thread = std::thread([this, &client]() { serve(client); });
+    }
+}
+
+void ControlServer::reap()
+{
+    std::list<Client> finished;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto it = clients.begin(); it != clients.end();)
+        {
+            auto next = std::next(it);
+            if (it->finished)
+            {
+                finished.splice(finished.end(), clients, it);
+            }
+            it = next;
+        }
+    }
+
+    // A finished thread has nothing left to do but return
+    for (auto& client : finished)
+    {
+        client.thread.join();
+    }
+}
+
+void ControlServer::serve(Client& client)
+{
+    int fd = client.fd;
+    ControlSession session;
+    std::string pending;
+    std::string responses;
+    std::vector<char> buffer(READ_SIZE);
+
+    while (!stopping)
+    {
+        auto received = recv(fd, buffer.data(), buffer.size(), 0);
+        if (received <= 0)
+        {
+            if ((received < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            break;
+        }
+        pending.append(buffer.data(), static_cast<size_t>(received));
+
+        size_t start = 0;
+        size_t end = 0;
+        while ((end = pending.find('\n', start)) != std::string::npos)
+        {
+            auto line = pending.substr(start, end - start);
+            if ((line == "quit") && quitListener)
+            {
+                quitListener();
+                responses += "OK\n";
+            }
+            else
+            {
+                responses += api->Execute(session, line);
+            }
+            start = end + 1;
+        }
+        pending.erase(0, start);
+
+        size_t sent = 0;
+        while (sent < responses.size())
+        {
+            auto n = send(fd, responses.data() + sent, responses.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0)
+            {
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        responses.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    close(fd);
+    client.finished = true;
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef CALDERADNP3_OUTSTATION_CONTROL_SERVER_H
+#define CALDERADNP3_OUTSTATION_CONTROL_SERVER_H
+
+#include "outstation/control_api.h"
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * ControlServer serves the ControlApi on a UNIX domain socket.
+ *
+ * Each connection gets its own ControlSession and thread. Lines are read
+ * in blocks and the responses to a whole block are written back at once,
+ * so a client streaming a bulk load is not slowed down by a write per line.
+ * Threads of closed connections are joined by the accept loop, which polls
+ * the socket together with a pipe that Stop writes to, since shutting a
+ * listening socket down does not wake accept on every platform. The socket
+ * is only accessible to its owner, as it accepts arbitrary point writes.
+ * A `quit` line is answered by the quit listener rather than the ControlApi.
+ * UNIX sockets are only available on POSIX systems.
+ */
+class ControlServer
+{
+private:
+    std::shared_ptr<ControlApi> api;
+    std::string path;
+    int listenFd = -1;
+    int wakeFds[2] = {-1, -1}; // self-pipe written by Stop to wake the accept loop
+    std::atomic<bool> stopping{false};
+    std::thread acceptThread;
+
+    struct Client
+    {
+        int fd = -1;
+        bool finished = false;
+        std::thread thread;
+    };
+
+    std::mutex mtx;
+    std::list<Client> clients;
+    std::function<void()> quitListener;
+
+    void acceptLoop();
+    void reap();
+    void serve(Client& client);
+
+public:
+    explicit ControlServer(std::shared_ptr<ControlApi> api);
+    ~ControlServer();
+    static std::shared_ptr<ControlServer> Create(std::shared_ptr<ControlApi> api);
+
+    // Throws std::runtime_error when the socket cannot be created
+    void Listen(const std::string& socketPath);
+    void Stop();
+
+    // Called from a connection thread when a client sends `quit`; set before Listen
+    void SetQuitListener(std::function<void()> listener);
+};
+
+#endif // CALDERADNP3_OUTSTATION_CONTROL_SERVER_H
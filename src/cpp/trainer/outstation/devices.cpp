@@ -1,20 +1,32 @@
 #include "outstation/devices.h"
 
-#include <random>
+#include <algorithm>
+#include <cmath>
 
 // IDevice
-void IDevice::RegisterScreen(ftxui::ScreenInteractive* screenPtr)
+void IDevice::SetRedrawCallback(std::function<void()> callback)
 {
-    this->screen = screenPtr;
+    redraw = std::move(callback);
+}
+
+bool IDevice::IsRendered() const
+{
+    return redraw != nullptr;
 }
 
 void IDevice::ForceRedraw()
 {
-    if (!screen)
+    version.fetch_add(1, std::memory_order_release);
+    if (!redraw)
     {
         return;
     }
-    screen->PostEvent(ftxui::Event::Custom);
+    redraw();
+}
+
+uint32_t IDevice::GetVersion() const
+{
+    return version.load(std::memory_order_acquire);
 }
 
 // SimpleDevice
@@ -41,18 +53,29 @@ std::shared_ptr<BinaryOutput> SimpleDevice::CreateControlSignal()
     return control;
 }
 
-ftxui::Element SimpleDevice::Render()
+const std::string& SimpleDevice::GetName() const
 {
-    using namespace ftxui;
+    return name;
+}
 
-    std::string model = "Latch Model";
-    if (status->Read())
-    {
-        return window(text(name), vbox({gauge(1) | color(Color::Red), paragraph(model)})) | size(WIDTH, EQUAL, 18)
-            | notflex;
-    }
-    return window(text(name), vbox({gauge(0) | color(Color::Red), paragraph(model)})) | size(WIDTH, EQUAL, 18)
-        | notflex;
+bool SimpleDevice::IsOn() const
+{
+    return status && status->Read();
+}
+
+uint32_t SimpleDevice::GetVersion() const
+{
+    return IDevice::GetVersion() + (status ? status->GetVersion() : 0);
+}
+
+const IMeasurement* SimpleDevice::GetInputPoint() const
+{
+    return status.get();
+}
+
+void SimpleDevice::Accept(DeviceVisitor& visitor)
+{
+    visitor.Visit(*this);
 }
 
 // Breaker
@@ -73,22 +96,44 @@ std::shared_ptr<Breaker> Breaker::Create(const std::string& name, TwoSignalContr
 
 void Breaker::Trip()
 {
-    if (!status)
-    {
-        return;
-    }
-
-    status->Write(false);
+    setState(false);
 }
 
 void Breaker::Close()
+{
+    setState(true);
+}
+
+void Breaker::setState(bool closed)
 {
     if (!status)
     {
         return;
     }
 
-    status->Write(true);
+    // The status change and everything the listener derives from it reach the outstation together
+    auto builder = opendnp3::UpdateBuilder();
+    status->Write(closed, builder);
+    if (listener)
+    {
+        listener(closed, builder);
+    }
+    status->UpdateOutstation(builder.Build());
+}
+
+bool Breaker::IsClosed() const
+{
+    return status && status->Read();
+}
+
+const std::string& Breaker::GetName() const
+{
+    return name;
+}
+
+void Breaker::SetStateListener(StateListener stateListener)
+{
+    listener = std::move(stateListener);
 }
 
 void Breaker::AssignInputPoint(std::shared_ptr<Binary> input)
@@ -102,28 +147,38 @@ std::vector<std::shared_ptr<BinaryOutput>> Breaker::CreateControlSignal()
     return control.GetOutputs();
 }
 
-ftxui::Element Breaker::Render()
+TwoSignalControlModel Breaker::GetModel() const
 {
-    using namespace ftxui;
+    return control.GetModel();
+}
 
-    std::string model = TwoSignalControlModelSpec::to_human_string(control.GetModel());
-    if (status->Read())
-    {
-        return window(text(name), vbox({gauge(1) | color(Color::Red), paragraph(model)})) | size(WIDTH, EQUAL, 18)
-            | notflex;
-    }
-    return window(text(name), vbox({gauge(0) | color(Color::Red), paragraph(model)})) | size(WIDTH, EQUAL, 18)
-        | notflex;
+uint32_t Breaker::GetVersion() const
+{
+    return IDevice::GetVersion() + (status ? status->GetVersion() : 0);
+}
+
+const IMeasurement* Breaker::GetInputPoint() const
+{
+    return status.get();
+}
+
+void Breaker::Accept(DeviceVisitor& visitor)
+{
+    visitor.Visit(*this);
 }
 
 // SlowDevice
 
-SlowDevice::SlowDevice(const std::string& name, uint32_t runtimeMs, TwoSignalControlModel model)
+SlowDevice::SlowDevice(const std::string& name,
+                       uint32_t runtimeMs,
+                       TwoSignalControlModel model,
+                       std::shared_ptr<Scheduler> scheduler)
     : name(name),
       runtimeMs(runtimeMs),
       control(model,
               std::make_shared<BinaryAction>(std::bind(&SlowDevice::Trip, this)),
-              std::make_shared<BinaryAction>(std::bind(&SlowDevice::Close, this)))
+              std::make_shared<BinaryAction>(std::bind(&SlowDevice::Close, this))),
+      scheduler(std::move(scheduler))
 {
     control.SetPointNames(name);
 };
@@ -133,90 +188,125 @@ SlowDevice::~SlowDevice()
     stopMoving();
 }
 
-std::shared_ptr<SlowDevice> SlowDevice::Create(const std::string& name, uint32_t runtimeMs, TwoSignalControlModel model)
+std::shared_ptr<SlowDevice> SlowDevice::Create(const std::string& name,
+                                               uint32_t runtimeMs,
+                                               TwoSignalControlModel model,
+                                               std::shared_ptr<Scheduler> scheduler)
 {
-    return std::make_shared<SlowDevice>(name, runtimeMs, model);
+    return std::make_shared<SlowDevice>(name, runtimeMs, model, std::move(scheduler));
 }
 
-void SlowDevice::stopMoving()
+double SlowDevice::positionAt(Scheduler::Clock::time_point time) const
 {
-    if (moving.load())
+    if ((startPosition == targetPosition) || (runtimeMs == 0))
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        moving.store(false);
-        cv.notify_all();
+        return targetPosition;
     }
-    if (moveThread.joinable())
+
+    auto elapsed = std::chrono::duration<double, std::milli>(time - motionStart).count();
+    auto travelled = elapsed / runtimeMs;
+    if (travelled >= std::abs(targetPosition - startPosition))
     {
-        moveThread.join();
+        return targetPosition;
     }
+    return (targetPosition > startPosition) ? startPosition + travelled : startPosition - travelled;
 }
 
-void SlowDevice::setPosition(double pos)
+double SlowDevice::Position()
 {
-    opendnp3::DoubleBit newStatus;
-    if (pos < 0.1)
+    std::lock_guard<std::mutex> lock(motionMtx);
+    return positionAt(scheduler->Now());
+}
+
+void SlowDevice::SetPosition(double position)
+{
+    std::lock_guard<std::mutex> control(controlMtx);
+    stopMoving();
+    {
+        std::lock_guard<std::mutex> lock(motionMtx);
+        startPosition = position;
+        targetPosition = position;
+    }
+    ForceRedraw();
+}
+
+void SlowDevice::stopMoving()
+{
+    scheduler->Cancel(moveTask);
+    moveTask = Scheduler::INVALID_TASK;
+}
+
+void SlowDevice::move(double target)
+{
+    // controlMtx serializes commands; motionMtx is never held across Cancel() because the
+    // scheduled task takes it when the motion finishes.
+    std::lock_guard<std::mutex> control(controlMtx);
+    stopMoving();
+
+    auto now = scheduler->Now();
+    Scheduler::Clock::duration travelTime;
+    {
+        std::lock_guard<std::mutex> lock(motionMtx);
+        startPosition = positionAt(now);
+        targetPosition = target;
+        motionStart = now;
+        auto travelMs = std::abs(targetPosition - startPosition) * runtimeMs;
+        travelTime = std::chrono::duration_cast<Scheduler::Clock::duration>(
+            std::chrono::duration<double, std::milli>(travelMs));
+    }
+
+    if (status->Read() != opendnp3::DoubleBit::INTERMEDIATE)
     {
-        position.store(0);
-        newStatus = opendnp3::DoubleBit::DETERMINED_OFF;
+        status->Write(opendnp3::DoubleBit::INTERMEDIATE);
     }
-    else if (pos > 0.9)
+    ForceRedraw();
+
+    // When not rendered the only remaining work is the final status transition. With one,
+    // the gauge is refreshed in ten steps over the full travel time.
+    auto end = now + travelTime;
+    if (!IsRendered())
     {
-        position.store(1);
-        newStatus = opendnp3::DoubleBit::DETERMINED_ON;
+        moveTask = scheduler->ScheduleAt(end, [this]() { finishMove(); });
+        return;
     }
-    else
+
+    Scheduler::Clock::duration frame = std::chrono::milliseconds(std::max<uint32_t>(runtimeMs / 10, 1));
+    moveTask = scheduler->ScheduleRepeating(frame, std::min(frame, travelTime), [this, end]() {
+        if (scheduler->Now() >= end)
+        {
+            finishMove();
+            return false;
+        }
+        ForceRedraw();
+        return true;
+    });
+}
+
+void SlowDevice::finishMove()
+{
+    double position;
     {
-        position.store(pos);
-        newStatus = opendnp3::DoubleBit::INTERMEDIATE;
+        std::lock_guard<std::mutex> lock(motionMtx);
+        startPosition = targetPosition;
+        position = targetPosition;
     }
 
+    auto newStatus = (position >= 1.0) ? opendnp3::DoubleBit::DETERMINED_ON : opendnp3::DoubleBit::DETERMINED_OFF;
     if (status->Read() != newStatus)
     {
         status->Write(newStatus);
     }
+    ForceRedraw();
 }
 
 void SlowDevice::doTrip()
 {
-    stopMoving();
-    moving.store(true);
-    moveThread = std::thread([this]() {
-        auto incrementTime = std::chrono::milliseconds(runtimeMs / 10);
-        while (position.load() > 0)
-        {
-            auto newPosition = position.load() - 0.1;
-            newPosition = newPosition < 0 ? 0 : newPosition;
-            setPosition(newPosition);
-            ForceRedraw();
-            if (std::unique_lock<std::mutex> lock(mtx); cv.wait_for(lock, incrementTime) == std::cv_status::no_timeout)
-            {
-                break;
-            }
-        }
-        moving.store(false);
-    });
+    move(0.0);
 }
 
 void SlowDevice::doClose()
 {
-    stopMoving();
-    moving.store(true);
-    moveThread = std::thread([this]() {
-        auto incrementTime = std::chrono::milliseconds(runtimeMs / 10);
-        while (position.load() < 1)
-        {
-            auto newPosition = position.load() + 0.1;
-            newPosition = newPosition > 1 ? 1 : newPosition;
-            setPosition(newPosition);
-            ForceRedraw();
-            if (std::unique_lock<std::mutex> lock(mtx); cv.wait_for(lock, incrementTime) == std::cv_status::no_timeout)
-            {
-                break;
-            }
-        }
-        moving.store(false);
-    });
+    move(1.0);
 }
 
 void SlowDevice::Trip()
@@ -246,72 +336,98 @@ std::vector<std::shared_ptr<BinaryOutput>> SlowDevice::CreateControlSignal()
     return control.GetOutputs();
 }
 
-ftxui::Element SlowDevice::Render()
+const std::string& SlowDevice::GetName() const
 {
-    using namespace ftxui;
+    return name;
+}
 
-    std::string model = TwoSignalControlModelSpec::to_human_string(control.GetModel());
-    auto fill = static_cast<float>(position.load());
-    return window(text(name), vbox({gauge(fill) | color(Color::Red), paragraph(model)})) | size(WIDTH, EQUAL, 18)
-        | notflex;
+TwoSignalControlModel SlowDevice::GetModel() const
+{
+    return control.GetModel();
 }
 
-// SetpointController
+uint32_t SlowDevice::GetVersion() const
+{
+    return IDevice::GetVersion() + (status ? status->GetVersion() : 0);
+}
 
-SetpointController::SetpointController(const std::string& name, double setpoint, double variance)
-    : name(name), variance(variance)
+const IMeasurement* SlowDevice::GetInputPoint() const
 {
-    baseValue.store(setpoint);
-    running.store(true);
+    return status.get();
+}
 
-    runThread = std::thread([this]() {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<> dis(-1 * this->variance, this->variance);
+void SlowDevice::Accept(DeviceVisitor& visitor)
+{
+    visitor.Visit(*this);
+}
 
-        auto looptime = std::chrono::milliseconds(1000);
-        while (running.load())
-        {
-            auto newValue = baseValue.load() + dis(gen);
-            status->Write(newValue);
-            ForceRedraw();
-            if (std::unique_lock<std::mutex> lock(mtx); cv.wait_for(lock, looptime) == std::cv_status::no_timeout)
-            {
-                break;
-            }
-        }
-    });
+// SetpointController
+
+SetpointController::SetpointController(const std::string& name,
+                                       double setpoint,
+                                       double variance,
+                                       std::shared_ptr<WaveformGenerator> generator)
+    : name(name), variance(variance), generator(std::move(generator))
+{
+    baseValue.store(setpoint);
+    waveform.offset = setpoint;
+    waveform.uniformNoise = variance;
 }
 
-SetpointController::~SetpointController()
+std::shared_ptr<SetpointController> SetpointController::Create(const std::string& name,
+                                                               double setpoint,
+                                                               double variance,
+                                                               std::shared_ptr<WaveformGenerator> generator)
 {
-    stop();
+    return std::make_shared<SetpointController>(name, setpoint, variance, std::move(generator));
 }
 
-void SetpointController::stop()
+void SetpointController::Set(double value)
 {
-    if (running.load())
+    // The whole waveform is stored again, so a point pinned through the control API follows the device again
+    std::lock_guard<std::mutex> lock(mtx);
+    baseValue.store(value);
+    waveform.offset = value;
+    if (slot.has_value())
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        running.store(false);
-        cv.notify_all();
+        generator->SetWaveform(slot.value(), waveform);
+        generator->SetGain(slot.value(), gain.load());
     }
-    if (runThread.joinable())
+}
+
+void SetpointController::SetWaveform(const Waveform& shape)
+{
+    // The setpoint remains the offset of the generated signal
+    std::lock_guard<std::mutex> lock(mtx);
+    waveform = shape;
+    waveform.offset = baseValue.load();
+    if (slot.has_value())
     {
-        runThread.join();
+        generator->SetWaveform(slot.value(), waveform);
     }
 }
 
-std::shared_ptr<SetpointController> SetpointController::Create(const std::string& name,
-                                                               double setpoint,
-                                                               double variance)
+void SetpointController::SetGain(double value)
 {
-    return std::make_shared<SetpointController>(name, setpoint, variance);
+    // The status point is only written by the generator, which reports it at the new gain right away
+    std::lock_guard<std::mutex> lock(mtx);
+    gain.store(value);
+    if (!slot.has_value())
+    {
+        return;
+    }
+    generator->SetGain(slot.value(), value);
 }
 
-void SetpointController::Set(double value)
+void SetpointController::SetGain(double value, opendnp3::UpdateBuilder& builder)
 {
-    baseValue.store(value);
+    std::lock_guard<std::mutex> lock(mtx);
+    gain.store(value);
+    if (!slot.has_value())
+    {
+        return;
+    }
+    generator->SetGain(slot.value(), value, builder);
 }
 
 void SetpointController::AssignInputPoint(std::shared_ptr<Analog> input)
@@ -319,6 +435,9 @@ void SetpointController::AssignInputPoint(std::shared_ptr<Analog> input)
     status = input;
     status->SetDeadband(variance * 2);
     status->SetName(name + "_status");
+    std::lock_guard<std::mutex> lock(mtx);
+    slot = generator->Add(status, waveform);
+    generator->SetGain(slot.value(), gain.load());
 }
 
 std::shared_ptr<AnalogOutput> SetpointController::CreateControlSignal()
@@ -329,16 +448,32 @@ std::shared_ptr<AnalogOutput> SetpointController::CreateControlSignal()
     return control;
 }
 
-ftxui::Element SetpointController::Render()
+const std::string& SetpointController::GetName() const
 {
-    using namespace ftxui;
+    return name;
+}
 
-    std::string model = "Analog Output (Double64)";
-    if (!control)
-    {
-        model = "Read-Only";
-    }
-    auto value = status->Read();
-    return window(text(name), vbox({text(std::to_string(value)) | color(Color::Red), paragraph(model)}))
-        | size(WIDTH, EQUAL, 18) | notflex;
+double SetpointController::Read() const
+{
+    return status->Read();
+}
+
+bool SetpointController::IsReadOnly() const
+{
+    return !control;
+}
+
+uint32_t SetpointController::GetVersion() const
+{
+    return IDevice::GetVersion() + (status ? status->GetVersion() : 0);
+}
+
+const IMeasurement* SetpointController::GetInputPoint() const
+{
+    return status.get();
+}
+
+void SetpointController::Accept(DeviceVisitor& visitor)
+{
+    visitor.Visit(*this);
 }
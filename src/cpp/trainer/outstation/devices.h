@@ -1,29 +1,60 @@
 #ifndef CALDERADNP3_OUTSTATION_DEVICES_H
 #define CALDERADNP3_OUTSTATION_DEVICES_H
 
+#include "outstation/scheduler.h"
 #include "outstation/types.h"
-
-#include <ftxui/component/screen_interactive.hpp>
-#include <ftxui/dom/elements.hpp>
+#include "outstation/waveform.h"
 
 #include <atomic>
-#include <condition_variable>
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <mutex>
 #include <optional>
-#include <thread>
+
+class SimpleDevice;
+class Breaker;
+class SlowDevice;
+class SetpointController;
+
+/**
+ * DeviceVisitor dispatches on the concrete type of a device.
+ *
+ * The simulation core has no knowledge of how devices are presented; a
+ * user interface implements a visitor to render each device type.
+ */
+class DeviceVisitor
+{
+public:
+    virtual ~DeviceVisitor() = default;
+    virtual void Visit(SimpleDevice& device) = 0;
+    virtual void Visit(Breaker& device) = 0;
+    virtual void Visit(SlowDevice& device) = 0;
+    virtual void Visit(SetpointController& device) = 0;
+};
 
 class IDevice
 {
 private:
-    ftxui::ScreenInteractive* screen = nullptr;
+    std::function<void()> redraw;
+
+    // Counts the redraws forced by the device, for state not held in its input point
+    std::atomic<uint32_t> version{0};
 
 public:
     IDevice() = default;
     virtual ~IDevice() = default;
-    virtual ftxui::Element Render() = 0;
-    void RegisterScreen(ftxui::ScreenInteractive* screenPtr);
+    virtual void Accept(DeviceVisitor& visitor) = 0;
+    void SetRedrawCallback(std::function<void()> callback);
+    bool IsRendered() const;
     void ForceRedraw();
+
+    // Changes whenever the state shown for the device may have changed: devices add the
+    // version of their input point, and as both only grow the sum changes with either
+    virtual uint32_t GetVersion() const;
+
+    // The input point carrying the state of the device, if assigned
+    virtual const IMeasurement* GetInputPoint() const = 0;
 };
 
 class SimpleDevice : public IDevice
@@ -38,18 +69,30 @@ public:
     explicit SimpleDevice(const std::string& name) : name(name) {};
     static std::shared_ptr<SimpleDevice> Create(const std::string& name);
 
+    const std::string& GetName() const;
+    bool IsOn() const;
+
     void AssignInputPoint(std::shared_ptr<Binary> input);
     std::shared_ptr<BinaryOutput> CreateControlSignal();
 
-    ftxui::Element Render() override;
+    uint32_t GetVersion() const override;
+    const IMeasurement* GetInputPoint() const override;
+    void Accept(DeviceVisitor& visitor) override;
 };
 
 class Breaker : public IDevice
 {
+public:
+    // Called with the new state (true when closed) and the batch carrying the status change
+    using StateListener = std::function<void(bool, opendnp3::UpdateBuilder&)>;
+
 private:
     std::string name = "Breaker";
     std::shared_ptr<Binary> status;
     TwoSignalControl control;
+    StateListener listener;
+
+    void setState(bool closed);
 
 public:
     explicit Breaker(const std::string& name, TwoSignalControlModel model);
@@ -57,11 +100,17 @@ public:
 
     void Trip();
     void Close();
+    bool IsClosed() const;
+    const std::string& GetName() const;
+    TwoSignalControlModel GetModel() const;
+    void SetStateListener(StateListener stateListener);
 
     void AssignInputPoint(std::shared_ptr<Binary> input);
     std::vector<std::shared_ptr<BinaryOutput>> CreateControlSignal();
 
-    ftxui::Element Render() override;
+    uint32_t GetVersion() const override;
+    const IMeasurement* GetInputPoint() const override;
+    void Accept(DeviceVisitor& visitor) override;
 };
 
 class SlowDevice : public IDevice
@@ -71,30 +120,50 @@ private:
     std::shared_ptr<DoubleBit> status;
     uint32_t runtimeMs = 5000;
     TwoSignalControl control;
+    std::shared_ptr<Scheduler> scheduler;
 
-    std::atomic<double> position{0.0};
-    std::mutex mtx;
-    std::condition_variable cv;
-    std::atomic<bool> moving{false};
-    std::thread moveThread;
+    // Motion is described by its start and direction; the position is derived when read.
+    std::mutex motionMtx;
+    Scheduler::Clock::time_point motionStart;
+    double startPosition = 0.0;
+    double targetPosition = 0.0;
+
+    std::mutex controlMtx;
+    Scheduler::TaskId moveTask = Scheduler::INVALID_TASK;
 
+    double positionAt(Scheduler::Clock::time_point time) const;
     void stopMoving();
-    void setPosition(double pos);
+    void move(double target);
+    void finishMove();
     void doTrip();
     void doClose();
 
 public:
-    explicit SlowDevice(const std::string& name, uint32_t runtimeMs, TwoSignalControlModel model);
+    explicit SlowDevice(const std::string& name,
+                        uint32_t runtimeMs,
+                        TwoSignalControlModel model,
+                        std::shared_ptr<Scheduler> scheduler);
     ~SlowDevice() override;
-    static std::shared_ptr<SlowDevice> Create(const std::string& name, uint32_t runtimeMs, TwoSignalControlModel model);
+    static std::shared_ptr<SlowDevice> Create(const std::string& name,
+                                              uint32_t runtimeMs,
+                                              TwoSignalControlModel model,
+                                              std::shared_ptr<Scheduler> scheduler);
 
     void Trip();
     void Close();
+    double Position();
+
+    // Places the device at rest without a command or a status change, e.g. to mirror another process
+    void SetPosition(double position);
+    const std::string& GetName() const;
+    TwoSignalControlModel GetModel() const;
 
     void AssignInputPoint(std::shared_ptr<DoubleBit> input);
     std::vector<std::shared_ptr<BinaryOutput>> CreateControlSignal();
 
-    ftxui::Element Render() override;
+    uint32_t GetVersion() const override;
+    const IMeasurement* GetInputPoint() const override;
+    void Accept(DeviceVisitor& visitor) override;
 };
 
 class SetpointController : public IDevice
@@ -106,24 +175,42 @@ private:
     std::atomic<double> baseValue{100.0};
     double variance = 0.2;
 
-    std::mutex mtx;
-    std::condition_variable cv;
-    std::atomic<bool> running{false};
-    std::thread runThread;
+    std::shared_ptr<WaveformGenerator> generator;
+    std::optional<size_t> slot = std::nullopt;
 
-    void stop();
+    // Commands arrive from the DNP3 and control API threads: the waveform and gain are only changed, and
+    // passed on to the generator, with mtx held, so the generator never mixes those of two commands
+    std::mutex mtx;
+    Waveform waveform;
+    std::atomic<double> gain{1.0};
 
 public:
-    explicit SetpointController(const std::string& name, double setpoint, double variance);
-    ~SetpointController() override;
-    static std::shared_ptr<SetpointController> Create(const std::string& name, double setpoint, double variance);
+    explicit SetpointController(const std::string& name,
+                                double setpoint,
+                                double variance,
+                                std::shared_ptr<WaveformGenerator> generator);
+    static std::shared_ptr<SetpointController> Create(const std::string& name,
+                                                      double setpoint,
+                                                      double variance,
+                                                      std::shared_ptr<WaveformGenerator> generator);
 
     void Set(double value);
+    // The setpoint stays the offset of the shape, which replaces the noise of the variance
+    void SetWaveform(const Waveform& shape);
+    // Without a batch the status is reported in one of its own
+    void SetGain(double gain);
+    void SetGain(double gain, opendnp3::UpdateBuilder& builder);
+
+    const std::string& GetName() const;
+    double Read() const;
+    bool IsReadOnly() const;
 
     void AssignInputPoint(std::shared_ptr<Analog> input);
     std::shared_ptr<AnalogOutput> CreateControlSignal();
 
-    ftxui::Element Render() override;
+    uint32_t GetVersion() const override;
+    const IMeasurement* GetInputPoint() const override;
+    void Accept(DeviceVisitor& visitor) override;
 };
 
 #endif // CALDERADNP3_OUTSTATION_DEVICES_H
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "outstation/event_stats.h"
+
+#include <algorithm>
+
+namespace
+{
+// Index of an event class in the EventStats queues, or -1 for static only points
+int classIndex(opendnp3::PointClass pointClass)
+{
+    switch (pointClass)
+    {
+    case opendnp3::PointClass::Class1:
+        return 0;
+    case opendnp3::PointClass::Class2:
+        return 1;
+    case opendnp3::PointClass::Class3:
+        return 2;
+    default:
+        return -1;
+    }
+}
+} // namespace
+
+// EventTypeSpec
+
+char const* EventTypeSpec::to_string(EventType arg)
+{
+    switch (arg)
+    {
+    case EventType::BINARY:
+        return "BINARY";
+    case EventType::DOUBLE_BIT:
+        return "DOUBLE_BIT";
+    case EventType::ANALOG:
+        return "ANALOG";
+    default:
+        return "UNDEFINED";
+    }
+}
+
+char const* EventTypeSpec::to_human_string(EventType arg)
+{
+    switch (arg)
+    {
+    case EventType::BINARY:
+        return "Binary";
+    case EventType::DOUBLE_BIT:
+        return "Double-bit Binary";
+    case EventType::ANALOG:
+        return "Analog";
+    default:
+        return "Undefined";
+    }
+}
+
+EventType EventTypeSpec::from_string(const std::string& arg)
+{
+    if (arg == "BINARY")
+        return EventType::BINARY;
+    if (arg == "DOUBLE_BIT")
+        return EventType::DOUBLE_BIT;
+    if (arg == "ANALOG")
+        return EventType::ANALOG;
+    return EventType::UNDEFINED;
+}
+
+// EventStats
+
+EventStats::EventStats(const opendnp3::EventBufferConfig& config)
+{
+    counters[static_cast<size_t>(EventType::BINARY)].capacity = config.max_binary_events;
+    counters[static_cast<size_t>(EventType::DOUBLE_BIT)].capacity = config.max_double_binary_events;
+    counters[static_cast<size_t>(EventType::ANALOG)].capacity = config.max_analog_events;
+}
+
+std::shared_ptr<EventStats> EventStats::Create(const opendnp3::EventBufferConfig& config)
+{
+    return std::make_shared<EventStats>(config);
+}
+
+void EventStats::Queued(EventType type, opendnp3::PointClass pointClass)
+{
+    auto idx = classIndex(pointClass);
+    if ((idx < 0) || (static_cast<size_t>(type) >= NUM_TYPES))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    auto& counter = counters[static_cast<size_t>(type)];
+    auto& queue = byType[static_cast<size_t>(type)];
+    counter.queued++;
+
+    if (counter.capacity == 0)
+    {
+        counter.overflows++;
+        return;
+    }
+
+    if (queue.size() >= counter.capacity)
+    {
+        // The oldest event of this type is discarded to make room
+        auto oldest = queue.front();
+        queue.pop_front();
+        remove(byClass[oldest.eventClass], oldest.sequence);
+        if (classOccupancy[oldest.eventClass] > 0)
+        {
+            classOccupancy[oldest.eventClass]--;
+        }
+        counter.overflows++;
+    }
+
+    Pending event{nextSequence++, type, static_cast<uint8_t>(idx)};
+    queue.push_back(event);
+    byClass[idx].push_back(event);
+    classOccupancy[idx]++;
+
+    counter.occupancy = static_cast<uint32_t>(queue.size());
+    counter.peak = std::max(counter.peak, counter.occupancy);
+}
+
+void EventStats::Confirmed(uint32_t remainingClass1, uint32_t remainingClass2, uint32_t remainingClass3)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    confirm(0, remainingClass1);
+    confirm(1, remainingClass2);
+    confirm(2, remainingClass3);
+}
+
+void EventStats::confirm(size_t eventClass, uint32_t remaining)
+{
+    auto& queue = byClass[eventClass];
+    auto confirmed = (classOccupancy[eventClass] > remaining) ? classOccupancy[eventClass] - remaining : 0;
+    classOccupancy[eventClass] = remaining;
+
+    for (uint32_t i = 0; (i < confirmed) && !queue.empty(); ++i)
+    {
+        auto event = queue.front();
+        queue.pop_front();
+
+        auto& typeQueue = byType[static_cast<size_t>(event.type)];
+        remove(typeQueue, event.sequence);
+        auto& counter = counters[static_cast<size_t>(event.type)];
+        counter.confirmed++;
+        counter.occupancy = static_cast<uint32_t>(typeQueue.size());
+    }
+}
+
+void EventStats::remove(std::deque<Pending>& queue, uint64_t sequence)
+{
+    auto it = std::find_if(
+        queue.begin(), queue.end(), [sequence](const Pending& event) { return event.sequence == sequence; });
+    if (it != queue.end())
+    {
+        queue.erase(it);
+    }
+}
+
+EventCounters EventStats::Get(EventType type)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (static_cast<size_t>(type) >= NUM_TYPES)
+    {
+        return {};
+    }
+    return counters[static_cast<size_t>(type)];
+}
+
+void EventStats::Reset()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto& counter : counters)
+    {
+        counter.queued = 0;
+        counter.confirmed = 0;
+        counter.overflows = 0;
+        counter.peak = counter.occupancy;
+    }
+}
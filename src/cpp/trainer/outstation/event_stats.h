@@ -0,0 +1,90 @@
+#ifndef CALDERADNP3_OUTSTATION_EVENT_STATS_H
+#define CALDERADNP3_OUTSTATION_EVENT_STATS_H
+
+#include <opendnp3/gen/PointClass.h>
+#include <opendnp3/outstation/EventBufferConfig.h>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+enum class EventType : uint8_t
+{
+    BINARY = 0,
+    DOUBLE_BIT = 1,
+    ANALOG = 2,
+    UNDEFINED = 127
+};
+
+struct EventTypeSpec
+{
+    using enum_type_t = EventType;
+
+    static char const* to_string(EventType arg);
+    static char const* to_human_string(EventType arg);
+    static EventType from_string(const std::string& arg);
+};
+
+struct EventCounters
+{
+    uint32_t capacity = 0;
+    uint64_t queued = 0;
+    uint64_t confirmed = 0;
+    uint32_t occupancy = 0;
+    uint32_t peak = 0;
+    uint64_t overflows = 0;
+};
+
+/**
+ * EventStats mirrors the occupancy of an outstation's event buffer per type.
+ *
+ * Points report each event they generate, using the same rules as the
+ * outstation's event detection. Once the master confirms a response, the
+ * outstation application reports the events of each class remaining in
+ * the buffer: the class occupancy is taken from those counts, and the
+ * difference from the previous occupancy is credited to the oldest events
+ * of that class, the order the outstation reports them in. When a type is
+ * full the outstation discards the oldest event of that type, whatever its
+ * class, which is counted as an overflow.
+ */
+class EventStats
+{
+public:
+    static constexpr size_t NUM_TYPES = 3;
+
+    explicit EventStats(const opendnp3::EventBufferConfig& config);
+    static std::shared_ptr<EventStats> Create(const opendnp3::EventBufferConfig& config);
+
+    void Queued(EventType type, opendnp3::PointClass pointClass);
+    void Confirmed(uint32_t remainingClass1, uint32_t remainingClass2, uint32_t remainingClass3);
+
+    EventCounters Get(EventType type);
+    void Reset();
+
+private:
+    struct Pending
+    {
+        uint64_t sequence;
+        EventType type;
+        uint8_t eventClass; // 0-2 for classes 1-3
+    };
+
+    std::mutex mtx;
+    std::array<EventCounters, NUM_TYPES> counters;
+    uint64_t nextSequence = 0;
+
+    // Events waiting for confirmation, oldest first, per class 1-3 and per type
+    std::array<std::deque<Pending>, 3> byClass;
+    std::array<std::deque<Pending>, NUM_TYPES> byType;
+
+    // Events of each class in the outstation's buffer, as it last reported them
+    std::array<uint32_t, 3> classOccupancy{};
+
+    void confirm(size_t eventClass, uint32_t remaining);
+    static void remove(std::deque<Pending>& queue, uint64_t sequence);
+};
+
+#endif // CALDERADNP3_OUTSTATION_EVENT_STATS_H
@@ -0,0 +1,312 @@
+#include "outstation/historian.h"
+
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace
+{
+constexpr size_t FLUSH_SIZE = 64 * 1024;
+constexpr uint8_t KIND_SEGMENT = 3;
+
+uint64_t toBits(double value)
+{
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(uint64_t bits)
+{
+    double value = 0.0;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+} // namespace
+
+// Historian
+
+Historian::Historian(std::shared_ptr<Scheduler> scheduler) : scheduler(std::move(scheduler))
+{
+    buffer.reserve(FLUSH_SIZE + 32);
+}
+
+Historian::~Historian()
+{
+    if (scheduler)
+    {
+        scheduler->Cancel(flushTask);
+    }
+    Flush();
+}
+
+std::shared_ptr<Historian> Historian::Create(const std::string& path,
+                                             std::shared_ptr<Scheduler> scheduler,
+                                             std::chrono::milliseconds flushInterval)
+{
+    auto historian = std::make_shared<Historian>(scheduler);
+
+    std::ifstream existing(path, std::ios::binary | std::ios::ate);
+    bool empty = !existing.is_open() || (existing.tellg() <= 0);
+    existing.close();
+
+    // A partial record left by a crash would swallow the segment start, so the file is cut back first
+    if (!empty)
+    {
+        HistorianReader reader(path);
+        HistorianRecord record;
+        while (reader.Next(record))
+        {
+        }
+        std::error_code error;
+        if ((reader.CompleteSize() < std::filesystem::file_size(path, error)) && !error)
+        {
+            std::filesystem::resize_file(path, reader.CompleteSize(), error);
+        }
+        if (error)
+        {
+            throw std::runtime_error("cannot truncate historian file " + path + ": " + error.message());
+        }
+    }
+
+    historian->file.open(path, std::ios::binary | std::ios::app);
+    if (!historian->file.is_open())
+    {
+        throw std::runtime_error("cannot open historian file " + path);
+    }
+
+    auto& buffer = historian->buffer;
+    if (empty)
+    {
+        buffer.insert(buffer.end(), MAGIC, MAGIC + sizeof(MAGIC));
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            buffer.push_back(static_cast<uint8_t>(VERSION >> shift));
+        }
+    }
+
+    // Each run is a segment, so appending never depends on the state of a previous run
+    buffer.push_back(KIND_SEGMENT);
+    historian->flush();
+
+    if (scheduler)
+    {
+        auto* raw = historian.get();
+        historian->flushTask = scheduler->SchedulePeriodic(flushInterval, [raw]() { raw->Flush(); });
+    }
+    return historian;
+}
+
+void Historian::Record(EventType type, uint16_t index, double value, uint8_t flags, uint64_t time)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    uint8_t tag = static_cast<uint8_t>(type) & 0x3;
+    uint64_t delta = 0;
+    size_t significant = 0;
+    switch (type)
+    {
+    case EventType::BINARY:
+        tag |= (value != 0.0) ? 0x4 : 0x0;
+        break;
+    case EventType::DOUBLE_BIT:
+        tag |= (static_cast<uint8_t>(value) & 0x3) << 2;
+        break;
+    case EventType::ANALOG:
+    {
+        if (index >= lastAnalog.size())
+        {
+            lastAnalog.resize(index + 1, 0);
+        }
+        auto bits = toBits(value);
+        delta = bits ^ lastAnalog[index];
+        lastAnalog[index] = bits;
+        for (auto rest = delta; rest != 0; rest >>= 8)
+        {
+            significant++;
+        }
+        tag |= static_cast<uint8_t>(significant << 4);
+        break;
+    }
+    default:
+        return;
+    }
+
+    buffer.push_back(tag);
+    putVarint(buffer, zigzag(static_cast<int64_t>(time - lastTime)));
+    lastTime = time;
+    putVarint(buffer, index);
+    buffer.push_back(flags);
+    for (size_t i = 0; i < significant; ++i)
+    {
+        buffer.push_back(static_cast<uint8_t>(delta >> (8 * i)));
+    }
+    records++;
+
+    if (buffer.size() >= FLUSH_SIZE)
+    {
+        flush();
+    }
+}
+
+void Historian::Flush()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    flush();
+}
+
+void Historian::flush()
+{
+    if (buffer.empty())
+    {
+        return;
+    }
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    file.flush();
+    bytes += buffer.size();
+    buffer.clear();
+}
+
+uint64_t Historian::NumRecords()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return records;
+}
+
+uint64_t Historian::NumBytes()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return bytes + buffer.size();
+}
+
+// HistorianReader
+
+HistorianReader::HistorianReader(const std::string& path) : file(path, std::ios::binary)
+{
+    char magic[sizeof(Historian::MAGIC)] = {};
+    uint8_t version[4] = {};
+    if (!file.read(magic, sizeof(magic)) || (std::memcmp(magic, Historian::MAGIC, sizeof(magic)) != 0)
+        || !file.read(reinterpret_cast<char*>(version), sizeof(version)))
+    {
+        throw std::runtime_error(path + " is not a historian file");
+    }
+
+    uint32_t fileVersion = version[0] | (version[1] << 8) | (version[2] << 16) | (uint32_t(version[3]) << 24);
+    if (fileVersion != Historian::VERSION)
+    {
+        throw std::runtime_error(path + " has unsupported historian version " + std::to_string(fileVersion));
+    }
+    completeSize = sizeof(magic) + sizeof(version);
+}
+
+uint64_t HistorianReader::CompleteSize() const
+{
+    return completeSize;
+}
+
+bool HistorianReader::readVarint(uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int byte = file.get();
+        if (byte == std::char_traits<char>::eof())
+        {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HistorianReader::Next(HistorianRecord& record)
+{
+    while (true)
+    {
+        int tag = file.get();
+        if (tag == std::char_traits<char>::eof())
+        {
+            return false;
+        }
+
+        auto kind = static_cast<uint8_t>(tag & 0x3);
+        if (kind == KIND_SEGMENT)
+        {
+            lastTime = 0;
+            lastAnalog.clear();
+            completeSize = static_cast<uint64_t>(file.tellg());
+            continue;
+        }
+
+        uint64_t delta = 0;
+        uint64_t index = 0;
+        int flags = 0;
+        if (!readVarint(delta) || !readVarint(index) || ((flags = file.get()) == std::char_traits<char>::eof()))
+        {
+            return false;
+        }
+        lastTime += static_cast<uint64_t>(unzigzag(delta));
+
+        record.time = lastTime;
+        record.type = static_cast<EventType>(kind);
+        record.index = static_cast<uint16_t>(index);
+        record.flags = static_cast<uint8_t>(flags);
+
+        switch (record.type)
+        {
+        case EventType::BINARY:
+            record.value = ((tag & 0x4) != 0) ? 1.0 : 0.0;
+            break;
+        case EventType::DOUBLE_BIT:
+            record.value = (tag >> 2) & 0x3;
+            break;
+        default:
+        {
+            uint64_t bits = 0;
+            size_t significant = static_cast<size_t>(tag >> 4);
+            for (size_t i = 0; i < significant; ++i)
+            {
+                int byte = file.get();
+                if (byte == std::char_traits<char>::eof())
+                {
+                    return false;
+                }
+                bits |= static_cast<uint64_t>(byte) << (8 * i);
+            }
+            if (record.index >= lastAnalog.size())
+            {
+                lastAnalog.resize(record.index + 1, 0);
+            }
+            lastAnalog[record.index] ^= bits;
+            record.value = fromBits(lastAnalog[record.index]);
+            break;
+        }
+        }
+        completeSize = static_cast<uint64_t>(file.tellg());
+        return true;
+    }
+}
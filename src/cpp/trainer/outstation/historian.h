@@ -0,0 +1,103 @@
+#ifndef CALDERADNP3_OUTSTATION_HISTORIAN_H
+#define CALDERADNP3_OUTSTATION_HISTORIAN_H
+
+#include "outstation/event_stats.h"
+#include "outstation/scheduler.h"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct HistorianRecord
+{
+    uint64_t time = 0; // milliseconds since the epoch, as reported to the master
+    EventType type = EventType::UNDEFINED;
+    uint16_t index = 0;
+    double value = 0.0;
+    uint8_t flags = 0;
+};
+
+/**
+ * Historian appends every change of an input point to a compact binary log.
+ *
+ * The file starts with the 8 byte magic "DNP3HST" and a 32 bit little
+ * endian version, followed by records. Each run of the outstation starts a
+ * segment, and every record is relative to the previous one in its segment:
+ *
+ *   tag     1 byte: bits 0-1 kind (0 binary, 1 double-bit, 2 analog, 3 segment start),
+ *           bit 2 binary value, bits 2-3 double-bit value, bits 4-7 analog byte count
+ *   time    zigzag varint, milliseconds since the previous record (the epoch for the first)
+ *   index   varint
+ *   flags   1 byte
+ *   value   analogs only: the bits of the value XORed with the previous value of the
+ *           same analog, low bytes first, with the high zero bytes left out
+ *
+ * A segment start is a tag alone. Records are encoded into a buffer and
+ * written out when it fills up or on a periodic flush, so recording costs
+ * no system call per change. A record cut short by a crash is removed when
+ * the file is opened again, before the new segment is appended.
+ */
+class Historian
+{
+public:
+    static constexpr char MAGIC[8] = {'D', 'N', 'P', '3', 'H', 'S', 'T', '\0'};
+    static constexpr uint32_t VERSION = 1;
+
+    explicit Historian(std::shared_ptr<Scheduler> scheduler);
+    ~Historian();
+
+    // Throws std::runtime_error when the file cannot be opened for appending
+    static std::shared_ptr<Historian> Create(const std::string& path,
+                                             std::shared_ptr<Scheduler> scheduler,
+                                             std::chrono::milliseconds flushInterval = std::chrono::seconds(1));
+
+    void Record(EventType type, uint16_t index, double value, uint8_t flags, uint64_t time);
+    void Flush();
+
+    uint64_t NumRecords();
+    uint64_t NumBytes();
+
+private:
+    std::shared_ptr<Scheduler> scheduler;
+    Scheduler::TaskId flushTask = Scheduler::INVALID_TASK;
+
+    std::mutex mtx;
+    std::ofstream file;
+    std::vector<uint8_t> buffer;
+    uint64_t lastTime = 0;
+    std::vector<uint64_t> lastAnalog;
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+
+    void flush();
+};
+
+/**
+ * HistorianReader decodes a historian file one record at a time.
+ */
+class HistorianReader
+{
+private:
+    std::ifstream file;
+    uint64_t lastTime = 0;
+    std::vector<uint64_t> lastAnalog;
+    uint64_t completeSize = 0;
+
+    bool readVarint(uint64_t& value);
+
+public:
+    // Throws std::runtime_error when the file is not a historian file
+    explicit HistorianReader(const std::string& path);
+
+    // Returns false at the end of the file; a truncated last record is ignored
+    bool Next(HistorianRecord& record);
+
+    // Bytes up to the end of the last complete record or segment start read so far
+    uint64_t CompleteSize() const;
+};
+
+#endif // CALDERADNP3_OUTSTATION_HISTORIAN_H
@@ -1,8 +1,22 @@
 #include "outstation/io_table.h"
 
-std::shared_ptr<IOTable> IOTable::Create()
+#include <algorithm>
+
+size_t PointLayout::NumPoints() const
+{
+    return binaryInputs.size() + doubleBitInputs.size() + analogInputs.size() + binaryOutputs.size()
+        + analogOutputs.size();
+}
+
+IOTable::IOTable(std::shared_ptr<Scheduler> scheduler)
+    : scheduler(scheduler), waveforms(WaveformGenerator::Create(scheduler)), power(PowerModel::Create())
 {
-    return std::make_shared<IOTable>();
+    power->SetApplyFunction([this](const opendnp3::Updates& updates) { Apply(updates); });
+}
+
+std::shared_ptr<IOTable> IOTable::Create(std::shared_ptr<Scheduler> scheduler)
+{
+    return std::make_shared<IOTable>(std::move(scheduler));
 }
 
 opendnp3::DatabaseConfig IOTable::ConfigureDatabase()
@@ -30,8 +44,58 @@ opendnp3::DatabaseConfig IOTable::ConfigureDatabase()
     return config;
 }
 
+size_t IOTable::NumPoints() const
+{
+    return binaryInputs.size() + doubleBitInputs.size() + analogInputs.size() + binaryOutputs.size()
+        + analogOutputs.size();
+}
+
+std::shared_ptr<const PointLayout> IOTable::CaptureLayout() const
+{
+    auto capture = [](const auto& points, std::vector<PointSpec>& specs) {
+        specs.reserve(points.size());
+        for (const auto& point : points)
+        {
+            specs.push_back(point->GetSpec());
+        }
+    };
+
+    auto captured = std::make_shared<PointLayout>();
+    capture(binaryInputs, captured->binaryInputs);
+    capture(doubleBitInputs, captured->doubleBitInputs);
+    capture(analogInputs, captured->analogInputs);
+    capture(binaryOutputs, captured->binaryOutputs);
+    capture(analogOutputs, captured->analogOutputs);
+    return captured;
+}
+
+size_t IOTable::ShareLayout(std::shared_ptr<const PointLayout> shared)
+{
+    layout = std::move(shared);
+
+    size_t sharing = 0;
+    auto share = [&sharing](const auto& points, const std::vector<PointSpec>& specs) {
+        for (size_t i = 0; i < std::min(points.size(), specs.size()); ++i)
+        {
+            if (points[i]->ShareSpec(specs[i]))
+            {
+                sharing++;
+            }
+        }
+    };
+
+    share(binaryInputs, layout->binaryInputs);
+    share(doubleBitInputs, layout->doubleBitInputs);
+    share(analogInputs, layout->analogInputs);
+    share(binaryOutputs, layout->binaryOutputs);
+    share(analogOutputs, layout->analogOutputs);
+    return sharing;
+}
+
 void IOTable::RegisterOutstation(std::shared_ptr<opendnp3::IOutstation> outstation)
 {
+    this->outstation = outstation;
+
     // Write(Read()) inserted to initialize values in the outstation.
     for (const auto& input : binaryInputs)
     {
@@ -50,147 +114,151 @@ void IOTable::RegisterOutstation(std::shared_ptr<opendnp3::IOutstation> outstati
         input->RegisterOutstation(outstation);
         input->Write(input->Read());
     }
+    // Generated analogs are written as one batch per tick.
+    waveforms->Start([this](const opendnp3::Updates& updates) { Apply(updates); });
 }
 
-ftxui::Element IOTable::RenderInputs()
+void IOTable::RegisterEventStats(std::shared_ptr<EventStats> stats)
 {
-    std::vector<std::vector<std::string>> data;
-    data.push_back({"Group", "Index", "Name", "Value"});
+    eventStats = stats;
 
-    for (auto binary : binaryInputs)
+    for (const auto& input : binaryInputs)
     {
-        auto group = binary->GetStaticGroup();
-        auto groupStr = std::to_string(group);
-
-        auto index = binary->GetIndex();
-        if (!index.has_value())
-        {
-            continue;
-        }
-        auto indexStr = std::to_string(index.value());
-
-        std::string value = "FALSE";
-        if (binary->Read())
-        {
-            value = "TRUE";
-        }
-
-        data.push_back({
-            groupStr,
-            indexStr,
-            binary->GetName(),
-            value,
-        });
+        input->RegisterEventStats(stats.get());
     }
 
-    for (auto doubleBit : doubleBitInputs)
+    for (const auto& input : doubleBitInputs)
     {
-        auto group = doubleBit->GetStaticGroup();
-        auto groupStr = std::to_string(group);
+        input->RegisterEventStats(stats.get());
+    }
 
-        auto index = doubleBit->GetIndex();
-        if (!index.has_value())
-        {
-            continue;
-        }
-        auto indexStr = std::to_string(index.value());
-
-        auto value = opendnp3::DoubleBitSpec::to_human_string(doubleBit->Read());
-        data.push_back({
-            groupStr,
-            indexStr,
-            doubleBit->GetName(),
-            value,
-        });
+    for (const auto& input : analogInputs)
+    {
+        input->RegisterEventStats(stats.get());
     }
+}
+
+std::shared_ptr<EventStats> IOTable::GetEventStats() const
+{
+    return eventStats;
+}
 
-    for (auto analog : analogInputs)
+void IOTable::RegisterHistorian(std::shared_ptr<Historian> hist)
+{
+    historian = hist;
+
+    for (const auto& input : binaryInputs)
     {
-        auto group = analog->GetStaticGroup();
-        auto groupStr = std::to_string(group);
+        input->RegisterHistorian(hist.get());
+    }
 
-        auto index = analog->GetIndex();
-        if (!index.has_value())
-        {
-            continue;
-        }
-        auto indexStr = std::to_string(index.value());
-
-        auto value = std::to_string(analog->Read());
-        data.push_back({
-            groupStr,
-            indexStr,
-            analog->GetName(),
-            value,
-        });
+    for (const auto& input : doubleBitInputs)
+    {
+        input->RegisterHistorian(hist.get());
     }
 
-    auto table = ftxui::Table(data);
+    for (const auto& input : analogInputs)
+    {
+        input->RegisterHistorian(hist.get());
+    }
+}
 
-    // Add border around full table
-    table.SelectAll().Border(ftxui::LIGHT);
+void IOTable::RegisterMetrics(std::shared_ptr<OutstationMetrics> m)
+{
+    metrics = m;
 
-    // Add border between input types
-    table.SelectRows(0, size(binaryInputs)).Border(ftxui::LIGHT);
-    table.SelectRows(0, size(binaryInputs) + size(doubleBitInputs)).Border(ftxui::LIGHT);
+    for (const auto& input : binaryInputs)
+    {
+        input->RegisterMetrics(m.get());
+    }
 
-    // Decorate header row
-    table.SelectRow(0).Decorate(ftxui::bold);
-    table.SelectRow(0).SeparatorVertical(ftxui::LIGHT);
-    table.SelectRow(0).Border(ftxui::DOUBLE);
+    for (const auto& input : doubleBitInputs)
+    {
+        input->RegisterMetrics(m.get());
+    }
 
-    return table.Render();
+    for (const auto& input : analogInputs)
+    {
+        input->RegisterMetrics(m.get());
+    }
 }
 
-ftxui::Element IOTable::RenderOutputs()
+void IOTable::RegisterHistory(std::shared_ptr<PointHistory> hist)
 {
-    std::vector<std::vector<std::string>> data;
-    data.push_back({"Index", "Name"});
+    history = hist;
 
-    for (auto binary : binaryOutputs)
+    for (const auto& input : binaryInputs)
     {
-        auto index = binary->GetIndex();
-        if (!index.has_value())
-        {
-            continue;
-        }
+        input->RegisterHistory(hist.get());
+    }
 
-        auto indexStr = std::to_string(index.value());
-        data.push_back({
-            indexStr,
-            binary->GetName(),
-        });
+    for (const auto& input : doubleBitInputs)
+    {
+        input->RegisterHistory(hist.get());
     }
 
-    for (auto analog : analogOutputs)
+    for (const auto& input : analogInputs)
     {
-        auto index = analog->GetIndex();
-        if (!index.has_value())
-        {
-            continue;
-        }
+        input->RegisterHistory(hist.get());
+    }
+
+    for (const auto& output : binaryOutputs)
+    {
+        output->RegisterHistory(hist.get());
+    }
+
+    for (const auto& output : analogOutputs)
+    {
+        output->RegisterHistory(hist.get());
+    }
+}
 
-        auto indexStr = std::to_string(index.value());
-        data.push_back({
-            indexStr,
-            analog->GetName(),
-        });
+void IOTable::Apply(const opendnp3::Updates& updates)
+{
+    if (!outstation)
+    {
+        return;
     }
+    outstation->Apply(updates);
+    if (metrics)
+    {
+        metrics->Applied();
+    }
+}
+
+std::shared_ptr<WaveformGenerator> IOTable::GetWaveforms() const
+{
+    return waveforms;
+}
 
-    auto table = ftxui::Table(data);
+std::shared_ptr<PowerModel> IOTable::GetPowerModel() const
+{
+    return power;
+}
+
+const std::vector<std::shared_ptr<Binary>>& IOTable::GetBinaryInputs() const
+{
+    return binaryInputs;
+}
 
-    // Add border around full table
-    table.SelectAll().Border(ftxui::LIGHT);
+const std::vector<std::shared_ptr<DoubleBit>>& IOTable::GetDoubleBitInputs() const
+{
+    return doubleBitInputs;
+}
 
-    // Add border between output types
-    table.SelectRows(0, size(binaryOutputs)).Border(ftxui::LIGHT);
+const std::vector<std::shared_ptr<Analog>>& IOTable::GetAnalogInputs() const
+{
+    return analogInputs;
+}
 
-    // Decorate header row
-    table.SelectRow(0).Decorate(ftxui::bold);
-    table.SelectRow(0).SeparatorVertical(ftxui::LIGHT);
-    table.SelectRow(0).Border(ftxui::DOUBLE);
+const std::vector<std::shared_ptr<BinaryOutput>>& IOTable::GetBinaryOutputs() const
+{
+    return binaryOutputs;
+}
 
-    return table.Render();
+const std::vector<std::shared_ptr<AnalogOutput>>& IOTable::GetAnalogOutputs() const
+{
+    return analogOutputs;
 }
 
 void IOTable::RegisterBinaryInput(std::shared_ptr<Binary> input)
@@ -228,6 +296,15 @@ void IOTable::RegisterAnalogOutput(std::shared_ptr<AnalogOutput> output)
     output->SetIndex(idx);
 }
 
+std::shared_ptr<Analog> IOTable::CreateAnalogInput(const std::string& name, double deadband)
+{
+    auto input = Analog::Create(0.0);
+    input->SetName(name);
+    input->SetDeadband(deadband);
+    RegisterAnalogInput(input);
+    return input;
+}
+
 std::shared_ptr<SimpleDevice> IOTable::CreateSimpleDevice(const std::string& name)
 {
     auto input = Binary::Create();
@@ -265,7 +342,7 @@ std::shared_ptr<SlowDevice> IOTable::CreateSlowDevice(const std::string& name,
     auto input = DoubleBit::Create();
     RegisterDoubleBitInput(input);
 
-    auto device = SlowDevice::Create(name, runtimeMs, model);
+    auto device = SlowDevice::Create(name, runtimeMs, model, scheduler);
     device->AssignInputPoint(input);
 
     for (auto control : device->CreateControlSignal())
@@ -284,7 +361,7 @@ std::shared_ptr<SetpointController> IOTable::CreateSetpointController(const std:
     auto input = Analog::Create();
     RegisterAnalogInput(input);
 
-    auto device = SetpointController::Create(name, setpoint, variance);
+    auto device = SetpointController::Create(name, setpoint, variance, waveforms);
     device->AssignInputPoint(input);
 
     if (readOnly)
@@ -298,6 +375,17 @@ std::shared_ptr<SetpointController> IOTable::CreateSetpointController(const std:
     return device;
 }
 
+opendnp3::CommandStatus IOTable::count(CommandType type,
+                                       opendnp3::CommandStatus status,
+                                       std::chrono::steady_clock::time_point start)
+{
+    if (metrics)
+    {
+        metrics->Command(type, status, std::chrono::steady_clock::now() - start);
+    }
+    return status;
+}
+
 // Implement ICommandHandler
 
 opendnp3::CommandStatus IOTable::Select(const opendnp3::ControlRelayOutputBlock& command, uint16_t index)
@@ -315,12 +403,13 @@ opendnp3::CommandStatus IOTable::Operate(const opendnp3::ControlRelayOutputBlock
                                          opendnp3::IUpdateHandler& handler,
                                          opendnp3::OperateType opType)
 {
+    auto start = std::chrono::steady_clock::now();
     if (index >= binaryOutputs.size())
     {
-        return opendnp3::CommandStatus::OUT_OF_RANGE;
+        return count(CommandType::CROB, opendnp3::CommandStatus::OUT_OF_RANGE, start);
     }
 
-    return binaryOutputs[index]->Operate(command, handler, opType);
+    return count(CommandType::CROB, binaryOutputs[index]->Operate(command, handler, opType), start);
 }
 
 opendnp3::CommandStatus IOTable::Select(const opendnp3::AnalogOutputInt16& command, uint16_t index)
@@ -333,7 +422,8 @@ opendnp3::CommandStatus IOTable::Operate(const opendnp3::AnalogOutputInt16& comm
                                          opendnp3::IUpdateHandler& handler,
                                          opendnp3::OperateType opType)
 {
-    return opendnp3::CommandStatus::NOT_SUPPORTED;
+    auto start = std::chrono::steady_clock::now();
+    return count(CommandType::ANALOG, opendnp3::CommandStatus::NOT_SUPPORTED, start);
 }
 
 opendnp3::CommandStatus IOTable::Select(const opendnp3::AnalogOutputInt32& command, uint16_t index)
@@ -346,7 +436,8 @@ opendnp3::CommandStatus IOTable::Operate(const opendnp3::AnalogOutputInt32& comm
                                          opendnp3::IUpdateHandler& handler,
                                          opendnp3::OperateType opType)
 {
-    return opendnp3::CommandStatus::NOT_SUPPORTED;
+    auto start = std::chrono::steady_clock::now();
+    return count(CommandType::ANALOG, opendnp3::CommandStatus::NOT_SUPPORTED, start);
 }
 
 opendnp3::CommandStatus IOTable::Select(const opendnp3::AnalogOutputFloat32& command, uint16_t index)
@@ -359,7 +450,8 @@ opendnp3::CommandStatus IOTable::Operate(const opendnp3::AnalogOutputFloat32& co
                                          opendnp3::IUpdateHandler& handler,
                                          opendnp3::OperateType opType)
 {
-    return opendnp3::CommandStatus::NOT_SUPPORTED;
+    auto start = std::chrono::steady_clock::now();
+    return count(CommandType::ANALOG, opendnp3::CommandStatus::NOT_SUPPORTED, start);
 }
 
 opendnp3::CommandStatus IOTable::Select(const opendnp3::AnalogOutputDouble64& command, uint16_t index)
@@ -377,10 +469,11 @@ opendnp3::CommandStatus IOTable::Operate(const opendnp3::AnalogOutputDouble64& c
                                          opendnp3::IUpdateHandler& handler,
                                          opendnp3::OperateType opType)
 {
+    auto start = std::chrono::steady_clock::now();
     if (index >= analogOutputs.size())
     {
-        return opendnp3::CommandStatus::OUT_OF_RANGE;
+        return count(CommandType::ANALOG, opendnp3::CommandStatus::OUT_OF_RANGE, start);
     }
 
-    return analogOutputs[index]->Operate(command, handler, opType);
+    return count(CommandType::ANALOG, analogOutputs[index]->Operate(command, handler, opType), start);
 }
\ No newline at end of file
@@ -2,15 +2,37 @@
 #define CALDERADNP3_OUTSTATION_IO_TABLE_H
 
 #include "outstation/devices.h"
+#include "outstation/event_stats.h"
+#include "outstation/historian.h"
+#include "outstation/metrics.h"
+#include "outstation/point_history.h"
+#include "outstation/power_model.h"
+#include "outstation/scheduler.h"
+#include "outstation/waveform.h"
 
 #include <opendnp3/outstation/DatabaseConfig.h>
 #include <opendnp3/outstation/ICommandHandler.h>
 
-#include <ftxui/dom/table.hpp>
-
+#include <chrono>
 #include <functional>
 #include <vector>
 
+/**
+ * PointLayout is the specs of the points of an IOTable, list by list in
+ * index order. Tables laid out alike share one PointLayout, so their points
+ * only hold their state.
+ */
+struct PointLayout
+{
+    std::vector<PointSpec> binaryInputs;
+    std::vector<PointSpec> doubleBitInputs;
+    std::vector<PointSpec> analogInputs;
+    std::vector<PointSpec> binaryOutputs;
+    std::vector<PointSpec> analogOutputs;
+
+    size_t NumPoints() const;
+};
+
 class IOTable : public opendnp3::ICommandHandler
 {
 private:
@@ -20,16 +42,49 @@ private:
     std::vector<std::shared_ptr<BinaryOutput>> binaryOutputs;
     std::vector<std::shared_ptr<AnalogOutput>> analogOutputs;
 
+    std::shared_ptr<Scheduler> scheduler;
+    std::shared_ptr<WaveformGenerator> waveforms;
+    std::shared_ptr<PowerModel> power;
+    std::shared_ptr<opendnp3::IOutstation> outstation = nullptr;
+    std::shared_ptr<EventStats> eventStats = nullptr;
+    std::shared_ptr<Historian> historian = nullptr;
+    std::shared_ptr<OutstationMetrics> metrics = nullptr;
+    std::shared_ptr<PointHistory> history = nullptr;
+    std::shared_ptr<const PointLayout> layout = nullptr;
+
+    opendnp3::CommandStatus count(CommandType type,
+                                  opendnp3::CommandStatus status,
+                                  std::chrono::steady_clock::time_point start);
+
 public:
-    IOTable() = default;
+    explicit IOTable(std::shared_ptr<Scheduler> scheduler);
     ~IOTable() override = default;
-    static std::shared_ptr<IOTable> Create();
+    static std::shared_ptr<IOTable> Create(std::shared_ptr<Scheduler> scheduler);
 
     opendnp3::DatabaseConfig ConfigureDatabase();
-    void RegisterOutstation(std::shared_ptr<opendnp3::IOutstation> outstation);
+    size_t NumPoints() const;
 
-    ftxui::Element RenderInputs();
-    ftxui::Element RenderOutputs();
+    // Copies the specs of the points, to lay out other tables alike
+    std::shared_ptr<const PointLayout> CaptureLayout() const;
+    // Points take their spec from the layout, which the table keeps. Returns the number of points now
+    // sharing a spec; the others, where the table differs from the layout, keep their own.
+    size_t ShareLayout(std::shared_ptr<const PointLayout> layout);
+    void RegisterOutstation(std::shared_ptr<opendnp3::IOutstation> outstation);
+    void RegisterEventStats(std::shared_ptr<EventStats> stats);
+    std::shared_ptr<EventStats> GetEventStats() const;
+    void RegisterHistorian(std::shared_ptr<Historian> hist);
+    void RegisterMetrics(std::shared_ptr<OutstationMetrics> m);
+    // Gives every point a ring of the history, which should have NumPoints() of them
+    void RegisterHistory(std::shared_ptr<PointHistory> hist);
+    void Apply(const opendnp3::Updates& updates);
+    std::shared_ptr<WaveformGenerator> GetWaveforms() const;
+    std::shared_ptr<PowerModel> GetPowerModel() const;
+
+    const std::vector<std::shared_ptr<Binary>>& GetBinaryInputs() const;
+    const std::vector<std::shared_ptr<DoubleBit>>& GetDoubleBitInputs() const;
+    const std::vector<std::shared_ptr<Analog>>& GetAnalogInputs() const;
+    const std::vector<std::shared_ptr<BinaryOutput>>& GetBinaryOutputs() const;
+    const std::vector<std::shared_ptr<AnalogOutput>>& GetAnalogOutputs() const;
 
     // Add measurements to the IOTable
     void RegisterBinaryInput(std::shared_ptr<Binary> input);
@@ -37,6 +92,7 @@ public:
     void RegisterAnalogInput(std::shared_ptr<Analog> input);
     void RegisterBinaryOutput(std::shared_ptr<BinaryOutput> output);
     void RegisterAnalogOutput(std::shared_ptr<AnalogOutput> output);
+    std::shared_ptr<Analog> CreateAnalogInput(const std::string& name, double deadband);
 
     // Add devices
     std::shared_ptr<SimpleDevice> CreateSimpleDevice(const std::string& name);
@@ -0,0 +1,613 @@
+#include "outstation/metrics.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+constexpr size_t OTHER_STATUS = OutstationMetrics::NUM_STATUSES - 1;
+
+std::string escapeLabel(const std::string& value)
+{
+    std::string escaped;
+    for (auto c : value)
+    {
+        if ((c == '\\') || (c == '"'))
+        {
+            escaped += '\\';
+        }
+        if (c == '\n')
+        {
+            escaped += "\\n";
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::string quote(const std::string& value)
+{
+    std::string quoted = "\"";
+    for (auto c : value)
+    {
+        if ((c == '\\') || (c == '"'))
+        {
+            quoted += '\\';
+        }
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+            continue;
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// Renders one metric family; samples are written by the caller between the family's header and the next one
+class Family
+{
+private:
+    std::ostringstream& out;
+    std::string name;
+
+public:
+    Family(std::ostringstream& out, std::string name, const char* type, const char* help)
+        : out(out), name(std::move(name))
+    {
+        out << "# HELP " << this->name << " " << help << "\n# TYPE " << this->name << " " << type << "\n";
+    }
+
+    void Sample(const std::string& labels, uint64_t value)
+    {
+        out << name << "{" << labels << "} " << value << "\n";
+    }
+};
+
+std::string label(const char* key, const std::string& value)
+{
+    return std::string(key) + "=\"" + escapeLabel(value) + "\"";
+}
+
+void writeCounts(std::ostringstream& out, const std::map<std::string, uint64_t>& counts)
+{
+    out << "{";
+    bool first = true;
+    for (const auto& [key, count] : counts)
+    {
+        out << (first ? "" : ",") << quote(key) << ":" << count;
+        first = false;
+    }
+    out << "}";
+}
+} // namespace
+
+// CommandTypeSpec
+
+char const* CommandTypeSpec::to_string(CommandType arg)
+{
+    switch (arg)
+    {
+    case CommandType::CROB:
+        return "CROB";
+    case CommandType::ANALOG:
+        return "ANALOG";
+    default:
+        return "UNDEFINED";
+    }
+}
+
+char const* CommandTypeSpec::to_human_string(CommandType arg)
+{
+    switch (arg)
+    {
+    case CommandType::CROB:
+        return "Control Relay Output Block";
+    case CommandType::ANALOG:
+        return "Analog Output";
+    default:
+        return "Undefined";
+    }
+}
+
+CommandType CommandTypeSpec::from_string(const std::string& arg)
+{
+    if (arg == "CROB")
+        return CommandType::CROB;
+    if (arg == "ANALOG")
+        return CommandType::ANALOG;
+    return CommandType::UNDEFINED;
+}
+
+// ChannelMetrics
+
+ChannelMetrics::ChannelMetrics(std::string name, std::shared_ptr<opendnp3::IChannelListener> listener)
+    : name(std::move(name)), listener(std::move(listener))
+{
+}
+
+std::shared_ptr<ChannelMetrics> ChannelMetrics::Create(std::string name,
+                                                       std::shared_ptr<opendnp3::IChannelListener> listener)
+{
+    return std::make_shared<ChannelMetrics>(std::move(name), std::move(listener));
+}
+
+void ChannelMetrics::OnStateChange(opendnp3::ChannelState value)
+{
+    state = value;
+    if (listener)
+    {
+        listener->OnStateChange(value);
+    }
+}
+
+void ChannelMetrics::SetChannel(std::shared_ptr<opendnp3::IChannel> ch)
+{
+    channel = ch;
+}
+
+const std::string& ChannelMetrics::GetName() const
+{
+    return name;
+}
+
+opendnp3::ChannelState ChannelMetrics::GetState() const
+{
+    return state.load();
+}
+
+opendnp3::LinkStatistics ChannelMetrics::GetStatistics() const
+{
+    // The channel owns its listener, so it is only referenced weakly here
+    auto ch = channel.lock();
+    return ch ? ch->GetStatistics() : opendnp3::LinkStatistics();
+}
+
+// OutstationMetrics
+
+OutstationMetrics::OutstationMetrics(std::string name,
+                                     std::shared_ptr<ChannelMetrics> channel,
+                                     std::shared_ptr<EventStats> events)
+    : name(std::move(name)), channel(std::move(channel)), events(std::move(events))
+{
+}
+
+std::shared_ptr<OutstationMetrics> OutstationMetrics::Create(std::string name,
+                                                             std::shared_ptr<ChannelMetrics> channel,
+                                                             std::shared_ptr<EventStats> events)
+{
+    return std::make_shared<OutstationMetrics>(std::move(name), std::move(channel), std::move(events));
+}
+
+void OutstationMetrics::Command(CommandType type, opendnp3::CommandStatus status, std::chrono::nanoseconds duration)
+{
+    if (type != CommandType::UNDEFINED)
+    {
+        commands[static_cast<size_t>(type)]++;
+    }
+    auto code = static_cast<size_t>(opendnp3::CommandStatusSpec::to_type(status));
+    statuses[(code < OTHER_STATUS) ? code : OTHER_STATUS]++;
+
+    auto nanos = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+    size_t bucket = 0;
+    for (auto micros = nanos / 1000; (micros > 0) && (bucket < NUM_LATENCY_BUCKETS - 1); micros >>= 1)
+    {
+        bucket++;
+    }
+    latencies[bucket]++;
+    totalLatency += nanos;
+}
+
+void OutstationMetrics::Applied()
+{
+    applied++;
+}
+
+void OutstationMetrics::Header(bool received, const std::string& function)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    (received ? requests : responses)[function]++;
+}
+
+void OutstationMetrics::SetOutstation(std::shared_ptr<opendnp3::IOutstation> os)
+{
+    outstation = os;
+}
+
+const std::string& OutstationMetrics::GetName() const
+{
+    return name;
+}
+
+std::shared_ptr<ChannelMetrics> OutstationMetrics::GetChannel() const
+{
+    return channel;
+}
+
+std::shared_ptr<EventStats> OutstationMetrics::GetEventStats() const
+{
+    return events;
+}
+
+opendnp3::StackStatistics OutstationMetrics::GetStackStatistics() const
+{
+    auto os = outstation.lock();
+    return os ? os->GetStackStatistics() : opendnp3::StackStatistics();
+}
+
+uint64_t OutstationMetrics::NumCommands(CommandType type) const
+{
+    return (type == CommandType::UNDEFINED) ? 0 : commands[static_cast<size_t>(type)].load();
+}
+
+std::vector<std::pair<opendnp3::CommandStatus, uint64_t>> OutstationMetrics::GetStatuses() const
+{
+    std::vector<std::pair<opendnp3::CommandStatus, uint64_t>> result;
+    for (size_t code = 0; code < NUM_STATUSES; ++code)
+    {
+        auto count = statuses[code].load();
+        if (count == 0)
+        {
+            continue;
+        }
+        auto status = (code == OTHER_STATUS) ? opendnp3::CommandStatus::UNDEFINED
+                                             : opendnp3::CommandStatusSpec::from_type(static_cast<uint8_t>(code));
+        result.emplace_back(status, count);
+    }
+    return result;
+}
+
+OutstationMetrics::Latencies OutstationMetrics::GetLatencies() const
+{
+    Latencies result{};
+    for (size_t b = 0; b < NUM_LATENCY_BUCKETS; ++b)
+    {
+        result[b] = latencies[b].load();
+    }
+    return result;
+}
+
+std::chrono::nanoseconds OutstationMetrics::GetTotalLatency() const
+{
+    return std::chrono::nanoseconds(totalLatency.load());
+}
+
+uint64_t OutstationMetrics::NumApplied() const
+{
+    return applied.load();
+}
+
+std::map<std::string, uint64_t> OutstationMetrics::GetRequests()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return requests;
+}
+
+std::map<std::string, uint64_t> OutstationMetrics::GetResponses()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return responses;
+}
+
+uint64_t OutstationMetrics::NumUnsolicited()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = responses.find("UNSOLICITED_RESPONSE");
+    return (it == responses.end()) ? 0 : it->second;
+}
+
+// MetricsRegistry
+
+std::shared_ptr<MetricsRegistry> MetricsRegistry::Create()
+{
+    return std::make_shared<MetricsRegistry>();
+}
+
+void MetricsRegistry::AddChannel(std::shared_ptr<ChannelMetrics> channel)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    channels.push_back(std::move(channel));
+}
+
+void MetricsRegistry::AddOutstation(std::shared_ptr<OutstationMetrics> metrics)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    byName[metrics->GetName()] = metrics;
+    outstations.push_back(std::move(metrics));
+}
+
+std::shared_ptr<OutstationMetrics> MetricsRegistry::Find(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = byName.find(name);
+    return (it == byName.end()) ? nullptr : it->second;
+}
+
+std::string MetricsRegistry::RenderPrometheus()
+{
+    std::vector<std::shared_ptr<ChannelMetrics>> chs;
+    std::vector<std::shared_ptr<OutstationMetrics>> oss;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        chs = channels;
+        oss = outstations;
+    }
+
+    // Statistics are read once per channel and outstation, then written out family by family
+    std::vector<opendnp3::LinkStatistics> links;
+    for (const auto& ch : chs)
+    {
+        links.push_back(ch->GetStatistics());
+    }
+    std::vector<opendnp3::StackStatistics> stacks;
+    for (const auto& os : oss)
+    {
+        stacks.push_back(os->GetStackStatistics());
+    }
+
+    std::ostringstream out;
+    {
+        Family family(out, "dnp3_channel_open", "gauge", "Whether a master is connected to the channel");
+        for (const auto& ch : chs)
+        {
+            family.Sample(label("channel", ch->GetName()), (ch->GetState() == opendnp3::ChannelState::OPEN) ? 1 : 0);
+        }
+    }
+    {
+        Family family(out, "dnp3_channel_opens_total", "counter", "Connections accepted by the channel");
+        for (size_t i = 0; i < chs.size(); ++i)
+        {
+            family.Sample(label("channel", chs[i]->GetName()), links[i].channel.numOpen);
+        }
+    }
+    {
+        Family received(out, "dnp3_channel_bytes_received_total", "counter", "Bytes received by the channel");
+        for (size_t i = 0; i < chs.size(); ++i)
+        {
+            received.Sample(label("channel", chs[i]->GetName()), links[i].channel.numBytesRx);
+        }
+    }
+    {
+        Family sent(out, "dnp3_channel_bytes_sent_total", "counter", "Bytes sent by the channel");
+        for (size_t i = 0; i < chs.size(); ++i)
+        {
+            sent.Sample(label("channel", chs[i]->GetName()), links[i].channel.numBytesTx);
+        }
+    }
+    {
+        Family received(out, "dnp3_channel_frames_received_total", "counter", "Link frames received by the channel");
+        for (size_t i = 0; i < chs.size(); ++i)
+        {
+            received.Sample(label("channel", chs[i]->GetName()), links[i].parser.numLinkFrameRx);
+        }
+    }
+    {
+        Family sent(out, "dnp3_channel_frames_sent_total", "counter", "Link frames sent by the channel");
+        for (size_t i = 0; i < chs.size(); ++i)
+        {
+            sent.Sample(label("channel", chs[i]->GetName()), links[i].channel.numLinkFrameTx);
+        }
+    }
+    {
+        Family received(out, "dnp3_transport_segments_received_total", "counter", "Transport segments received");
+        for (size_t i = 0; i < oss.size(); ++i)
+        {
+            received.Sample(label("outstation", oss[i]->GetName()), stacks[i].transport.rx.numTransportRx);
+        }
+    }
+    {
+        Family sent(out, "dnp3_transport_segments_sent_total", "counter", "Transport segments sent");
+        for (size_t i = 0; i < oss.size(); ++i)
+        {
+            sent.Sample(label("outstation", oss[i]->GetName()), stacks[i].transport.tx.numTransportTx);
+        }
+    }
+    {
+        Family family(out, "dnp3_requests_total", "counter", "Application requests received, by function code");
+        for (const auto& os : oss)
+        {
+            for (const auto& [function, count] : os->GetRequests())
+            {
+                family.Sample(label("outstation", os->GetName()) + "," + label("function", function), count);
+            }
+        }
+    }
+    {
+        Family family(out, "dnp3_responses_total", "counter", "Application responses sent, by function code");
+        for (const auto& os : oss)
+        {
+            for (const auto& [function, count] : os->GetResponses())
+            {
+                family.Sample(label("outstation", os->GetName()) + "," + label("function", function), count);
+            }
+        }
+    }
+    {
+        Family family(out, "dnp3_unsolicited_responses_total", "counter", "Unsolicited responses sent");
+        for (const auto& os : oss)
+        {
+            family.Sample(label("outstation", os->GetName()), os->NumUnsolicited());
+        }
+    }
+    {
+        Family family(out, "dnp3_commands_total", "counter", "Commands operated, by type");
+        for (const auto& os : oss)
+        {
+            for (auto type : {CommandType::CROB, CommandType::ANALOG})
+            {
+                auto labels
+                    = label("outstation", os->GetName()) + "," + label("type", CommandTypeSpec::to_string(type));
+                family.Sample(labels, os->NumCommands(type));
+            }
+        }
+    }
+    {
+        Family family(out, "dnp3_command_statuses_total", "counter", "Statuses returned to operate commands");
+        for (const auto& os : oss)
+        {
+            for (const auto& [status, count] : os->GetStatuses())
+            {
+                auto name = opendnp3::CommandStatusSpec::to_string(status);
+                family.Sample(label("outstation", os->GetName()) + "," + label("status", name), count);
+            }
+        }
+    }
+    {
+        auto name = std::string("dnp3_command_duration_seconds");
+        out << "# HELP " << name << " Time taken to handle operate commands\n# TYPE " << name << " histogram\n";
+        for (const auto& os : oss)
+        {
+            auto outstationLabel = label("outstation", os->GetName());
+            auto buckets = os->GetLatencies();
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b < buckets.size(); ++b)
+            {
+                cumulative += buckets[b];
+                std::ostringstream bound;
+                if (b + 1 < buckets.size())
+                {
+                    bound << static_cast<double>(uint64_t(1) << b) / 1e6;
+                }
+                else
+                {
+                    bound << "+Inf";
+                }
+                out << name << "_bucket{" << outstationLabel << ",le=\"" << bound.str() << "\"} " << cumulative << "\n";
+            }
+            out << name << "_sum{" << outstationLabel << "} "
+                << std::chrono::duration<double>(os->GetTotalLatency()).count() << "\n";
+            out << name << "_count{" << outstationLabel << "} " << cumulative << "\n";
+        }
+    }
+    {
+        Family family(out, "dnp3_updates_applied_total", "counter", "Batches of point updates applied");
+        for (const auto& os : oss)
+        {
+            family.Sample(label("outstation", os->GetName()), os->NumApplied());
+        }
+    }
+
+    std::vector<std::array<EventCounters, EventStats::NUM_TYPES>> counters;
+    for (const auto& os : oss)
+    {
+        auto& entry = counters.emplace_back();
+        for (size_t t = 0; t < EventStats::NUM_TYPES; ++t)
+        {
+            entry[t] = os->GetEventStats() ? os->GetEventStats()->Get(static_cast<EventType>(t)) : EventCounters();
+        }
+    }
+    auto eventFamily = [&](const char* name, const char* type, const char* help, auto field) {
+        Family family(out, name, type, help);
+        for (size_t i = 0; i < oss.size(); ++i)
+        {
+            for (size_t t = 0; t < EventStats::NUM_TYPES; ++t)
+            {
+                auto typeName = EventTypeSpec::to_string(static_cast<EventType>(t));
+                family.Sample(label("outstation", oss[i]->GetName()) + "," + label("type", typeName),
+                              counters[i][t].*field);
+            }
+        }
+    };
+    eventFamily("dnp3_events_queued_total", "counter", "Events generated", &EventCounters::queued);
+    eventFamily("dnp3_events_confirmed_total", "counter", "Events confirmed by the master", &EventCounters::confirmed);
+    eventFamily("dnp3_event_buffer_occupancy", "gauge", "Events waiting for confirmation", &EventCounters::occupancy);
+    eventFamily("dnp3_event_overflows_total", "counter", "Events discarded by full buffers", &EventCounters::overflows);
+
+    return out.str();
+}
+
+std::string MetricsRegistry::RenderJson()
+{
+    std::vector<std::shared_ptr<ChannelMetrics>> chs;
+    std::vector<std::shared_ptr<OutstationMetrics>> oss;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        chs = channels;
+        oss = outstations;
+    }
+
+    std::ostringstream out;
+    out << "{\"channels\":[";
+    for (size_t i = 0; i < chs.size(); ++i)
+    {
+        auto stats = chs[i]->GetStatistics();
+        out << ((i > 0) ? "," : "") << "{\"name\":" << quote(chs[i]->GetName())
+            << ",\"state\":" << quote(opendnp3::ChannelStateSpec::to_string(chs[i]->GetState()))
+            << ",\"opens\":" << stats.channel.numOpen << ",\"bytesReceived\":" << stats.channel.numBytesRx
+            << ",\"bytesSent\":" << stats.channel.numBytesTx << ",\"framesReceived\":" << stats.parser.numLinkFrameRx
+            << ",\"framesSent\":" << stats.channel.numLinkFrameTx << "}";
+    }
+    out << "],\"outstations\":[";
+    for (size_t i = 0; i < oss.size(); ++i)
+    {
+        const auto& os = oss[i];
+        auto stack = os->GetStackStatistics();
+        out << ((i > 0) ? "," : "") << "{\"name\":" << quote(os->GetName())
+            << ",\"channel\":" << quote(os->GetChannel() ? os->GetChannel()->GetName() : std::string())
+            << ",\"segmentsReceived\":" << stack.transport.rx.numTransportRx
+            << ",\"segmentsSent\":" << stack.transport.tx.numTransportTx << ",\"requests\":";
+        writeCounts(out, os->GetRequests());
+        out << ",\"responses\":";
+        writeCounts(out, os->GetResponses());
+        out << ",\"unsolicited\":" << os->NumUnsolicited()
+            << ",\"commands\":{\"CROB\":" << os->NumCommands(CommandType::CROB)
+            << ",\"ANALOG\":" << os->NumCommands(CommandType::ANALOG) << "},\"statuses\":";
+        std::map<std::string, uint64_t> statuses;
+        for (const auto& [status, count] : os->GetStatuses())
+        {
+            statuses[opendnp3::CommandStatusSpec::to_string(status)] = count;
+        }
+        writeCounts(out, statuses);
+        out << ",\"updatesApplied\":" << os->NumApplied() << ",\"events\":{";
+        for (size_t t = 0; t < EventStats::NUM_TYPES; ++t)
+        {
+            auto type = static_cast<EventType>(t);
+            auto counters = os->GetEventStats() ? os->GetEventStats()->Get(type) : EventCounters();
+            out << ((t > 0) ? "," : "") << quote(EventTypeSpec::to_string(type)) << ":{\"queued\":" << counters.queued
+                << ",\"confirmed\":" << counters.confirmed << ",\"occupancy\":" << counters.occupancy
+                << ",\"overflows\":" << counters.overflows << "}";
+        }
+        out << "}}";
+    }
+    out << "]}\n";
+    return out.str();
+}
+
+// MetricsLogTap
+
+MetricsLogTap::MetricsLogTap(std::shared_ptr<opendnp3::ILogHandler> handler, std::shared_ptr<MetricsRegistry> registry)
+    : handler(std::move(handler)), registry(std::move(registry))
+{
+}
+
+std::shared_ptr<MetricsLogTap> MetricsLogTap::Create(std::shared_ptr<opendnp3::ILogHandler> handler,
+                                                     std::shared_ptr<MetricsRegistry> registry)
+{
+    return std::make_shared<MetricsLogTap>(std::move(handler), std::move(registry));
+}
+
+void MetricsLogTap::log(opendnp3::ModuleId module,
+                        const char* id,
+                        opendnp3::LogLevel level,
+                        char const* location,
+                        char const* message)
+{
+    bool received = (level.value == opendnp3::flags::APP_HEADER_RX.value);
+    if (received || (level.value == opendnp3::flags::APP_HEADER_TX.value))
+    {
+        // Headers are logged as "FIR: 1 FIN: 1 CON: 0 UNS: 0 SEQ: 2 FUNC: READ ..."
+        const char* function = std::strstr(message, "FUNC: ");
+        auto metrics = function ? registry->Find(id) : nullptr;
+        if (metrics)
+        {
+            function += std::strlen("FUNC: ");
+            metrics->Header(received, std::string(function, std::strcspn(function, " ")));
+        }
+    }
+
+    if (handler)
+    {
+        handler->log(module, id, level, location, message);
+    }
+}
@@ -0,0 +1,175 @@
+#ifndef CALDERADNP3_OUTSTATION_METRICS_H
+#define CALDERADNP3_OUTSTATION_METRICS_H
+
+#include "outstation/event_stats.h"
+
+#include <opendnp3/channel/IChannel.h>
+#include <opendnp3/channel/IChannelListener.h>
+#include <opendnp3/gen/CommandStatus.h>
+#include <opendnp3/logging/ILogHandler.h>
+#include <opendnp3/outstation/IOutstation.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class CommandType : uint8_t
+{
+    CROB = 0,
+    ANALOG = 1,
+    UNDEFINED = 127
+};
+
+struct CommandTypeSpec
+{
+    using enum_type_t = CommandType;
+
+    static char const* to_string(CommandType arg);
+    static char const* to_human_string(CommandType arg);
+    static CommandType from_string(const std::string& arg);
+};
+
+/**
+ * ChannelMetrics follows the connection state of one channel.
+ *
+ * It is the channel's listener, passing every state change on to the
+ * listener it wraps. Byte and frame counts are not copied: they are read
+ * from the channel's own statistics when the metrics are rendered.
+ */
+class ChannelMetrics final : public opendnp3::IChannelListener
+{
+private:
+    std::string name;
+    std::shared_ptr<opendnp3::IChannelListener> listener;
+    std::weak_ptr<opendnp3::IChannel> channel;
+    std::atomic<opendnp3::ChannelState> state{opendnp3::ChannelState::CLOSED};
+
+public:
+    ChannelMetrics(std::string name, std::shared_ptr<opendnp3::IChannelListener> listener);
+    static std::shared_ptr<ChannelMetrics> Create(std::string name,
+                                                  std::shared_ptr<opendnp3::IChannelListener> listener);
+
+    void OnStateChange(opendnp3::ChannelState state) override;
+
+    void SetChannel(std::shared_ptr<opendnp3::IChannel> ch);
+    const std::string& GetName() const;
+    opendnp3::ChannelState GetState() const;
+    opendnp3::LinkStatistics GetStatistics() const;
+};
+
+/**
+ * OutstationMetrics counts the protocol activity of one outstation.
+ *
+ * Commands, their statuses and how long they took to handle are counted by
+ * the IOTable, and updates by every path applying them to the outstation.
+ * Durations go into a histogram of power of two buckets: bucket b counts the
+ * commands handled in less than 2^b microseconds, the last one all others.
+ * Application headers are counted by MetricsLogTap, from the APP_HEADER_RX
+ * and APP_HEADER_TX messages opendnp3 logs, as the outstation application
+ * is not told about every request: the channels of an outstation with
+ * metrics must have those log levels enabled. All counters are cumulative.
+ */
+class OutstationMetrics
+{
+public:
+    static constexpr size_t NUM_STATUSES = 14; // the statuses of IEEE 1815 and one for any other
+    static constexpr size_t NUM_LATENCY_BUCKETS = 24;
+
+    using Latencies = std::array<uint64_t, NUM_LATENCY_BUCKETS>;
+
+    OutstationMetrics(std::string name, std::shared_ptr<ChannelMetrics> channel, std::shared_ptr<EventStats> events);
+    static std::shared_ptr<OutstationMetrics> Create(std::string name,
+                                                     std::shared_ptr<ChannelMetrics> channel,
+                                                     std::shared_ptr<EventStats> events);
+
+    void Command(CommandType type, opendnp3::CommandStatus status, std::chrono::nanoseconds duration);
+    void Applied();
+    void Header(bool received, const std::string& function);
+
+    void SetOutstation(std::shared_ptr<opendnp3::IOutstation> os);
+    const std::string& GetName() const;
+    std::shared_ptr<ChannelMetrics> GetChannel() const;
+    std::shared_ptr<EventStats> GetEventStats() const;
+    opendnp3::StackStatistics GetStackStatistics() const;
+
+    uint64_t NumCommands(CommandType type) const;
+    std::vector<std::pair<opendnp3::CommandStatus, uint64_t>> GetStatuses() const;
+    Latencies GetLatencies() const;
+    std::chrono::nanoseconds GetTotalLatency() const;
+    uint64_t NumApplied() const;
+    std::map<std::string, uint64_t> GetRequests();
+    std::map<std::string, uint64_t> GetResponses();
+    uint64_t NumUnsolicited();
+
+private:
+    std::string name;
+    std::shared_ptr<ChannelMetrics> channel;
+    std::shared_ptr<EventStats> events;
+    std::weak_ptr<opendnp3::IOutstation> outstation;
+
+    std::array<std::atomic<uint64_t>, 2> commands{};
+    std::array<std::atomic<uint64_t>, NUM_STATUSES> statuses{};
+    std::array<std::atomic<uint64_t>, NUM_LATENCY_BUCKETS> latencies{};
+    std::atomic<uint64_t> totalLatency{0};
+    std::atomic<uint64_t> applied{0};
+
+    std::mutex mtx;
+    std::map<std::string, uint64_t> requests;
+    std::map<std::string, uint64_t> responses;
+};
+
+/**
+ * MetricsRegistry holds the metrics of every hosted channel and outstation
+ * and renders them in the Prometheus text format or as JSON.
+ */
+class MetricsRegistry
+{
+private:
+    std::mutex mtx;
+    std::vector<std::shared_ptr<ChannelMetrics>> channels;
+    std::vector<std::shared_ptr<OutstationMetrics>> outstations;
+    std::unordered_map<std::string, std::shared_ptr<OutstationMetrics>> byName;
+
+public:
+    MetricsRegistry() = default;
+    static std::shared_ptr<MetricsRegistry> Create();
+
+    void AddChannel(std::shared_ptr<ChannelMetrics> channel);
+    void AddOutstation(std::shared_ptr<OutstationMetrics> metrics);
+    std::shared_ptr<OutstationMetrics> Find(const std::string& name);
+
+    std::string RenderPrometheus();
+    std::string RenderJson();
+};
+
+/**
+ * MetricsLogTap is a log handler counting the application headers logged by
+ * each outstation before passing every message on to the handler it wraps.
+ * It only sees the headers of channels logging APP_HEADER_RX and APP_HEADER_TX.
+ */
+class MetricsLogTap final : public opendnp3::ILogHandler
+{
+private:
+    std::shared_ptr<opendnp3::ILogHandler> handler;
+    std::shared_ptr<MetricsRegistry> registry;
+
+public:
+    MetricsLogTap(std::shared_ptr<opendnp3::ILogHandler> handler, std::shared_ptr<MetricsRegistry> registry);
+    static std::shared_ptr<MetricsLogTap> Create(std::shared_ptr<opendnp3::ILogHandler> handler,
+                                                 std::shared_ptr<MetricsRegistry> registry);
+
+    void log(opendnp3::ModuleId module,
+             const char* id,
+             opendnp3::LogLevel level,
+             char const* location,
+             char const* message) override;
+};
+
+#endif // CALDERADNP3_OUTSTATION_METRICS_H
@@ -0,0 +1,266 @@
+#include "outstation/metrics_server.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+constexpr size_t MAX_REQUEST_SIZE = 8 * 1024;
+} // namespace
+
+MetricsServer::MetricsServer(std::shared_ptr<MetricsRegistry> registry) : registry(std::move(registry)) {}
+
+MetricsServer::~MetricsServer()
+{
+    Stop();
+}
+
+std::shared_ptr<MetricsServer> MetricsServer::Create(std::shared_ptr<MetricsRegistry> registry)
+{
+    return std::make_shared<MetricsServer>(std::move(registry));
+}
+
+void MetricsServer::DumpJson(const std::string& path, std::chrono::milliseconds interval)
+{
+    dumpPath = path;
+    dumpInterval = interval;
+    dumpThread = std::thread([this]() { dumpLoop(); });
+}
+
+void MetricsServer::dumpLoop()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!wake.wait_for(lock, dumpInterval, [this]() { return stopping.load(); }))
+    {
+        lock.unlock();
+        dump();
+        lock.lock();
+    }
+}
+
+void MetricsServer::dump()
+{
+    auto temporary = dumpPath + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        if (!file.is_open())
+        {
+            return;
+        }
+        file << registry->RenderJson();
+    }
+#ifdef _WIN32
+    std::remove(dumpPath.c_str());
+#endif
+    std::rename(temporary.c_str(), dumpPath.c_str());
+}
+
+#ifdef _WIN32
+
+void MetricsServer::Listen(const std::string&, uint16_t)
+{
+    throw std::runtime_error("the metrics endpoint is not supported on this platform");
+}
+
+void MetricsServer::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (dumpThread.joinable())
+    {
+        dumpThread.join();
+    }
+}
+
+void MetricsServer::acceptLoop() {}
+
+void MetricsServer::serve(int) {}
+
+#else
+
+void MetricsServer::Listen(const std::string& address, uint16_t port)
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1)
+    {
+        throw std::runtime_error("bad metrics address: " + address);
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        throw std::runtime_error("cannot create metrics socket: " + std::string(std::strerror(errno)));
+    }
+
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if ((bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) || (listen(fd, 8) < 0))
+    {
+        auto error = std::string(std::strerror(errno));
+        close(fd);
+        throw std::runtime_error("cannot serve metrics on " + address + ":" + std::to_string(port) + ": " + error);
+    }
+
+    // Non-blocking, so a connection reset between poll and accept cannot block the accept loop
+    if ((fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0) || (pipe(wakeFds) < 0))
+    {
+        auto error = std::string(std::strerror(errno));
+        close(fd);
+        throw std::runtime_error("cannot serve metrics on " + address + ":" + std::to_string(port) + ": " + error);
+    }
+
+    listenFd = fd;
+    httpThread = std::thread([this]() { acceptLoop(); });
+}
+
+void MetricsServer::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stopping.exchange(true))
+        {
+            return;
+        }
+    }
+    wake.notify_all();
+    if (dumpThread.joinable())
+    {
+        dumpThread.join();
+    }
+
+    // Writing to the pipe wakes the thread waiting for a connection
+    if (listenFd >= 0)
+    {
+        const char wakeup = 0;
+        while ((write(wakeFds[1], &wakeup, 1) < 0) && (errno == EINTR))
+        {
+        }
+        if (httpThread.joinable())
+        {
+            httpThread.join();
+        }
+        close(listenFd);
+        close(wakeFds[0]);
+        close(wakeFds[1]);
+        listenFd = -1;
+    }
+}
+
+void MetricsServer::acceptLoop()
+{
+    while (!stopping)
+    {
+        pollfd fds[2] = {{listenFd, POLLIN, 0}, {wakeFds[0], POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+        if (fds[1].revents != 0)
+        {
+            return;
+        }
+
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ECONNABORTED))
+            {
+                continue;
+            }
+            return;
+        }
+
+        // The receive timeout needs a blocking socket, which some platforms do not give a connection by default
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+        serve(fd);
+        close(fd);
+    }
+}
+
+void MetricsServer::serve(int fd)
+{
+    // A client that stops sending must not hold up the next scrape
+    timeval timeout{2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[1024];
+    while ((request.find("\r\n\r\n") == std::string::npos) && (request.size() < MAX_REQUEST_SIZE))
+    {
+        auto received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0)
+        {
+            if ((received < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            return;
+        }
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    // Only the request line matters: "GET /metrics HTTP/1.1"
+    auto methodEnd = request.find(' ');
+    auto pathEnd = (methodEnd == std::string::npos) ? std::string::npos : request.find(' ', methodEnd + 1);
+    auto method = request.substr(0, methodEnd);
+    auto path = (pathEnd == std::string::npos) ? std::string() : request.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+
+    std::string status = "200 OK";
+    std::string contentType = "text/plain; version=0.0.4; charset=utf-8";
+    std::string body;
+    if (method != "GET")
+    {
+        status = "405 Method Not Allowed";
+        body = "only GET is supported\n";
+    }
+    else if (path == "/metrics")
+    {
+        body = registry->RenderPrometheus();
+    }
+    else if (path == "/metrics.json")
+    {
+        contentType = "application/json";
+        body = registry->RenderJson();
+    }
+    else
+    {
+        status = "404 Not Found";
+        body = "metrics are served on /metrics and /metrics.json\n";
+    }
+
+    auto response = "HTTP/1.1 " + status + "\r\nContent-Type: " + contentType
+                    + "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    size_t sent = 0;
+    while (sent < response.size())
+    {
+        auto n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+#endif
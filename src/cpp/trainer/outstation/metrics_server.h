@@ -0,0 +1,59 @@
+#ifndef CALDERADNP3_OUTSTATION_METRICS_SERVER_H
+#define CALDERADNP3_OUTSTATION_METRICS_SERVER_H
+
+#include "outstation/metrics.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * MetricsServer publishes a MetricsRegistry for scraping.
+ *
+ * Listen serves GET /metrics in the Prometheus text format and GET
+ * /metrics.json as JSON over plain HTTP, one request per connection, on one
+ * thread: scrapes are rare, so the statistics are only gathered when one
+ * arrives. DumpJson also writes the JSON to a file at a fixed interval of
+ * wall clock time, replacing the file atomically so readers never see a
+ * partial dump. The accept loop polls the socket together with a pipe that
+ * Stop writes to, as shutting a listening socket down does not wake accept
+ * on every platform. The HTTP endpoint is only available on POSIX systems.
+ */
+class MetricsServer
+{
+private:
+    std::shared_ptr<MetricsRegistry> registry;
+    std::atomic<bool> stopping{false};
+
+    int listenFd = -1;
+    int wakeFds[2] = {-1, -1}; // self-pipe written by Stop to wake the accept loop
+    std::thread httpThread;
+
+    std::string dumpPath;
+    std::chrono::milliseconds dumpInterval{0};
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::thread dumpThread;
+
+    void acceptLoop();
+    void serve(int fd);
+    void dumpLoop();
+    void dump();
+
+public:
+    explicit MetricsServer(std::shared_ptr<MetricsRegistry> registry);
+    ~MetricsServer();
+    static std::shared_ptr<MetricsServer> Create(std::shared_ptr<MetricsRegistry> registry);
+
+    // Throws std::runtime_error when the address cannot be bound
+    void Listen(const std::string& address, uint16_t port);
+    void DumpJson(const std::string& path, std::chrono::milliseconds interval);
+    void Stop();
+};
+
+#endif // CALDERADNP3_OUTSTATION_METRICS_SERVER_H
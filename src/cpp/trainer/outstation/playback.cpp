@@ -0,0 +1,268 @@
+#include "outstation/playback.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace
+{
+constexpr size_t READ_BUFFER_SIZE = 256 * 1024;
+
+void splitRow(const std::string& line, std::vector<std::string>& cells)
+{
+    cells.clear();
+    size_t start = 0;
+    while (true)
+    {
+        auto end = line.find(',', start);
+        auto cell = line.substr(start, (end == std::string::npos) ? std::string::npos : end - start);
+
+        // Surrounding whitespace and quotes are dropped; quoted commas are not supported
+        auto first = cell.find_first_not_of(" \t\r\"");
+        auto last = cell.find_last_not_of(" \t\r\"");
+        cells.push_back((first == std::string::npos) ? std::string() : cell.substr(first, last - first + 1));
+
+        if (end == std::string::npos)
+        {
+            return;
+        }
+        start = end + 1;
+    }
+}
+
+// Days between 1970-01-01 and the given date of the proleptic Gregorian calendar
+int64_t daysFromCivil(int64_t y, unsigned m, unsigned d)
+{
+    y -= (m <= 2) ? 1 : 0;
+    const int64_t era = ((y >= 0) ? y : y - 399) / 400;
+    const auto yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + ((m > 2) ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// Accepts seconds, or an ISO 8601 date and time whose time zone, if any, is ignored
+bool parseTimestamp(const std::string& text, double& seconds)
+{
+    errno = 0;
+    char* end = nullptr;
+    seconds = std::strtod(text.c_str(), &end);
+    if ((errno == 0) && (end != text.c_str()) && (*end == '\0'))
+    {
+        return true;
+    }
+
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    int hour = 0;
+    int minute = 0;
+    double second = 0.0;
+    char separator = 0;
+    if (std::sscanf(text.c_str(), "%d-%d-%d%c%d:%d:%lf", &year, &month, &day, &separator, &hour, &minute, &second)
+            != 7
+        || ((separator != 'T') && (separator != ' ')) || (month < 1) || (month > 12) || (day < 1) || (day > 31))
+    {
+        return false;
+    }
+    auto days = daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+    seconds = static_cast<double>(days) * 86400.0 + hour * 3600.0 + minute * 60.0 + second;
+    return true;
+}
+} // namespace
+
+Playback::Playback(std::shared_ptr<IOTable> table, std::shared_ptr<Scheduler> scheduler)
+    : table(table), scheduler(std::move(scheduler)), points(table), buffer(READ_BUFFER_SIZE)
+{
+}
+
+Playback::~Playback()
+{
+    Stop();
+}
+
+std::shared_ptr<Playback> Playback::Create(std::shared_ptr<IOTable> table, std::shared_ptr<Scheduler> scheduler)
+{
+    return std::make_shared<Playback>(std::move(table), std::move(scheduler));
+}
+
+void Playback::Open(const std::string& path)
+{
+    file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.open(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("cannot open " + path);
+    }
+
+    std::string header;
+    if (!std::getline(file, header))
+    {
+        throw std::runtime_error(path + " is empty");
+    }
+    std::vector<std::string> names;
+    splitRow(header, names);
+    if (names.size() < 2)
+    {
+        throw std::runtime_error(path + " needs a timestamp column and at least one point column");
+    }
+
+    // Column 0 is the timestamp
+    columns.assign(names.size(), std::nullopt);
+    for (size_t c = 1; c < names.size(); ++c)
+    {
+        PointRef ref;
+        std::string error;
+        if (points.Resolve(names[c], ref, error))
+        {
+            columns[c] = ref;
+        }
+        else
+        {
+            unmapped.push_back(names[c]);
+        }
+    }
+
+    hasRow = readRow();
+    firstTime = rowTime;
+}
+
+const std::vector<std::string>& Playback::GetUnmappedColumns() const
+{
+    return unmapped;
+}
+
+void Playback::SetSpeed(double value)
+{
+    speed = (value > 0.0) ? value : 1.0;
+}
+
+void Playback::SetLagListener(double thresholdSeconds, LagListener listener)
+{
+    lagThreshold = thresholdSeconds;
+    lagListener = std::move(listener);
+}
+
+void Playback::Start()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (running || !hasRow)
+    {
+        status.finished = !hasRow;
+        return;
+    }
+    running = true;
+    startTime = scheduler->Now();
+    task = scheduler->ScheduleAt(dueTime(rowTime), [this]() { step(); });
+}
+
+void Playback::Stop()
+{
+    Scheduler::TaskId current = Scheduler::INVALID_TASK;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        running = false;
+        current = task;
+        task = Scheduler::INVALID_TASK;
+    }
+
+    // A step already running completes, but does not schedule the next one
+    scheduler->Cancel(current);
+}
+
+PlaybackStatus Playback::GetStatus()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return status;
+}
+
+bool Playback::readRow()
+{
+    while (std::getline(file, line))
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+        splitRow(line, cells);
+        if (parseTimestamp(cells[0], rowTime))
+        {
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lock(mtx);
+        status.rejected++;
+    }
+    return false;
+}
+
+Scheduler::Clock::time_point Playback::dueTime(double time) const
+{
+    auto offset = std::chrono::duration<double>((time - firstTime) / speed);
+    return startTime + std::chrono::duration_cast<Scheduler::Clock::duration>(offset);
+}
+
+void Playback::step()
+{
+    auto builder = opendnp3::UpdateBuilder();
+    double time = rowTime;
+    auto due = dueTime(time);
+    uint64_t rows = 0;
+    uint64_t rejected = 0;
+
+    while (hasRow && (rowTime == time))
+    {
+        for (size_t c = 1; (c < cells.size()) && (c < columns.size()); ++c)
+        {
+            std::string error;
+            if (columns[c].has_value() && !cells[c].empty() && !points.Write(*columns[c], cells[c], builder, error))
+            {
+                rejected++;
+            }
+        }
+        rows++;
+        hasRow = readRow();
+    }
+    table->Apply(builder.Build());
+
+    auto lag = std::max(0.0, std::chrono::duration<double>(scheduler->Now() - due).count());
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        status.rows += rows;
+        status.batches++;
+        status.rejected += rejected;
+        status.lag = lag;
+        status.maxLag = std::max(status.maxLag, lag);
+        status.position = time - firstTime;
+
+        // Report once when falling behind, again only after catching up
+        if (!lagging && (lag > lagThreshold))
+        {
+            lagging = true;
+            notify = true;
+        }
+        else if (lagging && (lag < lagThreshold / 2))
+        {
+            lagging = false;
+        }
+
+        if (!hasRow)
+        {
+            status.finished = true;
+            running = false;
+            task = Scheduler::INVALID_TASK;
+        }
+        else if (running)
+        {
+            task = scheduler->ScheduleAt(dueTime(rowTime), [this]() { step(); });
+        }
+    }
+
+    if (notify && lagListener)
+    {
+        lagListener(lag);
+    }
+}
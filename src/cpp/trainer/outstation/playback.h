@@ -0,0 +1,97 @@
+#ifndef CALDERADNP3_OUTSTATION_PLAYBACK_H
+#define CALDERADNP3_OUTSTATION_PLAYBACK_H
+
+#include "outstation/io_table.h"
+#include "outstation/point_index.h"
+#include "outstation/scheduler.h"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct PlaybackStatus
+{
+    uint64_t rows = 0;
+    uint64_t batches = 0;
+    uint64_t rejected = 0; // cells that could not be parsed
+    double lag = 0.0;      // seconds the last batch was applied after its due time
+    double maxLag = 0.0;
+    double position = 0.0; // seconds into the recording
+    bool finished = false;
+};
+
+/**
+ * Playback replays a recorded CSV file into the input points of an IOTable.
+ *
+ * The first column is the timestamp, either in seconds or as an ISO 8601
+ * date and time, and every other column is a point, referenced in the header
+ * by type and index (ai:3) or by name. Empty cells leave a point unchanged.
+ * All rows sharing a timestamp are applied as one batch, at the time of that
+ * timestamp relative to the first row, divided by the speed.
+ *
+ * The file is streamed: only the row after the current batch is held in
+ * memory, so recordings of any length can be played. When the outstation
+ * cannot keep up, batches are applied as soon as possible and the lag
+ * listener is told once the lag exceeds the threshold.
+ */
+class Playback
+{
+public:
+    using LagListener = std::function<void(double)>;
+
+    Playback(std::shared_ptr<IOTable> table, std::shared_ptr<Scheduler> scheduler);
+    ~Playback();
+    static std::shared_ptr<Playback> Create(std::shared_ptr<IOTable> table, std::shared_ptr<Scheduler> scheduler);
+
+    // Throws std::runtime_error when the file cannot be read or has no timestamp column
+    void Open(const std::string& path);
+    const std::vector<std::string>& GetUnmappedColumns() const;
+
+    void SetSpeed(double speed);
+    void SetLagListener(double thresholdSeconds, LagListener listener);
+
+    void Start();
+    void Stop();
+    PlaybackStatus GetStatus();
+
+private:
+    std::shared_ptr<IOTable> table;
+    std::shared_ptr<Scheduler> scheduler;
+    PointIndex points;
+
+    std::vector<char> buffer;
+    std::ifstream file;
+    std::vector<std::optional<PointRef>> columns;
+    std::vector<std::string> unmapped;
+
+    // The row read ahead of the current batch
+    std::string line;
+    std::vector<std::string> cells;
+    bool hasRow = false;
+    double rowTime = 0.0;
+
+    double firstTime = 0.0;
+    double speed = 1.0;
+    Scheduler::Clock::time_point startTime;
+
+    double lagThreshold = 1.0;
+    LagListener lagListener;
+    bool lagging = false;
+
+    std::mutex mtx;
+    bool running = false;
+    Scheduler::TaskId task = Scheduler::INVALID_TASK;
+    PlaybackStatus status;
+
+    bool readRow();
+    Scheduler::Clock::time_point dueTime(double time) const;
+    void step();
+};
+
+#endif // CALDERADNP3_OUTSTATION_PLAYBACK_H
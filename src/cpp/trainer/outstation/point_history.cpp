@@ -0,0 +1,69 @@
+#include "outstation/point_history.h"
+
+#include <algorithm>
+
+PointHistory::PointHistory(size_t numRings, size_t depth)
+    : numRings(numRings),
+      depth(std::max<size_t>(depth, 1)),
+      arena(new Slot[numRings * this->depth]),
+      written(new std::atomic<uint64_t>[numRings])
+{
+    for (size_t r = 0; r < numRings; ++r)
+    {
+        written[r].store(0, std::memory_order_relaxed);
+    }
+}
+
+std::shared_ptr<PointHistory> PointHistory::Create(size_t numRings, size_t depth)
+{
+    return std::make_shared<PointHistory>(numRings, depth);
+}
+
+std::optional<uint32_t> PointHistory::Allocate()
+{
+    auto ring = allocated.fetch_add(1, std::memory_order_relaxed);
+    if (ring >= numRings)
+    {
+        allocated.store(static_cast<uint32_t>(numRings), std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    return ring;
+}
+
+size_t PointHistory::GetDepth() const
+{
+    return depth;
+}
+
+void PointHistory::Record(uint32_t ring, double value, uint64_t time)
+{
+    // Concurrent writers claim distinct samples; the stamp tells readers when the sample is complete
+    auto n = written[ring].fetch_add(1, std::memory_order_relaxed);
+    auto& slot = arena[ring * depth + n % depth];
+    slot.stamp.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.time.store(time, std::memory_order_relaxed);
+    slot.stamp.store(2 * n + 2, std::memory_order_release);
+}
+
+void PointHistory::Read(uint32_t ring, size_t count, std::vector<Sample>& samples) const
+{
+    samples.clear();
+    auto n = written[ring].load(std::memory_order_relaxed);
+    count = std::min<uint64_t>({count, n, depth});
+    for (auto i = n - count; i < n; ++i)
+    {
+        const auto& slot = arena[ring * depth + i % depth];
+        if (slot.stamp.load(std::memory_order_acquire) != 2 * i + 2)
+        {
+            continue;
+        }
+        Sample sample{slot.value.load(std::memory_order_relaxed), slot.time.load(std::memory_order_relaxed)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.stamp.load(std::memory_order_relaxed) == 2 * i + 2)
+        {
+            samples.push_back(sample);
+        }
+    }
+}
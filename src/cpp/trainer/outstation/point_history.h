@@ -0,0 +1,61 @@
+#ifndef CALDERADNP3_OUTSTATION_POINT_HISTORY_H
+#define CALDERADNP3_OUTSTATION_POINT_HISTORY_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+/**
+ * PointHistory keeps the latest values of points, a fixed number per point.
+ *
+ * Every point is given a ring of the same depth, all slices of one arena
+ * allocated up front, so the memory per point does not grow however long
+ * the outstation runs. A point records each change of its value with the
+ * time it was written. Recording and reading never lock. A point may be
+ * written from several threads at once (waveform ticks, playback, the
+ * control API and the shared memory bridge): each sample claims its slot
+ * with an atomic increment, and the slot is stamped with the number of the
+ * sample once it is complete, so readers skip samples still being written
+ * or already replaced.
+ */
+class PointHistory
+{
+public:
+    static constexpr size_t DEFAULT_DEPTH = 64;
+
+    struct Sample
+    {
+        double value = 0.0;
+        uint64_t time = 0; // milliseconds since the epoch, on the simulation clock
+    };
+
+    PointHistory(size_t numRings, size_t depth);
+    static std::shared_ptr<PointHistory> Create(size_t numRings, size_t depth = DEFAULT_DEPTH);
+
+    // The next free ring, if any is left
+    std::optional<uint32_t> Allocate();
+    size_t GetDepth() const;
+
+    void Record(uint32_t ring, double value, uint64_t time);
+
+    // The latest count samples of a ring at most, oldest first
+    void Read(uint32_t ring, size_t count, std::vector<Sample>& samples) const;
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> stamp{0}; // 2n + 2 once sample n is complete, odd while it is written
+        std::atomic<double> value{0.0};
+        std::atomic<uint64_t> time{0};
+    };
+
+    size_t numRings;
+    size_t depth;
+    std::unique_ptr<Slot[]> arena;
+    std::unique_ptr<std::atomic<uint64_t>[]> written; // samples ever claimed in each ring
+    std::atomic<uint32_t> allocated{0};
+};
+
+#endif // CALDERADNP3_OUTSTATION_POINT_HISTORY_H
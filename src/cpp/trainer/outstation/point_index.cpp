@@ -0,0 +1,282 @@
+#include "outstation/point_index.h"
+
+#include <cerrno>
+#include <cstdlib>
+
+namespace
+{
+bool parseDouble(const std::string& text, double& value)
+{
+    errno = 0;
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return (errno == 0) && (end != text.c_str()) && (*end == '\0');
+}
+
+// Plain decimal digits only, where strtoull would also take a sign, spaces or a 0x prefix
+bool parseIndex(const std::string& text, size_t& value)
+{
+    if (text.empty() || (text.find_first_not_of("0123456789") != std::string::npos))
+    {
+        return false;
+    }
+    errno = 0;
+    value = static_cast<size_t>(std::strtoull(text.c_str(), nullptr, 10));
+    return errno == 0;
+}
+
+bool parseBool(const std::string& text, bool& value)
+{
+    if ((text == "1") || (text == "true") || (text == "on") || (text == "closed"))
+    {
+        value = true;
+        return true;
+    }
+    if ((text == "0") || (text == "false") || (text == "off") || (text == "tripped"))
+    {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+bool parseDoubleBit(const std::string& text, opendnp3::DoubleBit& value)
+{
+    if ((text == "0") || (text == "intermediate"))
+    {
+        value = opendnp3::DoubleBit::INTERMEDIATE;
+    }
+    else if ((text == "1") || (text == "off"))
+    {
+        value = opendnp3::DoubleBit::DETERMINED_OFF;
+    }
+    else if ((text == "2") || (text == "on"))
+    {
+        value = opendnp3::DoubleBit::DETERMINED_ON;
+    }
+    else if ((text == "3") || (text == "indeterminate"))
+    {
+        value = opendnp3::DoubleBit::INDETERMINATE;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+// PointTypeSpec
+
+char const* PointTypeSpec::to_string(PointType arg)
+{
+    switch (arg)
+    {
+    case PointType::BINARY_INPUT:
+        return "bi";
+    case PointType::DOUBLE_BIT_INPUT:
+        return "dbi";
+    case PointType::ANALOG_INPUT:
+        return "ai";
+    case PointType::BINARY_OUTPUT:
+        return "bo";
+    case PointType::ANALOG_OUTPUT:
+        return "ao";
+    default:
+        return "undefined";
+    }
+}
+
+char const* PointTypeSpec::to_human_string(PointType arg)
+{
+    switch (arg)
+    {
+    case PointType::BINARY_INPUT:
+        return "Binary Input";
+    case PointType::DOUBLE_BIT_INPUT:
+        return "Double-bit Binary Input";
+    case PointType::ANALOG_INPUT:
+        return "Analog Input";
+    case PointType::BINARY_OUTPUT:
+        return "Binary Output";
+    case PointType::ANALOG_OUTPUT:
+        return "Analog Output";
+    default:
+        return "Undefined";
+    }
+}
+
+PointType PointTypeSpec::from_string(const std::string& arg)
+{
+    if (arg == "bi")
+        return PointType::BINARY_INPUT;
+    if (arg == "dbi")
+        return PointType::DOUBLE_BIT_INPUT;
+    if (arg == "ai")
+        return PointType::ANALOG_INPUT;
+    if (arg == "bo")
+        return PointType::BINARY_OUTPUT;
+    if (arg == "ao")
+        return PointType::ANALOG_OUTPUT;
+    return PointType::UNDEFINED;
+}
+
+// PointIndex
+
+PointIndex::PointIndex(std::shared_ptr<IOTable> table) : table(std::move(table))
+{
+    const auto& binaries = this->table->GetBinaryInputs();
+    for (size_t i = 0; i < binaries.size(); ++i)
+    {
+        names[binaries[i]->GetName()] = {PointType::BINARY_INPUT, static_cast<uint16_t>(i)};
+    }
+    const auto& doubleBits = this->table->GetDoubleBitInputs();
+    for (size_t i = 0; i < doubleBits.size(); ++i)
+    {
+        names[doubleBits[i]->GetName()] = {PointType::DOUBLE_BIT_INPUT, static_cast<uint16_t>(i)};
+    }
+    const auto& analogs = this->table->GetAnalogInputs();
+    for (size_t i = 0; i < analogs.size(); ++i)
+    {
+        names[analogs[i]->GetName()] = {PointType::ANALOG_INPUT, static_cast<uint16_t>(i)};
+    }
+}
+
+bool PointIndex::Resolve(const std::string& token, PointRef& ref, std::string& error) const
+{
+    auto colon = token.find(':');
+    if (colon == std::string::npos)
+    {
+        auto it = names.find(token);
+        if (it == names.end())
+        {
+            error = "no point " + token;
+            return false;
+        }
+        ref = it->second;
+        return true;
+    }
+
+    ref.type = PointTypeSpec::from_string(token.substr(0, colon));
+    size_t index = 0;
+    if ((ref.type == PointType::UNDEFINED) || (ref.type == PointType::BINARY_OUTPUT)
+        || (ref.type == PointType::ANALOG_OUTPUT) || !parseIndex(token.substr(colon + 1), index))
+    {
+        error = "bad point " + token;
+        return false;
+    }
+
+    size_t count = 0;
+    switch (ref.type)
+    {
+    case PointType::BINARY_INPUT:
+        count = table->GetBinaryInputs().size();
+        break;
+    case PointType::DOUBLE_BIT_INPUT:
+        count = table->GetDoubleBitInputs().size();
+        break;
+    default:
+        count = table->GetAnalogInputs().size();
+        break;
+    }
+    if (index >= count)
+    {
+        error = "no point " + token;
+        return false;
+    }
+    ref.index = static_cast<uint16_t>(index);
+    return true;
+}
+
+bool PointIndex::Write(const PointRef& ref,
+                       const std::string& value,
+                       opendnp3::UpdateBuilder& builder,
+                       std::string& error)
+{
+    switch (ref.type)
+    {
+    case PointType::BINARY_INPUT:
+    {
+        bool v = false;
+        if (!parseBool(value, v))
+        {
+            error = "bad binary value " + value;
+            return false;
+        }
+        table->GetBinaryInputs()[ref.index]->Write(v, builder);
+        return true;
+    }
+    case PointType::DOUBLE_BIT_INPUT:
+    {
+        auto v = opendnp3::DoubleBit::INDETERMINATE;
+        if (!parseDoubleBit(value, v))
+        {
+            error = "bad double-bit value " + value;
+            return false;
+        }
+        table->GetDoubleBitInputs()[ref.index]->Write(v, builder);
+        return true;
+    }
+    case PointType::ANALOG_INPUT:
+    {
+        double v = 0.0;
+        if (!parseDouble(value, v))
+        {
+            error = "bad analog value " + value;
+            return false;
+        }
+        Write(ref, v, builder);
+        return true;
+    }
+    default:
+        error = "bad point type";
+        return false;
+    }
+}
+
+void PointIndex::Write(const PointRef& ref, double value, opendnp3::UpdateBuilder& builder)
+{
+    switch (ref.type)
+    {
+    case PointType::BINARY_INPUT:
+        table->GetBinaryInputs()[ref.index]->Write(value != 0.0, builder);
+        break;
+    case PointType::DOUBLE_BIT_INPUT:
+        table->GetDoubleBitInputs()[ref.index]->Write(opendnp3::DoubleBitSpec::from_type(static_cast<uint8_t>(value)),
+                                                       builder);
+        break;
+    case PointType::ANALOG_INPUT:
+    {
+        const auto& point = table->GetAnalogInputs()[ref.index];
+        auto slot = table->GetWaveforms()->Find(point.get());
+        if (slot.has_value())
+        {
+            table->GetWaveforms()->Pin(slot.value(), value);
+        }
+        point->Write(value, builder);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+double PointIndex::Read(const PointRef& ref) const
+{
+    switch (ref.type)
+    {
+    case PointType::BINARY_INPUT:
+        return table->GetBinaryInputs()[ref.index]->Read() ? 1.0 : 0.0;
+    case PointType::DOUBLE_BIT_INPUT:
+        return opendnp3::DoubleBitSpec::to_type(table->GetDoubleBitInputs()[ref.index]->Read());
+    case PointType::ANALOG_INPUT:
+        return table->GetAnalogInputs()[ref.index]->Read();
+    default:
+        return 0.0;
+    }
+}
+
+std::shared_ptr<IOTable> PointIndex::GetIOTable() const
+{
+    return table;
+}
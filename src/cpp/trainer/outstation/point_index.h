@@ -0,0 +1,66 @@
+#ifndef CALDERADNP3_OUTSTATION_POINT_INDEX_H
+#define CALDERADNP3_OUTSTATION_POINT_INDEX_H
+
+#include "outstation/io_table.h"
+
+#include <opendnp3/outstation/UpdateBuilder.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+enum class PointType : uint8_t
+{
+    BINARY_INPUT = 0,
+    DOUBLE_BIT_INPUT = 1,
+    ANALOG_INPUT = 2,
+    BINARY_OUTPUT = 3,
+    ANALOG_OUTPUT = 4,
+    UNDEFINED = 127
+};
+
+struct PointTypeSpec
+{
+    using enum_type_t = PointType;
+
+    // Short forms used in point references: bi, dbi, ai, bo, ao
+    static char const* to_string(PointType arg);
+    static char const* to_human_string(PointType arg);
+    static PointType from_string(const std::string& arg);
+};
+
+struct PointRef
+{
+    PointType type = PointType::UNDEFINED;
+    uint16_t index = 0;
+};
+
+/**
+ * PointIndex gives external sources access to the input points of an IOTable.
+ *
+ * A point is referenced by type and index (ai:3, bi:0, dbi:1) or by its
+ * name (Voltage_status). Output references (bo, ao) are not resolved. Values are written into a caller's batch; writing
+ * a generated analog pins it in the waveform generator, so the value is not
+ * overwritten on the next tick.
+ */
+class PointIndex
+{
+private:
+    std::shared_ptr<IOTable> table;
+    std::unordered_map<std::string, PointRef> names;
+
+public:
+    explicit PointIndex(std::shared_ptr<IOTable> table);
+
+    bool Resolve(const std::string& token, PointRef& ref, std::string& error) const;
+
+    // Text values: 0/1, true/false or on/off for binaries, 0-3 or a state name for double-bits
+    bool Write(const PointRef& ref, const std::string& value, opendnp3::UpdateBuilder& builder, std::string& error);
+    void Write(const PointRef& ref, double value, opendnp3::UpdateBuilder& builder);
+    double Read(const PointRef& ref) const;
+
+    std::shared_ptr<IOTable> GetIOTable() const;
+};
+
+#endif // CALDERADNP3_OUTSTATION_POINT_INDEX_H
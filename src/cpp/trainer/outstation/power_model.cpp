@@ -0,0 +1,320 @@
+#include "outstation/power_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+// Changes smaller than this do not propagate
+constexpr double EPSILON = 1e-9;
+} // namespace
+
+// PowerNodeTypeSpec
+
+char const* PowerNodeTypeSpec::to_string(PowerNodeType arg)
+{
+    switch (arg)
+    {
+    case PowerNodeType::INPUT:
+        return "INPUT";
+    case PowerNodeType::SERIES:
+        return "SERIES";
+    case PowerNodeType::PARALLEL:
+        return "PARALLEL";
+    case PowerNodeType::SUM:
+        return "SUM";
+    default:
+        return "UNDEFINED";
+    }
+}
+
+char const* PowerNodeTypeSpec::to_human_string(PowerNodeType arg)
+{
+    switch (arg)
+    {
+    case PowerNodeType::INPUT:
+        return "Input";
+    case PowerNodeType::SERIES:
+        return "Series";
+    case PowerNodeType::PARALLEL:
+        return "Parallel";
+    case PowerNodeType::SUM:
+        return "Sum";
+    default:
+        return "Undefined";
+    }
+}
+
+PowerNodeType PowerNodeTypeSpec::from_string(const std::string& arg)
+{
+    if (arg == "INPUT")
+        return PowerNodeType::INPUT;
+    if (arg == "SERIES")
+        return PowerNodeType::SERIES;
+    if (arg == "PARALLEL")
+        return PowerNodeType::PARALLEL;
+    if (arg == "SUM")
+        return PowerNodeType::SUM;
+    return PowerNodeType::UNDEFINED;
+}
+
+// PowerModel
+
+std::shared_ptr<PowerModel> PowerModel::Create()
+{
+    return std::make_shared<PowerModel>();
+}
+
+PowerModel::NodeId PowerModel::AddInput(const std::string& name, double value)
+{
+    auto node = add(name, PowerNodeType::INPUT, {}, 1.0);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    nodes[node].value = value;
+    return node;
+}
+
+PowerModel::NodeId PowerModel::AddBreaker(std::shared_ptr<Breaker> breaker)
+{
+    auto node = AddInput(breaker->GetName(), breaker->IsClosed() ? 1.0 : 0.0);
+    breaker->SetStateListener(
+        [this, node](bool closed, opendnp3::UpdateBuilder& builder) { SetInput(node, closed ? 1.0 : 0.0, builder); });
+    return node;
+}
+
+PowerModel::NodeId PowerModel::AddSeries(const std::string& name, const std::vector<NodeId>& inputs, double gain)
+{
+    std::vector<std::pair<NodeId, double>> weighted;
+    for (auto input : inputs)
+    {
+        weighted.emplace_back(input, 1.0);
+    }
+    return add(name, PowerNodeType::SERIES, weighted, gain);
+}
+
+PowerModel::NodeId PowerModel::AddParallel(const std::string& name, const std::vector<NodeId>& inputs, double gain)
+{
+    std::vector<std::pair<NodeId, double>> weighted;
+    for (auto input : inputs)
+    {
+        weighted.emplace_back(input, 1.0);
+    }
+    return add(name, PowerNodeType::PARALLEL, weighted, gain);
+}
+
+PowerModel::NodeId PowerModel::AddSum(const std::string& name, const std::vector<std::pair<NodeId, double>>& inputs)
+{
+    return add(name, PowerNodeType::SUM, inputs, 1.0);
+}
+
+PowerModel::NodeId PowerModel::add(const std::string& name,
+                                   PowerNodeType type,
+                                   const std::vector<std::pair<NodeId, double>>& inputs,
+                                   double gain)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    NodeId id = nodes.size();
+
+    // Only existing nodes can be referenced, which keeps the graph acyclic
+    for (const auto& input : inputs)
+    {
+        if (input.first >= id)
+        {
+            throw std::out_of_range("power model node " + name + " references an unknown node");
+        }
+    }
+
+    Node node;
+    node.name = name;
+    node.type = type;
+    node.inputs = inputs;
+    node.gain = gain;
+    nodes.push_back(std::move(node));
+
+    for (const auto& input : inputs)
+    {
+        nodes[input.first].outputs.push_back(id);
+    }
+    nodes[id].value = evaluate(nodes[id]);
+
+    return id;
+}
+
+void PowerModel::BindAnalog(NodeId node, std::shared_ptr<Analog> point, double scale)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (node >= nodes.size())
+    {
+        return;
+    }
+    point->Write(nodes[node].value * scale);
+    nodes[node].analogs.push_back({std::move(point), scale});
+}
+
+void PowerModel::BindSetpoint(NodeId node, std::shared_ptr<SetpointController> controller)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (node >= nodes.size())
+    {
+        return;
+    }
+    controller->SetGain(nodes[node].value);
+    nodes[node].setpoints.push_back(std::move(controller));
+}
+
+void PowerModel::SetApplyFunction(ApplyFunction applyFunction)
+{
+    apply = std::move(applyFunction);
+}
+
+void PowerModel::SetBatchListener(std::function<void()> listener)
+{
+    batchListener = std::move(listener);
+}
+
+void PowerModel::SetInput(NodeId node, double value)
+{
+    auto builder = opendnp3::UpdateBuilder();
+    SetInput(node, value, builder);
+    if (apply)
+    {
+        apply(builder.Build());
+    }
+}
+
+void PowerModel::SetInput(NodeId node, double value, opendnp3::UpdateBuilder& builder)
+{
+    size_t recomputed = 0;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if ((node >= nodes.size()) || (nodes[node].type != PowerNodeType::INPUT))
+        {
+            return;
+        }
+        if (std::fabs(nodes[node].value - value) < EPSILON)
+        {
+            lastRecomputed = 0;
+            return;
+        }
+
+        nodes[node].value = value;
+        publish(nodes[node], builder);
+        for (auto output : nodes[node].outputs)
+        {
+            if (!nodes[output].queued)
+            {
+                nodes[output].queued = true;
+                dirty.push(output);
+            }
+        }
+
+        // Ids are a topological order, so each node is recomputed once, after all of its dirty inputs
+        while (!dirty.empty())
+        {
+            auto& current = nodes[dirty.top()];
+            dirty.pop();
+            current.queued = false;
+            ++recomputed;
+
+            double updated = evaluate(current);
+            if (std::fabs(current.value - updated) < EPSILON)
+            {
+                continue;
+            }
+
+            current.value = updated;
+            publish(current, builder);
+            for (auto output : current.outputs)
+            {
+                if (!nodes[output].queued)
+                {
+                    nodes[output].queued = true;
+                    dirty.push(output);
+                }
+            }
+        }
+        lastRecomputed = recomputed;
+    }
+
+    if (batchListener)
+    {
+        batchListener();
+    }
+}
+
+double PowerModel::evaluate(const Node& node) const
+{
+    switch (node.type)
+    {
+    case PowerNodeType::SERIES:
+    {
+        double value = node.gain;
+        for (const auto& input : node.inputs)
+        {
+            value *= nodes[input.first].value;
+        }
+        return value;
+    }
+    case PowerNodeType::PARALLEL:
+    {
+        double value = 0.0;
+        for (const auto& input : node.inputs)
+        {
+            value = std::max(value, nodes[input.first].value);
+        }
+        return value * node.gain;
+    }
+    case PowerNodeType::SUM:
+    {
+        double value = 0.0;
+        for (const auto& input : node.inputs)
+        {
+            value += nodes[input.first].value * input.second;
+        }
+        return value * node.gain;
+    }
+    default:
+        return node.value;
+    }
+}
+
+void PowerModel::publish(const Node& node, opendnp3::UpdateBuilder& builder)
+{
+    for (const auto& binding : node.analogs)
+    {
+        binding.point->Write(node.value * binding.scale, builder);
+    }
+    for (const auto& controller : node.setpoints)
+    {
+        controller->SetGain(node.value, builder);
+    }
+}
+
+double PowerModel::Value(NodeId node)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (node >= nodes.size())
+    {
+        return 0.0;
+    }
+    return nodes[node].value;
+}
+
+const std::string& PowerModel::GetName(NodeId node)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return nodes.at(node).name;
+}
+
+size_t PowerModel::Size()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return nodes.size();
+}
+
+size_t PowerModel::LastRecomputed()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return lastRecomputed;
+}
@@ -0,0 +1,119 @@
+#ifndef CALDERADNP3_OUTSTATION_POWER_MODEL_H
+#define CALDERADNP3_OUTSTATION_POWER_MODEL_H
+
+#include "outstation/devices.h"
+#include "outstation/types.h"
+
+#include <opendnp3/outstation/UpdateBuilder.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class PowerNodeType : uint8_t
+{
+    INPUT = 0,
+    SERIES = 1,
+    PARALLEL = 2,
+    SUM = 3,
+    UNDEFINED = 127
+};
+
+struct PowerNodeTypeSpec
+{
+    using enum_type_t = PowerNodeType;
+
+    static char const* to_string(PowerNodeType arg);
+    static char const* to_human_string(PowerNodeType arg);
+    static PowerNodeType from_string(const std::string& arg);
+};
+
+/**
+ * PowerModel is a dependency graph between devices and the analogs they affect.
+ *
+ * INPUT nodes are set externally, typically by a breaker (1 when closed,
+ * 0 when tripped). SERIES nodes are the product of their inputs (energized
+ * only when every upstream element is), PARALLEL nodes the largest input
+ * (energized by any path) and SUM nodes a weighted sum, e.g. the power flow
+ * through a bus. Each node's value is multiplied by its gain.
+ *
+ * A node can only depend on nodes created before it, so creation order is
+ * a topological order and the graph is acyclic. When an input changes, only
+ * its downstream nodes are visited, in creation order, and a node whose
+ * value does not change stops the propagation. Bound points, including the
+ * status of bound setpoint controllers at their new gain, are written into
+ * the batch of the change that caused them.
+ */
+class PowerModel
+{
+public:
+    using NodeId = size_t;
+    using ApplyFunction = std::function<void(const opendnp3::Updates&)>;
+
+    PowerModel() = default;
+    static std::shared_ptr<PowerModel> Create();
+
+    NodeId AddInput(const std::string& name, double value);
+    NodeId AddBreaker(std::shared_ptr<Breaker> breaker);
+    NodeId AddSeries(const std::string& name, const std::vector<NodeId>& inputs, double gain = 1.0);
+    NodeId AddParallel(const std::string& name, const std::vector<NodeId>& inputs, double gain = 1.0);
+    NodeId AddSum(const std::string& name, const std::vector<std::pair<NodeId, double>>& inputs);
+
+    // Bound points follow the node value, multiplied by scale
+    void BindAnalog(NodeId node, std::shared_ptr<Analog> point, double scale);
+    void BindSetpoint(NodeId node, std::shared_ptr<SetpointController> controller);
+
+    void SetApplyFunction(ApplyFunction applyFunction);
+    void SetBatchListener(std::function<void()> listener);
+
+    void SetInput(NodeId node, double value);
+    void SetInput(NodeId node, double value, opendnp3::UpdateBuilder& builder);
+
+    double Value(NodeId node);
+    const std::string& GetName(NodeId node);
+    size_t Size();
+    size_t LastRecomputed();
+
+private:
+    struct AnalogBinding
+    {
+        std::shared_ptr<Analog> point;
+        double scale;
+    };
+
+    struct Node
+    {
+        std::string name;
+        PowerNodeType type;
+        std::vector<std::pair<NodeId, double>> inputs;
+        std::vector<NodeId> outputs;
+        double gain = 1.0;
+        double value = 0.0;
+        bool queued = false;
+
+        std::vector<AnalogBinding> analogs;
+        std::vector<std::shared_ptr<SetpointController>> setpoints;
+    };
+
+    std::mutex mtx;
+    std::vector<Node> nodes;
+    std::priority_queue<NodeId, std::vector<NodeId>, std::greater<NodeId>> dirty;
+    size_t lastRecomputed = 0;
+
+    ApplyFunction apply;
+    std::function<void()> batchListener;
+
+    NodeId add(const std::string& name,
+               PowerNodeType type,
+               const std::vector<std::pair<NodeId, double>>& inputs,
+               double gain);
+    double evaluate(const Node& node) const;
+    void publish(const Node& node, opendnp3::UpdateBuilder& builder);
+};
+
+#endif // CALDERADNP3_OUTSTATION_POWER_MODEL_H
@@ -0,0 +1,214 @@
+#include "outstation/profile.h"
+
+#include <cmath>
+#include <string>
+#include <utility>
+
+Profile::Profile(std::shared_ptr<Scheduler> scheduler) : table(IOTable::Create(std::move(scheduler))) {}
+
+std::vector<DeviceSpec> Profile::DefaultDevices()
+{
+    std::vector<DeviceSpec> layout;
+
+    auto setpoint = [&layout](const std::string& name, double value, double variance, bool readOnly) {
+        DeviceSpec spec;
+        spec.kind = DeviceSpec::Kind::SETPOINT;
+        spec.name = name;
+        spec.setpoint = value;
+        spec.variance = variance;
+        spec.readOnly = readOnly;
+        layout.push_back(spec);
+    };
+    setpoint("Temperature", 62, 0.5, true);
+    setpoint("Voltage", 480, 0.4, false);
+    setpoint("Frequency", 60, 0.2, false);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        DeviceSpec spec;
+        spec.kind = DeviceSpec::Kind::SIMPLE;
+        spec.name = "Device " + std::to_string(i);
+        layout.push_back(spec);
+    }
+
+    for (int i = 0; i < 10; ++i)
+    {
+        DeviceSpec spec;
+        spec.kind = DeviceSpec::Kind::BREAKER;
+        spec.name = "Breaker " + std::to_string(i);
+        spec.model = (i < 5) ? TwoSignalControlModel::COMPLEMENTARY_TWO_OUTPUT : TwoSignalControlModel::ACTIVATION;
+        layout.push_back(spec);
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        DeviceSpec spec;
+        spec.kind = DeviceSpec::Kind::SWITCH;
+        spec.name = "Switch " + std::to_string(i);
+        spec.runtimeMs = 10000;
+        layout.push_back(spec);
+    }
+
+    return layout;
+}
+
+std::shared_ptr<Profile> Profile::Create(std::shared_ptr<Scheduler> scheduler,
+                                         const ProfileOptions& options,
+                                         const std::vector<DeviceSpec>& layout)
+{
+    auto profile = std::make_shared<Profile>(std::move(scheduler));
+    auto& table = profile->table;
+    auto& devices = profile->devices;
+
+    table->GetWaveforms()->SetInterval(options.analogInterval);
+    if (options.seed.has_value())
+    {
+        table->GetWaveforms()->SetSeed(options.seed.value());
+    }
+
+    std::shared_ptr<SetpointController> voltage;
+    std::shared_ptr<SetpointController> freq;
+    std::vector<std::shared_ptr<Breaker>> breakers;
+    for (const auto& spec : layout)
+    {
+        switch (spec.kind)
+        {
+        case DeviceSpec::Kind::SIMPLE:
+            devices.push_back(table->CreateSimpleDevice(spec.name));
+            break;
+        case DeviceSpec::Kind::BREAKER:
+        {
+            auto device = table->CreateBreaker(spec.name, spec.model);
+            devices.push_back(device);
+            breakers.push_back(device);
+            break;
+        }
+        case DeviceSpec::Kind::SWITCH:
+            devices.push_back(table->CreateSlowDevice(spec.name, spec.runtimeMs, spec.model));
+            break;
+        case DeviceSpec::Kind::SETPOINT:
+        {
+            auto device = table->CreateSetpointController(spec.name, spec.setpoint, spec.variance, spec.readOnly);
+            if (spec.waveform.has_value())
+            {
+                device->SetWaveform(spec.waveform.value());
+            }
+            devices.push_back(device);
+            if (spec.name == "Voltage")
+            {
+                voltage = device;
+            }
+            else if (spec.name == "Frequency")
+            {
+                freq = device;
+            }
+            break;
+        }
+        }
+    }
+
+    // The power model is wired to the bus setpoints and first five breakers of the layout
+    if (options.powerModel && voltage && freq && (breakers.size() >= 5))
+    {
+        profile->buildPowerModel(voltage, freq, breakers);
+    }
+
+    return profile;
+}
+
+void Profile::buildPowerModel(std::shared_ptr<SetpointController> voltage,
+                              std::shared_ptr<SetpointController> freq,
+                              const std::vector<std::shared_ptr<Breaker>>& breakers)
+{
+    // Breaker 0 feeds the bus, Breakers 1-4 each feed a 120 A load from the bus
+    const double feederAmps = 120.0;
+    const double feederKw = std::sqrt(3.0) * 480.0 * feederAmps / 1000.0;
+
+    auto power = table->GetPowerModel();
+    for (int i = 0; i < 5; ++i)
+    {
+        breakers[i]->Close();
+    }
+
+    auto bus = power->AddSeries("Bus", {power->AddBreaker(breakers[0])});
+    power->BindSetpoint(bus, voltage);
+    power->BindSetpoint(bus, freq);
+
+    std::vector<std::pair<PowerModel::NodeId, double>> loads;
+    for (int i = 1; i < 5; ++i)
+    {
+        auto name = "Feeder " + std::to_string(i);
+        auto feeder = power->AddSeries(name, {bus, power->AddBreaker(breakers[i])});
+        power->BindAnalog(feeder, table->CreateAnalogInput(name + " Current", 1.0), feederAmps);
+        loads.emplace_back(feeder, feederKw);
+    }
+
+    auto flow = power->AddSum("Bus Power", loads);
+    power->BindAnalog(flow, table->CreateAnalogInput("Bus Power", 1.0), 1.0);
+}
+
+std::shared_ptr<IOTable> Profile::GetIOTable() const
+{
+    return table;
+}
+
+const std::vector<std::shared_ptr<IDevice>>& Profile::GetDevices() const
+{
+    return devices;
+}
+
+// ProfileTemplate
+
+ProfileTemplate::ProfileTemplate(const ProfileOptions& options) : options(options) {}
+
+std::shared_ptr<const ProfileTemplate> ProfileTemplate::Create(std::shared_ptr<Scheduler> scheduler,
+                                                               const ProfileOptions& options)
+{
+    auto profileTemplate = std::make_shared<ProfileTemplate>(options);
+    profileTemplate->devices = Profile::DefaultDevices();
+
+    // The prototype is never attached to an outstation; its points are captured as the shared layout
+    auto prototype = Profile::Create(std::move(scheduler), options, profileTemplate->devices);
+    auto table = prototype->GetIOTable();
+    profileTemplate->layout = table->CaptureLayout();
+    profileTemplate->database = table->ConfigureDatabase();
+
+    return profileTemplate;
+}
+
+std::shared_ptr<Profile> ProfileTemplate::Instantiate(std::shared_ptr<Scheduler> scheduler,
+                                                      std::optional<uint64_t> seed) const
+{
+    auto instanceOptions = options;
+    instanceOptions.seed = seed;
+    auto profile = Profile::Create(std::move(scheduler), instanceOptions, devices);
+
+    // The points were built with specs of their own, which are released for the shared ones
+    profile->GetIOTable()->ShareLayout(layout);
+    return profile;
+}
+
+const ProfileOptions& ProfileTemplate::GetOptions() const
+{
+    return options;
+}
+
+const std::vector<DeviceSpec>& ProfileTemplate::GetDevices() const
+{
+    return devices;
+}
+
+const PointLayout& ProfileTemplate::GetLayout() const
+{
+    return *layout;
+}
+
+const opendnp3::DatabaseConfig& ProfileTemplate::GetDatabaseConfig() const
+{
+    return database;
+}
+
+size_t ProfileTemplate::NumPoints() const
+{
+    return layout->NumPoints();
+}
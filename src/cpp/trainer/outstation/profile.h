@@ -0,0 +1,112 @@
+#ifndef CALDERADNP3_OUTSTATION_PROFILE_H
+#define CALDERADNP3_OUTSTATION_PROFILE_H
+
+#include "outstation/devices.h"
+#include "outstation/io_table.h"
+#include "outstation/scheduler.h"
+#include "outstation/waveform.h"
+
+#include <opendnp3/outstation/DatabaseConfig.h>
+#include <opendnp3/outstation/EventBufferConfig.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct ProfileOptions
+{
+    bool powerModel = false;
+    std::chrono::milliseconds analogInterval{1000};
+    std::optional<uint64_t> seed = std::nullopt;
+    opendnp3::EventBufferConfig eventBuffers = opendnp3::EventBufferConfig::AllTypes(10);
+};
+
+/**
+ * DeviceSpec describes one device of a profile; fields not used by its kind
+ * are ignored.
+ */
+struct DeviceSpec
+{
+    enum class Kind : uint8_t
+    {
+        SIMPLE = 0,
+        BREAKER = 1,
+        SWITCH = 2,
+        SETPOINT = 3
+    };
+
+    Kind kind = Kind::SIMPLE;
+    std::string name;
+    TwoSignalControlModel model = TwoSignalControlModel::ACTIVATION; // of breakers and switches
+    uint32_t runtimeMs = 0;                                          // of switches
+    double setpoint = 0.0;                                           // of setpoint controllers
+    double variance = 0.0;
+    bool readOnly = false;
+    std::optional<Waveform> waveform = std::nullopt; // around the setpoint, instead of the variance noise
+};
+
+/**
+ * Profile is the device set served by one outstation.
+ *
+ * Each Profile owns its IOTable and devices, so several outstations can be
+ * hosted in one process without sharing any point state. All profiles may
+ * share a single Scheduler.
+ */
+class Profile
+{
+private:
+    std::shared_ptr<IOTable> table;
+    std::vector<std::shared_ptr<IDevice>> devices;
+
+    void buildPowerModel(std::shared_ptr<SetpointController> voltage,
+                         std::shared_ptr<SetpointController> freq,
+                         const std::vector<std::shared_ptr<Breaker>>& breakers);
+
+public:
+    explicit Profile(std::shared_ptr<Scheduler> scheduler);
+
+    // The devices of the training outstation
+    static std::vector<DeviceSpec> DefaultDevices();
+    static std::shared_ptr<Profile> Create(std::shared_ptr<Scheduler> scheduler,
+                                           const ProfileOptions& options,
+                                           const std::vector<DeviceSpec>& layout = DefaultDevices());
+
+    std::shared_ptr<IOTable> GetIOTable() const;
+    const std::vector<std::shared_ptr<IDevice>>& GetDevices() const;
+};
+
+/**
+ * ProfileTemplate holds what is identical across every instance of a Profile.
+ *
+ * The device layout, the point specs (names, classes, variations and
+ * deadbands) and the DatabaseConfig are built once from a prototype and
+ * shared by all instances. An instance builds its own devices, which carry
+ * their state and control callbacks, and its points then describe
+ * themselves by the template's specs, keeping only their values and flags.
+ */
+class ProfileTemplate
+{
+private:
+    ProfileOptions options;
+    std::vector<DeviceSpec> devices;
+    std::shared_ptr<const PointLayout> layout;
+    opendnp3::DatabaseConfig database;
+
+public:
+    explicit ProfileTemplate(const ProfileOptions& options);
+    static std::shared_ptr<const ProfileTemplate> Create(std::shared_ptr<Scheduler> scheduler,
+                                                         const ProfileOptions& options);
+
+    std::shared_ptr<Profile> Instantiate(std::shared_ptr<Scheduler> scheduler,
+                                         std::optional<uint64_t> seed = std::nullopt) const;
+    const ProfileOptions& GetOptions() const;
+    const std::vector<DeviceSpec>& GetDevices() const;
+    const PointLayout& GetLayout() const;
+    const opendnp3::DatabaseConfig& GetDatabaseConfig() const;
+    size_t NumPoints() const;
+};
+
+#endif // CALDERADNP3_OUTSTATION_PROFILE_H
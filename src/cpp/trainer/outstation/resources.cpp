@@ -0,0 +1,64 @@
+#include "outstation/resources.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// ResourceUsage
+
+ResourceUsage ResourceUsage::Read()
+{
+    ResourceUsage usage;
+
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key == "VmRSS:")
+        {
+            fields >> usage.rssKb;
+        }
+        else if (key == "Threads:")
+        {
+            fields >> usage.threads;
+        }
+    }
+
+    return usage;
+}
+
+ResourceUsage ResourceUsage::operator-(const ResourceUsage& other) const
+{
+    ResourceUsage diff;
+    diff.rssKb = (rssKb > other.rssKb) ? rssKb - other.rssKb : 0;
+    diff.threads = (threads > other.threads) ? threads - other.threads : 0;
+    return diff;
+}
+
+size_t NumCpus()
+{
+    auto cpus = std::thread::hardware_concurrency();
+    return (cpus > 0) ? cpus : 1;
+}
+
+bool PinCurrentThread(size_t cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % NumCpus(), &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
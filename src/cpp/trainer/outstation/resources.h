@@ -0,0 +1,28 @@
+#ifndef CALDERADNP3_OUTSTATION_RESOURCES_H
+#define CALDERADNP3_OUTSTATION_RESOURCES_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * ResourceUsage is a snapshot of the memory and threads used by this process.
+ *
+ * Values are read from /proc/self/status and are zero on platforms
+ * without it. Taking a snapshot before and after creating an outstation
+ * gives the cost of that outstation.
+ */
+struct ResourceUsage
+{
+    size_t rssKb = 0;
+    size_t threads = 0;
+
+    static ResourceUsage Read();
+    ResourceUsage operator-(const ResourceUsage& other) const;
+};
+
+size_t NumCpus();
+
+// Pins the calling thread to one CPU. Returns false where pinning is not supported.
+bool PinCurrentThread(size_t cpu);
+
+#endif // CALDERADNP3_OUTSTATION_RESOURCES_H
@@ -0,0 +1,237 @@
+#include "outstation/scheduler.h"
+
+Scheduler::Scheduler(size_t numThreads, std::shared_ptr<SimClock> clock) : clock(std::move(clock))
+{
+    if (numThreads == 0)
+    {
+        numThreads = 1;
+    }
+
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        workers.emplace_back([this]() { run(); });
+    }
+}
+
+Scheduler::~Scheduler()
+{
+    Shutdown();
+}
+
+std::shared_ptr<Scheduler> Scheduler::Create(size_t numThreads, std::shared_ptr<SimClock> clock)
+{
+    return std::make_shared<Scheduler>(numThreads, std::move(clock));
+}
+
+Scheduler::Clock::time_point Scheduler::Now() const
+{
+    return clock->Now();
+}
+
+std::shared_ptr<SimClock> Scheduler::GetClock() const
+{
+    return clock;
+}
+
+Scheduler::TaskId Scheduler::ScheduleAt(Clock::time_point when, Task task)
+{
+    if (!task)
+    {
+        return INVALID_TASK;
+    }
+    return add(when, Clock::duration::zero(), [task = std::move(task)]() {
+        task();
+        return false;
+    });
+}
+
+Scheduler::TaskId Scheduler::ScheduleAfter(Clock::duration delay, Task task)
+{
+    return ScheduleAt(clock->Now() + delay, std::move(task));
+}
+
+Scheduler::TaskId Scheduler::SchedulePeriodic(Clock::duration period, Task task)
+{
+    return SchedulePeriodic(period, Clock::duration::zero(), std::move(task));
+}
+
+Scheduler::TaskId Scheduler::SchedulePeriodic(Clock::duration period, Clock::duration firstDelay, Task task)
+{
+    if (!task)
+    {
+        return INVALID_TASK;
+    }
+    return ScheduleRepeating(period, firstDelay, [task = std::move(task)]() {
+        task();
+        return true;
+    });
+}
+
+Scheduler::TaskId Scheduler::ScheduleRepeating(Clock::duration period, Clock::duration firstDelay, RepeatingTask task)
+{
+    if (period <= Clock::duration::zero())
+    {
+        return INVALID_TASK;
+    }
+    return add(clock->Now() + firstDelay, period, std::move(task));
+}
+
+Scheduler::TaskId Scheduler::add(Clock::time_point due, Clock::duration period, RepeatingTask task)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    if (stopping || !task)
+    {
+        return INVALID_TASK;
+    }
+
+    TaskId id = nextId++;
+    TaskState state;
+    state.task = std::make_shared<RepeatingTask>(std::move(task));
+    state.period = period;
+    tasks.emplace(id, std::move(state));
+
+    bool earliest = queue.empty() || (due < queue.top().due);
+    queue.push({due, id});
+    lock.unlock();
+
+    if (earliest)
+    {
+        wakeup.notify_one();
+    }
+    return id;
+}
+
+void Scheduler::Cancel(TaskId id)
+{
+    if (id == INVALID_TASK)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mtx);
+    auto it = tasks.find(id);
+    if (it == tasks.end())
+    {
+        return;
+    }
+
+    // A task may cancel itself; only wait when another worker is running it.
+    if (it->second.running && (it->second.runner != std::this_thread::get_id()))
+    {
+        finished.wait(lock, [this, id]() {
+            auto current = tasks.find(id);
+            return (current == tasks.end()) || !current->second.running;
+        });
+    }
+
+    // The heap entry is left in place and discarded when it reaches the top.
+    tasks.erase(id);
+}
+
+void Scheduler::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stopping)
+        {
+            return;
+        }
+        stopping = true;
+    }
+    wakeup.notify_all();
+
+    for (auto& worker : workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    tasks.clear();
+    queue = {};
+}
+
+size_t Scheduler::NumThreads() const
+{
+    return workers.size();
+}
+
+size_t Scheduler::NumTasks()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return tasks.size();
+}
+
+bool Scheduler::IsScheduled(TaskId id)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return tasks.find(id) != tasks.end();
+}
+
+void Scheduler::run()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!stopping)
+    {
+        if (queue.empty())
+        {
+            wakeup.wait(lock);
+            continue;
+        }
+
+        Entry next = queue.top();
+        auto it = tasks.find(next.id);
+        if (it == tasks.end())
+        {
+            queue.pop();
+            continue;
+        }
+
+        if (clock->Now() < next.due)
+        {
+            if (clock->GetMode() != ClockMode::FREE_RUN)
+            {
+                wakeup.wait_until(lock, clock->ToWall(next.due));
+                continue;
+            }
+            clock->AdvanceTo(next.due);
+        }
+        queue.pop();
+
+        TaskState& state = it->second;
+        state.running = true;
+        state.runner = std::this_thread::get_id();
+        auto task = state.task;
+
+        lock.unlock();
+        bool repeat = (*task)();
+        lock.lock();
+
+        // The task may have cancelled itself, invalidating the iterator.
+        it = tasks.find(next.id);
+        if (it != tasks.end())
+        {
+            it->second.running = false;
+            if (repeat && (it->second.period > Clock::duration::zero()))
+            {
+                // Fixed-rate rescheduling; ticks that were missed entirely are skipped.
+                auto period = it->second.period;
+                auto due = next.due + period;
+                auto now = clock->Now();
+                if (due <= now)
+                {
+                    due += period * ((now - due) / period + 1);
+                }
+                queue.push({due, next.id});
+                wakeup.notify_one();
+            }
+            else
+            {
+                tasks.erase(it);
+            }
+        }
+        finished.notify_all();
+    }
+}
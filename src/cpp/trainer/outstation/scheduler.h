@@ -0,0 +1,98 @@
+#ifndef CALDERADNP3_OUTSTATION_SCHEDULER_H
+#define CALDERADNP3_OUTSTATION_SCHEDULER_H
+
+#include "outstation/sim_clock.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Scheduler runs timed simulation work on a fixed pool of worker threads.
+ *
+ * Devices register one-shot or periodic tasks instead of owning a thread,
+ * so the number of threads stays constant regardless of the number of
+ * devices. Pending deadlines are kept in a min-heap and workers sleep until
+ * the earliest one is due. A task is never run concurrently with itself,
+ * and Cancel() waits for a running task to return before it completes, so
+ * a device may safely cancel its tasks from its destructor.
+ *
+ * Deadlines are expressed in simulation time read from a SimClock, which
+ * may run faster than the wall clock or jump straight to the next deadline.
+ */
+class Scheduler
+{
+public:
+    using Clock = SimClock;
+    using TaskId = uint64_t;
+    using Task = std::function<void()>;
+    using RepeatingTask = std::function<bool()>; // return false to stop repeating
+
+    static constexpr TaskId INVALID_TASK = 0;
+
+    explicit Scheduler(size_t numThreads, std::shared_ptr<SimClock> clock);
+    ~Scheduler();
+    static std::shared_ptr<Scheduler> Create(size_t numThreads = 1,
+                                             std::shared_ptr<SimClock> clock = SimClock::Default());
+
+    Clock::time_point Now() const;
+    std::shared_ptr<SimClock> GetClock() const;
+
+    TaskId ScheduleAt(Clock::time_point when, Task task);
+    TaskId ScheduleAfter(Clock::duration delay, Task task);
+    TaskId SchedulePeriodic(Clock::duration period, Task task);
+    TaskId SchedulePeriodic(Clock::duration period, Clock::duration firstDelay, Task task);
+    TaskId ScheduleRepeating(Clock::duration period, Clock::duration firstDelay, RepeatingTask task);
+    void Cancel(TaskId id);
+    void Shutdown();
+
+    // False once a task has run for the last time or was cancelled
+    bool IsScheduled(TaskId id);
+
+    size_t NumThreads() const;
+    size_t NumTasks();
+
+private:
+    struct Entry
+    {
+        Clock::time_point due;
+        TaskId id;
+
+        bool operator>(const Entry& other) const
+        {
+            return due > other.due;
+        }
+    };
+
+    struct TaskState
+    {
+        std::shared_ptr<RepeatingTask> task;
+        Clock::duration period;
+        std::thread::id runner;
+        bool running = false;
+    };
+
+    std::shared_ptr<SimClock> clock;
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    std::unordered_map<TaskId, TaskState> tasks;
+    TaskId nextId = 1;
+    bool stopping = false;
+
+    std::mutex mtx;
+    std::condition_variable wakeup;
+    std::condition_variable finished;
+    std::vector<std::thread> workers;
+
+    TaskId add(Clock::time_point due, Clock::duration period, RepeatingTask task);
+    void run();
+};
+
+#endif // CALDERADNP3_OUTSTATION_SCHEDULER_H
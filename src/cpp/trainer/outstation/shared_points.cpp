@@ -0,0 +1,452 @@
+#include "outstation/shared_points.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(SharedPointHeader) == 64, "the shared region header is part of its layout");
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free
+                  && std::atomic<double>::is_always_lock_free && std::atomic<uint8_t>::is_always_lock_free,
+              "a lock in the shared region would not be shared with the other process");
+
+namespace
+{
+size_t align8(size_t offset)
+{
+    return (offset + 7) & ~static_cast<size_t>(7);
+}
+
+size_t numWords(size_t numPoints)
+{
+    return (numPoints + 63) / 64;
+}
+
+inline unsigned lowestBit(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+    unsigned bit = 0;
+    while ((word & 1) == 0)
+    {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+std::runtime_error systemError(const std::string& what, const std::string& path)
+{
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+} // namespace
+
+// SharedPointRegion
+
+#ifdef _WIN32
+
+SharedPointRegion::~SharedPointRegion() {}
+
+std::shared_ptr<SharedPointRegion> SharedPointRegion::Create(const std::string&, size_t, size_t)
+{
+    throw std::runtime_error("shared point regions are not supported on this platform");
+}
+
+std::shared_ptr<SharedPointRegion> SharedPointRegion::Open(const std::string&)
+{
+    throw std::runtime_error("shared point regions are not supported on this platform");
+}
+
+#else
+
+SharedPointRegion::~SharedPointRegion()
+{
+    if (base)
+    {
+        munmap(base, size);
+    }
+}
+
+std::shared_ptr<SharedPointRegion> SharedPointRegion::Create(const std::string& path,
+                                                             size_t numAnalogs,
+                                                             size_t numBinaries)
+{
+    size_t analogOffset = sizeof(SharedPointHeader);
+    size_t binaryOffset = align8(analogOffset + numAnalogs * sizeof(double));
+    size_t analogDirtyOffset = align8(binaryOffset + numBinaries);
+    size_t binaryDirtyOffset = analogDirtyOffset + numWords(numAnalogs) * sizeof(uint64_t);
+    size_t size = binaryDirtyOffset + numWords(numBinaries) * sizeof(uint64_t);
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0)
+    {
+        throw systemError("cannot create", path);
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0)
+    {
+        auto error = systemError("cannot size", path);
+        close(fd);
+        throw error;
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        throw systemError("cannot map", path);
+    }
+
+    auto region = std::make_shared<SharedPointRegion>();
+    region->path = path;
+    region->base = base;
+    region->size = size;
+
+    // The file is zero filled, which is a valid state for every array
+    auto* header = new (base) SharedPointHeader();
+    header->numAnalogs = static_cast<uint32_t>(numAnalogs);
+    header->numBinaries = static_cast<uint32_t>(numBinaries);
+    header->headerSize = sizeof(SharedPointHeader);
+    header->analogOffset = analogOffset;
+    header->binaryOffset = binaryOffset;
+    header->analogDirtyOffset = analogDirtyOffset;
+    header->binaryDirtyOffset = binaryDirtyOffset;
+    header->version = SharedPointHeader::VERSION;
+    header->sequence.store(0);
+
+    // The magic is written last, so a reader never sees a half initialized header
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = SharedPointHeader::MAGIC;
+
+    region->bind();
+    return region;
+}
+
+std::shared_ptr<SharedPointRegion> SharedPointRegion::Open(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDWR);
+    if (fd < 0)
+    {
+        throw systemError("cannot open", path);
+    }
+    struct stat info
+    {
+    };
+    if ((fstat(fd, &info) < 0) || (static_cast<size_t>(info.st_size) < sizeof(SharedPointHeader)))
+    {
+        close(fd);
+        throw std::runtime_error(path + " is not a shared point region");
+    }
+
+    auto size = static_cast<size_t>(info.st_size);
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        throw systemError("cannot map", path);
+    }
+
+    auto region = std::make_shared<SharedPointRegion>();
+    region->path = path;
+    region->base = base;
+    region->size = size;
+
+    auto* header = static_cast<SharedPointHeader*>(base);
+    if ((header->magic != SharedPointHeader::MAGIC) || (header->version != SharedPointHeader::VERSION)
+        || (header->binaryDirtyOffset + numWords(header->numBinaries) * sizeof(uint64_t) > size))
+    {
+        throw std::runtime_error(path + " is not a compatible shared point region");
+    }
+
+    region->bind();
+    return region;
+}
+
+#endif
+
+void SharedPointRegion::bind()
+{
+    auto* bytes = static_cast<uint8_t*>(base);
+    header = static_cast<SharedPointHeader*>(base);
+    analogs = reinterpret_cast<std::atomic<double>*>(bytes + header->analogOffset);
+    binaries = reinterpret_cast<std::atomic<uint8_t>*>(bytes + header->binaryOffset);
+    analogDirty = reinterpret_cast<std::atomic<uint64_t>*>(bytes + header->analogDirtyOffset);
+    binaryDirty = reinterpret_cast<std::atomic<uint64_t>*>(bytes + header->binaryDirtyOffset);
+    numAnalogs = header->numAnalogs;
+    numBinaries = header->numBinaries;
+    taken.assign(numWords(numAnalogs) + numWords(numBinaries), 0);
+}
+
+size_t SharedPointRegion::NumAnalogs() const
+{
+    return numAnalogs;
+}
+
+size_t SharedPointRegion::NumBinaries() const
+{
+    return numBinaries;
+}
+
+void SharedPointRegion::BeginWrite()
+{
+    writeSequence = header->sequence.load(std::memory_order_relaxed) + 1;
+    header->sequence.store(writeSequence, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SharedPointRegion::WriteAnalog(size_t index, double value)
+{
+    if (index >= numAnalogs)
+    {
+        return;
+    }
+    // Release: a reader that takes the dirty bit also sees the value, even outside the seqlock
+    analogs[index].store(value, std::memory_order_relaxed);
+    analogDirty[index / 64].fetch_or(uint64_t(1) << (index % 64), std::memory_order_release);
+}
+
+void SharedPointRegion::WriteBinary(size_t index, bool value)
+{
+    if (index >= numBinaries)
+    {
+        return;
+    }
+    binaries[index].store(value ? 1 : 0, std::memory_order_relaxed);
+    binaryDirty[index / 64].fetch_or(uint64_t(1) << (index % 64), std::memory_order_release);
+}
+
+void SharedPointRegion::EndWrite()
+{
+    header->sequence.store(writeSequence + 1, std::memory_order_release);
+}
+
+void SharedPointRegion::StoreAnalog(size_t index, double value)
+{
+    if (index < numAnalogs)
+    {
+        analogs[index].store(value, std::memory_order_relaxed);
+    }
+}
+
+void SharedPointRegion::StoreBinary(size_t index, bool value)
+{
+    if (index < numBinaries)
+    {
+        binaries[index].store(value ? 1 : 0, std::memory_order_relaxed);
+    }
+}
+
+bool SharedPointRegion::Collect(Changes& changes)
+{
+    changes.analogs.clear();
+    changes.binaries.clear();
+
+    // An odd sequence means the writer is in the middle of an update
+    auto before = header->sequence.load(std::memory_order_acquire);
+    if ((before & 1) != 0)
+    {
+        return false;
+    }
+
+    scan(changes.analogs, changes.binaries);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->sequence.load(std::memory_order_relaxed) == before)
+    {
+        return true;
+    }
+
+    // The writer ran during the scan: hand the points back so they are read again on the next tick
+    size_t analogWords = numWords(numAnalogs);
+    size_t binaryWords = numWords(numBinaries);
+    for (size_t w = 0; w < analogWords; ++w)
+    {
+        if (taken[w] != 0)
+        {
+            analogDirty[w].fetch_or(taken[w], std::memory_order_relaxed);
+        }
+    }
+    for (size_t w = 0; w < binaryWords; ++w)
+    {
+        if (taken[analogWords + w] != 0)
+        {
+            binaryDirty[w].fetch_or(taken[analogWords + w], std::memory_order_relaxed);
+        }
+    }
+    changes.analogs.clear();
+    changes.binaries.clear();
+    return false;
+}
+
+void SharedPointRegion::CollectAny(Changes& changes)
+{
+    changes.analogs.clear();
+    changes.binaries.clear();
+    scan(changes.analogs, changes.binaries);
+}
+
+void SharedPointRegion::scan(std::vector<std::pair<uint32_t, double>>& analogChanges,
+                             std::vector<std::pair<uint32_t, bool>>& binaryChanges)
+{
+    size_t analogWords = numWords(numAnalogs);
+    size_t binaryWords = numWords(numBinaries);
+    std::fill(taken.begin(), taken.end(), 0);
+
+    for (size_t w = 0; w < analogWords; ++w)
+    {
+        if (analogDirty[w].load(std::memory_order_relaxed) == 0)
+        {
+            continue;
+        }
+        auto bits = analogDirty[w].exchange(0, std::memory_order_acquire);
+        taken[w] = bits;
+        while (bits != 0)
+        {
+            auto index = static_cast<uint32_t>(w * 64 + lowestBit(bits));
+            analogChanges.emplace_back(index, analogs[index].load(std::memory_order_relaxed));
+            bits &= bits - 1;
+        }
+    }
+
+    for (size_t w = 0; w < binaryWords; ++w)
+    {
+        if (binaryDirty[w].load(std::memory_order_relaxed) == 0)
+        {
+            continue;
+        }
+        auto bits = binaryDirty[w].exchange(0, std::memory_order_acquire);
+        taken[analogWords + w] = bits;
+        while (bits != 0)
+        {
+            auto index = static_cast<uint32_t>(w * 64 + lowestBit(bits));
+            binaryChanges.emplace_back(index, binaries[index].load(std::memory_order_relaxed) != 0);
+            bits &= bits - 1;
+        }
+    }
+}
+
+// SharedPointBridge
+
+SharedPointBridge::SharedPointBridge(std::shared_ptr<IOTable> table,
+                                     std::shared_ptr<Scheduler> scheduler,
+                                     std::shared_ptr<SharedPointRegion> region)
+    : table(table), scheduler(std::move(scheduler)), region(std::move(region)), points(table)
+{
+}
+
+SharedPointBridge::~SharedPointBridge()
+{
+    Stop();
+}
+
+std::shared_ptr<SharedPointBridge> SharedPointBridge::Create(std::shared_ptr<IOTable> table,
+                                                             std::shared_ptr<Scheduler> scheduler,
+                                                             const std::string& path)
+{
+    const auto& analogs = table->GetAnalogInputs();
+    const auto& binaries = table->GetBinaryInputs();
+    auto region = SharedPointRegion::Create(path, analogs.size(), binaries.size());
+
+    // The co-simulator starts from the current point values
+    for (size_t i = 0; i < analogs.size(); ++i)
+    {
+        region->StoreAnalog(i, analogs[i]->Read());
+    }
+    for (size_t i = 0; i < binaries.size(); ++i)
+    {
+        region->StoreBinary(i, binaries[i]->Read());
+    }
+
+    return std::make_shared<SharedPointBridge>(std::move(table), std::move(scheduler), std::move(region));
+}
+
+void SharedPointBridge::SetStarvationListener(StarvationListener listener)
+{
+    starvationListener = std::move(listener);
+}
+
+void SharedPointBridge::Start(std::chrono::milliseconds interval)
+{
+    Stop();
+    tickTask = scheduler->SchedulePeriodic(interval, [this]() { Tick(); });
+}
+
+void SharedPointBridge::Stop()
+{
+    scheduler->Cancel(tickTask);
+    tickTask = Scheduler::INVALID_TASK;
+}
+
+void SharedPointBridge::Tick()
+{
+    if (region->Collect(changes))
+    {
+        deferred = 0;
+        starving = false;
+    }
+    else
+    {
+        retries++;
+        if (!starving)
+        {
+            if (++deferred < MAX_DEFERRED_TICKS)
+            {
+                return;
+            }
+            starving = true;
+            if (starvationListener)
+            {
+                starvationListener(deferred);
+            }
+        }
+
+        // The writer has been busy on every tick for too long: fall back to a read that may be torn
+        region->CollectAny(changes);
+        tornReads++;
+    }
+    if (changes.analogs.empty() && changes.binaries.empty())
+    {
+        return;
+    }
+
+    auto builder = opendnp3::UpdateBuilder();
+    for (const auto& change : changes.analogs)
+    {
+        points.Write({PointType::ANALOG_INPUT, static_cast<uint16_t>(change.first)}, change.second, builder);
+    }
+    const auto& binaries = table->GetBinaryInputs();
+    for (const auto& change : changes.binaries)
+    {
+        binaries[change.first]->Write(change.second, builder);
+    }
+    table->Apply(builder.Build());
+    applied += changes.analogs.size() + changes.binaries.size();
+}
+
+std::shared_ptr<SharedPointRegion> SharedPointBridge::GetRegion() const
+{
+    return region;
+}
+
+uint64_t SharedPointBridge::NumApplied() const
+{
+    return applied;
+}
+
+uint64_t SharedPointBridge::NumRetries() const
+{
+    return retries;
+}
+
+uint64_t SharedPointBridge::NumTornReads() const
+{
+    return tornReads;
+}
@@ -0,0 +1,179 @@
+#ifndef CALDERADNP3_OUTSTATION_SHARED_POINTS_H
+#define CALDERADNP3_OUTSTATION_SHARED_POINTS_H
+
+#include "outstation/io_table.h"
+#include "outstation/point_index.h"
+#include "outstation/scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * SharedPointHeader starts the memory-mapped region shared with a co-simulator.
+ *
+ * The region is laid out as this 64 byte header, followed by the arrays it
+ * points to, each at a byte offset from the start of the region and aligned
+ * to 8 bytes:
+ *
+ *   analogs        double[numAnalogs]     analog input values, by index
+ *   binaries       uint8_t[numBinaries]   binary input values (0 or 1), by index
+ *   analogDirty    uint64_t[(numAnalogs + 63) / 64]   bit i % 64 of word i / 64 marks analog i
+ *   binaryDirty    uint64_t[(numBinaries + 63) / 64]  same for binaries
+ *
+ * sequence is a seqlock for a single writer: it is odd while the writer is
+ * updating values. A writer increments it, stores values, sets their dirty
+ * bits with an atomic OR, then increments it again.
+ */
+struct SharedPointHeader
+{
+    static constexpr uint32_t MAGIC = 0x33504E44; // "DNP3"
+    static constexpr uint16_t VERSION = 1;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t numAnalogs;
+    uint32_t numBinaries;
+    std::atomic<uint32_t> sequence;
+    uint32_t reserved;
+    uint64_t analogOffset;
+    uint64_t binaryOffset;
+    uint64_t analogDirtyOffset;
+    uint64_t binaryDirtyOffset;
+    uint64_t padding;
+};
+
+/**
+ * SharedPointRegion maps the shared region into this process.
+ *
+ * The outstation creates the region for its point counts; a co-simulator
+ * written in C++ opens it and uses the writer functions, any other process
+ * can follow the layout of SharedPointHeader. Only POSIX systems are
+ * supported.
+ */
+class SharedPointRegion
+{
+private:
+    std::string path;
+    void* base = nullptr;
+    size_t size = 0;
+
+    SharedPointHeader* header = nullptr;
+    std::atomic<double>* analogs = nullptr;
+    std::atomic<uint8_t>* binaries = nullptr;
+    std::atomic<uint64_t>* analogDirty = nullptr;
+    std::atomic<uint64_t>* binaryDirty = nullptr;
+
+    // Counts are read once when mapping, the other process cannot change them afterwards
+    size_t numAnalogs = 0;
+    size_t numBinaries = 0;
+    uint32_t writeSequence = 0;
+    std::vector<uint64_t> taken;
+
+    void bind();
+    void scan(std::vector<std::pair<uint32_t, double>>& analogChanges,
+              std::vector<std::pair<uint32_t, bool>>& binaryChanges);
+
+public:
+    SharedPointRegion() = default;
+    ~SharedPointRegion();
+    SharedPointRegion(const SharedPointRegion&) = delete;
+    SharedPointRegion& operator=(const SharedPointRegion&) = delete;
+
+    // Both throw std::runtime_error when the region cannot be mapped
+    static std::shared_ptr<SharedPointRegion> Create(const std::string& path, size_t numAnalogs, size_t numBinaries);
+    static std::shared_ptr<SharedPointRegion> Open(const std::string& path);
+
+    size_t NumAnalogs() const;
+    size_t NumBinaries() const;
+
+    // Writer side; values stored between BeginWrite and EndWrite are seen together
+    void BeginWrite();
+    void WriteAnalog(size_t index, double value);
+    void WriteBinary(size_t index, bool value);
+    void EndWrite();
+
+    // Reader side; the dirty bits of a snapshot torn by a concurrent write are restored for the next read
+    struct Changes
+    {
+        std::vector<std::pair<uint32_t, double>> analogs;
+        std::vector<std::pair<uint32_t, bool>> binaries;
+    };
+    bool Collect(Changes& changes);
+
+    // Takes the dirty points whatever the writer is doing. Every value is the last one stored for
+    // its point, but the values of one write may be split between two reads.
+    void CollectAny(Changes& changes);
+
+    // Sets a value without marking it dirty, e.g. to publish the initial state
+    void StoreAnalog(size_t index, double value);
+    void StoreBinary(size_t index, bool value);
+};
+
+/**
+ * SharedPointBridge feeds the points of an IOTable from a SharedPointRegion.
+ *
+ * Analog and binary inputs are addressed by their IOTable index. On every
+ * tick the dirty bits are scanned a word at a time, and only the points
+ * that changed are written, in a single Apply. A generated analog written
+ * through the region is pinned to that value.
+ *
+ * A tick that overlaps a write is deferred to the next one. A writer that
+ * keeps the region busy for MAX_DEFERRED_TICKS ticks in a row would starve
+ * the outstation, so the changes are then applied as they are, without the
+ * guarantee that the values of one write arrive together, until a
+ * consistent read succeeds again. The starvation listener is told once
+ * each time this starts.
+ */
+class SharedPointBridge
+{
+public:
+    static constexpr uint32_t MAX_DEFERRED_TICKS = 10;
+
+    // Called with the number of ticks deferred when the writer starts starving the outstation
+    using StarvationListener = std::function<void(uint32_t)>;
+
+private:
+    std::shared_ptr<IOTable> table;
+    std::shared_ptr<Scheduler> scheduler;
+    std::shared_ptr<SharedPointRegion> region;
+    PointIndex points;
+    Scheduler::TaskId tickTask = Scheduler::INVALID_TASK;
+
+    SharedPointRegion::Changes changes;
+    std::atomic<uint64_t> applied{0};
+    std::atomic<uint64_t> retries{0};
+    std::atomic<uint64_t> tornReads{0};
+    uint32_t deferred = 0;
+    bool starving = false;
+    StarvationListener starvationListener;
+
+public:
+    SharedPointBridge(std::shared_ptr<IOTable> table,
+                      std::shared_ptr<Scheduler> scheduler,
+                      std::shared_ptr<SharedPointRegion> region);
+    ~SharedPointBridge();
+    static std::shared_ptr<SharedPointBridge> Create(std::shared_ptr<IOTable> table,
+                                                     std::shared_ptr<Scheduler> scheduler,
+                                                     const std::string& path);
+
+    // Set before Start
+    void SetStarvationListener(StarvationListener listener);
+    void Start(std::chrono::milliseconds interval);
+    void Stop();
+    void Tick();
+
+    std::shared_ptr<SharedPointRegion> GetRegion() const;
+    uint64_t NumApplied() const;
+    uint64_t NumRetries() const;
+    uint64_t NumTornReads() const;
+};
+
+#endif // CALDERADNP3_OUTSTATION_SHARED_POINTS_H
@@ -0,0 +1,145 @@
+#include "outstation/sim_clock.h"
+
+namespace
+{
+std::shared_ptr<SimClock> defaultClock = SimClock::Create();
+} // namespace
+
+// ClockModeSpec
+
+char const* ClockModeSpec::to_string(ClockMode arg)
+{
+    switch (arg)
+    {
+    case ClockMode::REAL_TIME:
+        return "REAL_TIME";
+    case ClockMode::SCALED:
+        return "SCALED";
+    case ClockMode::FREE_RUN:
+        return "FREE_RUN";
+    default:
+        return "UNDEFINED";
+    }
+}
+
+char const* ClockModeSpec::to_human_string(ClockMode arg)
+{
+    switch (arg)
+    {
+    case ClockMode::REAL_TIME:
+        return "Real Time";
+    case ClockMode::SCALED:
+        return "Scaled";
+    case ClockMode::FREE_RUN:
+        return "Free Run";
+    default:
+        return "Undefined";
+    }
+}
+
+ClockMode ClockModeSpec::from_string(const std::string& arg)
+{
+    if (arg == "REAL_TIME")
+        return ClockMode::REAL_TIME;
+    if (arg == "SCALED")
+        return ClockMode::SCALED;
+    if (arg == "FREE_RUN")
+        return ClockMode::FREE_RUN;
+    return ClockMode::UNDEFINED;
+}
+
+// SimClock
+
+SimClock::SimClock(ClockMode mode, double scale)
+    : mode(mode),
+      scale(scale > 0 ? scale : 1.0),
+      wallStart(std::chrono::steady_clock::now()),
+      systemStart(std::chrono::system_clock::now())
+{
+    if (this->mode == ClockMode::REAL_TIME)
+    {
+        this->scale = 1.0;
+    }
+}
+
+std::shared_ptr<SimClock> SimClock::Create(ClockMode mode, double scale)
+{
+    return std::make_shared<SimClock>(mode, scale);
+}
+
+std::shared_ptr<SimClock> SimClock::Default()
+{
+    return std::atomic_load(&defaultClock);
+}
+
+void SimClock::SetDefault(std::shared_ptr<SimClock> clock)
+{
+    if (!clock)
+    {
+        return;
+    }
+    std::atomic_store(&defaultClock, std::move(clock));
+}
+
+ClockMode SimClock::GetMode() const
+{
+    return mode;
+}
+
+double SimClock::GetScale() const
+{
+    return scale;
+}
+
+SimClock::time_point SimClock::Now() const
+{
+    switch (mode)
+    {
+    case ClockMode::FREE_RUN:
+        return wallStart + duration(elapsed.load());
+    case ClockMode::SCALED:
+    {
+        auto wallElapsed = std::chrono::steady_clock::now() - wallStart;
+        return wallStart + std::chrono::duration_cast<duration>(wallElapsed * scale);
+    }
+    default:
+        return std::chrono::steady_clock::now();
+    }
+}
+
+std::chrono::system_clock::time_point SimClock::SystemNow() const
+{
+    auto simElapsed = Now() - wallStart;
+    return systemStart + std::chrono::duration_cast<std::chrono::system_clock::duration>(simElapsed);
+}
+
+std::chrono::steady_clock::time_point SimClock::ToWall(time_point simTime) const
+{
+    switch (mode)
+    {
+    case ClockMode::FREE_RUN:
+        // Deadlines in free-run mode are reached by advancing the clock, never by waiting.
+        return std::chrono::steady_clock::now();
+    case ClockMode::SCALED:
+    {
+        auto simElapsed = simTime - wallStart;
+        return wallStart + std::chrono::duration_cast<duration>(simElapsed / scale);
+    }
+    default:
+        return simTime;
+    }
+}
+
+void SimClock::AdvanceTo(time_point simTime)
+{
+    if (mode != ClockMode::FREE_RUN)
+    {
+        return;
+    }
+
+    auto target = (simTime - wallStart).count();
+    auto current = elapsed.load();
+    while ((target > current) && !elapsed.compare_exchange_weak(current, target))
+    {
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef CALDERADNP3_OUTSTATION_SIM_CLOCK_H
+#define CALDERADNP3_OUTSTATION_SIM_CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+enum class ClockMode : uint8_t
+{
+    REAL_TIME = 0,
+    SCALED = 1,
+    FREE_RUN = 2,
+    UNDEFINED = 127
+};
+
+struct ClockModeSpec
+{
+    using enum_type_t = ClockMode;
+
+    static char const* to_string(ClockMode arg);
+    static char const* to_human_string(ClockMode arg);
+    static ClockMode from_string(const std::string& arg);
+};
+
+/**
+ * SimClock is the time base for device timelines and measurement timestamps.
+ *
+ * Simulation time starts at the wall clock time the SimClock was created.
+ * REAL_TIME follows the wall clock, SCALED advances `scale` times faster and
+ * FREE_RUN only advances when the Scheduler jumps it to the next deadline,
+ * so timed work runs back to back as fast as it can be processed.
+ */
+class SimClock
+{
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+    using duration = std::chrono::steady_clock::duration;
+
+    explicit SimClock(ClockMode mode, double scale);
+    static std::shared_ptr<SimClock> Create(ClockMode mode = ClockMode::REAL_TIME, double scale = 1.0);
+
+    // Process-wide clock used for measurement timestamps. Install it at startup,
+    // before any device or outstation is created. A clock returned before it is
+    // replaced stays valid for as long as the caller holds it.
+    static std::shared_ptr<SimClock> Default();
+    static void SetDefault(std::shared_ptr<SimClock> clock);
+
+    ClockMode GetMode() const;
+    double GetScale() const;
+
+    time_point Now() const;
+    std::chrono::system_clock::time_point SystemNow() const;
+    std::chrono::steady_clock::time_point ToWall(time_point simTime) const;
+    void AdvanceTo(time_point simTime);
+
+private:
+    ClockMode mode;
+    double scale;
+
+    std::chrono::steady_clock::time_point wallStart;
+    std::chrono::system_clock::time_point systemStart;
+    std::atomic<duration::rep> elapsed{0};
+};
+
+#endif // CALDERADNP3_OUTSTATION_SIM_CLOCK_H
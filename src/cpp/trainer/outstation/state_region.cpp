@@ -0,0 +1,652 @@
+#include "outstation/state_region.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(StateRegionHeader) == 64, "the state region header is part of its layout");
+static_assert(sizeof(StatePoint) == 64 && sizeof(StateDevice) == 64 && sizeof(StateLogRecord) == 256,
+              "the state region entries are part of its layout");
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free
+                  && std::atomic<double>::is_always_lock_free,
+              "a lock in the state region would not be shared with the other processes");
+
+namespace
+{
+template<size_t N> void copyText(char (&to)[N], const std::string& from)
+{
+    auto length = std::min(from.size(), N - 1);
+    std::memcpy(to, from.data(), length);
+    to[length] = '\0';
+}
+
+template<size_t N> std::string readText(const char (&from)[N])
+{
+    return std::string(from, strnlen(from, N));
+}
+
+std::runtime_error systemError(const std::string& what, const std::string& path)
+{
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+// Describes a device for the region
+class DeviceDescription : public DeviceVisitor
+{
+public:
+    StateDeviceKind kind = StateDeviceKind::SIMPLE;
+    std::string name;
+    TwoSignalControlModel model = TwoSignalControlModel::UNDEFINED;
+    bool readOnly = false;
+
+    void Visit(SimpleDevice& device) override
+    {
+        kind = StateDeviceKind::SIMPLE;
+        name = device.GetName();
+    }
+
+    void Visit(Breaker& device) override
+    {
+        kind = StateDeviceKind::BREAKER;
+        name = device.GetName();
+        model = device.GetModel();
+    }
+
+    void Visit(SlowDevice& device) override
+    {
+        kind = StateDeviceKind::SWITCH;
+        name = device.GetName();
+        model = device.GetModel();
+    }
+
+    void Visit(SetpointController& device) override
+    {
+        kind = StateDeviceKind::SETPOINT;
+        name = device.GetName();
+        readOnly = device.IsReadOnly();
+    }
+};
+
+double readValue(const IMeasurement* point, StatePointType type)
+{
+    switch (type)
+    {
+    case StatePointType::BINARY_INPUT:
+        return static_cast<const Binary*>(point)->Read() ? 1.0 : 0.0;
+    case StatePointType::DOUBLE_BIT_INPUT:
+        return opendnp3::DoubleBitSpec::to_type(static_cast<const DoubleBit*>(point)->Read());
+    case StatePointType::ANALOG_INPUT:
+        return static_cast<const Analog*>(point)->Read();
+    default:
+        return 0.0;
+    }
+}
+} // namespace
+
+// StateRegion
+
+#ifdef _WIN32
+
+StateRegion::~StateRegion() {}
+
+std::shared_ptr<StateRegion> StateRegion::Create(const std::string&, size_t, size_t, size_t)
+{
+    throw std::runtime_error("state regions are not supported on this platform");
+}
+
+std::shared_ptr<StateRegion> StateRegion::Open(const std::string&)
+{
+    throw std::runtime_error("state regions are not supported on this platform");
+}
+
+#else
+
+StateRegion::~StateRegion()
+{
+    if (base)
+    {
+        munmap(base, size);
+    }
+}
+
+std::shared_ptr<StateRegion> StateRegion::Create(const std::string& path,
+                                                 size_t numPoints,
+                                                 size_t numDevices,
+                                                 size_t logCapacity)
+{
+    size_t pointOffset = sizeof(StateRegionHeader);
+    size_t deviceOffset = pointOffset + numPoints * sizeof(StatePoint);
+    size_t logOffset = deviceOffset + numDevices * sizeof(StateDevice);
+    size_t size = logOffset + logCapacity * sizeof(StateLogRecord);
+
+    // A new file, so viewers still attached to a previous run keep their mapping
+    unlink(path.c_str());
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        throw systemError("cannot create", path);
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0)
+    {
+        auto error = systemError("cannot size", path);
+        close(fd);
+        throw error;
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        throw systemError("cannot map", path);
+    }
+
+    auto region = std::make_shared<StateRegion>();
+    region->path = path;
+    region->base = base;
+    region->size = size;
+
+    // The file is zero filled, which is a valid state for every array
+    auto* header = new (base) StateRegionHeader();
+    header->headerSize = sizeof(StateRegionHeader);
+    header->numPoints = static_cast<uint32_t>(numPoints);
+    header->numDevices = static_cast<uint32_t>(numDevices);
+    header->logCapacity = static_cast<uint32_t>(logCapacity);
+    header->pointOffset = pointOffset;
+    header->deviceOffset = deviceOffset;
+    header->logOffset = logOffset;
+    header->version = StateRegionHeader::VERSION;
+    header->logEnd.store(0);
+
+    region->bind();
+    return region;
+}
+
+std::shared_ptr<StateRegion> StateRegion::Open(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw systemError("cannot open", path);
+    }
+    struct stat info
+    {
+    };
+    if ((fstat(fd, &info) < 0) || (static_cast<size_t>(info.st_size) < sizeof(StateRegionHeader)))
+    {
+        close(fd);
+        throw std::runtime_error(path + " is not a state region");
+    }
+
+    // Viewers only read, so a viewer can never disturb the outstation or another viewer
+    auto size = static_cast<size_t>(info.st_size);
+    void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        throw systemError("cannot map", path);
+    }
+
+    auto region = std::make_shared<StateRegion>();
+    region->path = path;
+    region->base = base;
+    region->size = size;
+
+    auto* header = static_cast<StateRegionHeader*>(base);
+    if ((header->magic != StateRegionHeader::MAGIC) || (header->version != StateRegionHeader::VERSION)
+        || (header->pointOffset + header->numPoints * sizeof(StatePoint) > header->deviceOffset)
+        || (header->deviceOffset + header->numDevices * sizeof(StateDevice) > header->logOffset)
+        || (header->logOffset + header->logCapacity * sizeof(StateLogRecord) > size))
+    {
+        throw std::runtime_error(path + " is not a compatible state region, or is not published yet");
+    }
+
+    region->bind();
+    return region;
+}
+
+#endif
+
+void StateRegion::Publish()
+{
+    // The magic is written last, so a viewer never attaches to a half initialized region
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = StateRegionHeader::MAGIC;
+}
+
+void StateRegion::bind()
+{
+    auto* bytes = static_cast<uint8_t*>(base);
+    header = static_cast<StateRegionHeader*>(base);
+    points = reinterpret_cast<StatePoint*>(bytes + header->pointOffset);
+    devices = reinterpret_cast<StateDevice*>(bytes + header->deviceOffset);
+    logs = reinterpret_cast<StateLogRecord*>(bytes + header->logOffset);
+}
+
+size_t StateRegion::NumPoints() const
+{
+    return header->numPoints;
+}
+
+size_t StateRegion::NumDevices() const
+{
+    return header->numDevices;
+}
+
+StatePoint& StateRegion::Point(size_t position)
+{
+    return points[position];
+}
+
+const StatePoint& StateRegion::Point(size_t position) const
+{
+    return points[position];
+}
+
+StateDevice& StateRegion::Device(size_t position)
+{
+    return devices[position];
+}
+
+const StateDevice& StateRegion::Device(size_t position) const
+{
+    return devices[position];
+}
+
+void StateRegion::WriteLog(const char* id, opendnp3::LogLevel level, const char* message)
+{
+    if (header->logCapacity == 0)
+    {
+        return;
+    }
+
+    auto n = header->logEnd.fetch_add(1, std::memory_order_relaxed);
+    auto& record = logs[n % header->logCapacity];
+    record.sequence.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    record.level = level.value;
+    copyText(record.id, id);
+    copyText(record.message, message);
+    record.sequence.store(2 * n + 2, std::memory_order_release);
+}
+
+void StateRegion::ReadLog(uint64_t& next,
+                          const std::function<void(const char*, opendnp3::LogLevel, const char*)>& visit) const
+{
+    auto capacity = header->logCapacity;
+    if (capacity == 0)
+    {
+        return;
+    }
+    auto end = header->logEnd.load(std::memory_order_acquire);
+    if (end - std::min(next, end) > capacity)
+    {
+        next = end - capacity;
+    }
+
+    char id[sizeof(StateLogRecord::id)];
+    char message[sizeof(StateLogRecord::message)];
+    for (; next < end; ++next)
+    {
+        const auto& record = logs[next % capacity];
+        auto sequence = record.sequence.load(std::memory_order_acquire);
+        if (sequence < 2 * next + 2)
+        {
+            // Still being written: read it again next time
+            return;
+        }
+        if (sequence > 2 * next + 2)
+        {
+            continue;
+        }
+
+        auto level = record.level;
+        std::memcpy(id, record.id, sizeof(id));
+        std::memcpy(message, record.message, sizeof(message));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (record.sequence.load(std::memory_order_relaxed) != sequence)
+        {
+            continue;
+        }
+
+        id[sizeof(id) - 1] = '\0';
+        message[sizeof(message) - 1] = '\0';
+        visit(id, opendnp3::LogLevel{level}, message);
+    }
+}
+
+// StatePublisher
+
+StatePublisher::StatePublisher(std::shared_ptr<IOTable> table,
+                               std::vector<std::shared_ptr<IDevice>> devices,
+                               std::shared_ptr<Scheduler> scheduler,
+                               std::shared_ptr<StateRegion> region)
+    : table(std::move(table)), devices(std::move(devices)), scheduler(std::move(scheduler)), region(std::move(region))
+{
+    auto add = [this](const auto& list, StatePointType type) {
+        for (const auto& point : list)
+        {
+            points.push_back({point.get(), type});
+        }
+    };
+    add(this->table->GetBinaryInputs(), StatePointType::BINARY_INPUT);
+    add(this->table->GetDoubleBitInputs(), StatePointType::DOUBLE_BIT_INPUT);
+    add(this->table->GetAnalogInputs(), StatePointType::ANALOG_INPUT);
+    add(this->table->GetBinaryOutputs(), StatePointType::BINARY_OUTPUT);
+    add(this->table->GetAnalogOutputs(), StatePointType::ANALOG_OUTPUT);
+
+    std::unordered_map<const IMeasurement*, uint32_t> positions;
+    for (size_t p = 0; p < points.size(); ++p)
+    {
+        auto& entry = this->region->Point(p);
+        entry.type = points[p].type;
+        copyText(entry.name, points[p].point->GetName());
+        entry.value.store(readValue(points[p].point, points[p].type), std::memory_order_relaxed);
+        entry.version.store(points[p].point->GetVersion(), std::memory_order_release);
+        positions[points[p].point] = static_cast<uint32_t>(p);
+    }
+
+    for (size_t d = 0; d < this->devices.size(); ++d)
+    {
+        DeviceDescription description;
+        this->devices[d]->Accept(description);
+
+        auto& entry = this->region->Device(d);
+        entry.kind = description.kind;
+        entry.model = static_cast<uint8_t>(description.model);
+        entry.readOnly = description.readOnly ? 1 : 0;
+        copyText(entry.name, description.name);
+
+        auto input = positions.find(this->devices[d]->GetInputPoint());
+        entry.point = (input != positions.end()) ? input->second : UINT32_MAX;
+
+        if (description.kind == StateDeviceKind::SWITCH)
+        {
+            auto device = std::static_pointer_cast<SlowDevice>(this->devices[d]);
+            entry.position.store(device->Position(), std::memory_order_relaxed);
+            switches.emplace_back(device, d);
+        }
+    }
+
+    this->region->Publish();
+}
+
+StatePublisher::~StatePublisher()
+{
+    Stop();
+}
+
+std::shared_ptr<StatePublisher> StatePublisher::Create(std::shared_ptr<IOTable> table,
+                                                       std::vector<std::shared_ptr<IDevice>> devices,
+                                                       std::shared_ptr<Scheduler> scheduler,
+                                                       const std::string& path)
+{
+    auto numPoints = table->GetBinaryInputs().size() + table->GetDoubleBitInputs().size()
+        + table->GetAnalogInputs().size() + table->GetBinaryOutputs().size() + table->GetAnalogOutputs().size();
+    auto region = StateRegion::Create(path, numPoints, devices.size(), StateRegion::DEFAULT_LOG_CAPACITY);
+
+    return std::make_shared<StatePublisher>(
+        std::move(table), std::move(devices), std::move(scheduler), std::move(region));
+}
+
+void StatePublisher::Start(std::chrono::milliseconds interval)
+{
+    Stop();
+    tickTask = scheduler->SchedulePeriodic(interval, [this]() { Tick(); });
+}
+
+void StatePublisher::Stop()
+{
+    scheduler->Cancel(tickTask);
+    tickTask = Scheduler::INVALID_TASK;
+}
+
+void StatePublisher::Tick()
+{
+    // Outputs carry no value, their names were published once
+    for (size_t p = 0; p < points.size(); ++p)
+    {
+        const auto& published = points[p];
+        if (published.type == StatePointType::BINARY_OUTPUT || published.type == StatePointType::ANALOG_OUTPUT)
+        {
+            continue;
+        }
+
+        auto& entry = region->Point(p);
+        auto version = published.point->GetVersion();
+        if (version == entry.version.load(std::memory_order_relaxed))
+        {
+            continue;
+        }
+        entry.value.store(readValue(published.point, published.type), std::memory_order_relaxed);
+        entry.version.store(version, std::memory_order_release);
+    }
+
+    for (const auto& [device, position] : switches)
+    {
+        region->Device(position).position.store(device->Position(), std::memory_order_relaxed);
+    }
+}
+
+std::shared_ptr<StateRegion> StatePublisher::GetRegion() const
+{
+    return region;
+}
+
+// StateLogTap
+
+StateLogTap::StateLogTap(std::shared_ptr<opendnp3::ILogHandler> handler) : handler(std::move(handler)) {}
+
+std::shared_ptr<StateLogTap> StateLogTap::Create(std::shared_ptr<opendnp3::ILogHandler> handler)
+{
+    return std::make_shared<StateLogTap>(std::move(handler));
+}
+
+void StateLogTap::Attach(std::shared_ptr<StateRegion> region)
+{
+    if (attached)
+    {
+        return;
+    }
+
+    // The region is kept alive by the tap, so loggers can use it without taking a reference
+    attached = std::move(region);
+    this->region.store(attached.get(), std::memory_order_release);
+}
+
+void StateLogTap::log(opendnp3::ModuleId module,
+                      const char* id,
+                      opendnp3::LogLevel level,
+                      char const* location,
+                      char const* message)
+{
+    if (auto* target = region.load(std::memory_order_acquire))
+    {
+        target->WriteLog(id, level, message);
+    }
+    handler->log(module, id, level, location, message);
+}
+
+// StateMirror
+
+StateMirror::StateMirror(std::shared_ptr<StateRegion> region, std::shared_ptr<Scheduler> scheduler)
+    : region(std::move(region)), table(IOTable::Create(scheduler))
+{
+    const auto& published = *this->region;
+    for (size_t p = 0; p < published.NumPoints(); ++p)
+    {
+        const auto& entry = published.Point(p);
+        std::shared_ptr<IMeasurement> point;
+        switch (entry.type)
+        {
+        case StatePointType::BINARY_INPUT:
+        {
+            auto input = Binary::Create();
+            table->RegisterBinaryInput(input);
+            point = input;
+            break;
+        }
+        case StatePointType::DOUBLE_BIT_INPUT:
+        {
+            auto input = DoubleBit::Create();
+            table->RegisterDoubleBitInput(input);
+            point = input;
+            break;
+        }
+        case StatePointType::ANALOG_INPUT:
+        {
+            auto input = Analog::Create(0.0);
+            table->RegisterAnalogInput(input);
+            point = input;
+            break;
+        }
+        case StatePointType::BINARY_OUTPUT:
+        {
+            auto output = std::make_shared<BinaryOutput>();
+            table->RegisterBinaryOutput(output);
+            point = output;
+            break;
+        }
+        case StatePointType::ANALOG_OUTPUT:
+        {
+            auto output = AnalogOutput::Create(nullptr, false);
+            table->RegisterAnalogOutput(output);
+            point = output;
+            break;
+        }
+        default:
+            throw std::runtime_error("the state region has a point of unknown type");
+        }
+        point->SetName(readText(entry.name));
+        points.push_back(point);
+
+        // One behind, so every value is applied by the first Sync
+        versions.push_back(entry.version.load(std::memory_order_acquire) - 1);
+    }
+
+    // Devices are rebuilt around the mirrored points, which they rename as the originals did
+    for (size_t d = 0; d < published.NumDevices(); ++d)
+    {
+        const auto& entry = published.Device(d);
+        auto name = readText(entry.name);
+        auto model = static_cast<TwoSignalControlModel>(entry.model);
+        auto input = (entry.point < points.size()) ? points[entry.point] : nullptr;
+
+        std::shared_ptr<IDevice> device;
+        if (entry.kind == StateDeviceKind::SIMPLE)
+        {
+            auto simple = SimpleDevice::Create(name);
+            if (input && published.Point(entry.point).type == StatePointType::BINARY_INPUT)
+            {
+                simple->AssignInputPoint(std::static_pointer_cast<Binary>(input));
+            }
+            device = simple;
+        }
+        else if (entry.kind == StateDeviceKind::BREAKER)
+        {
+            auto breaker = Breaker::Create(name, model);
+            if (input && published.Point(entry.point).type == StatePointType::BINARY_INPUT)
+            {
+                breaker->AssignInputPoint(std::static_pointer_cast<Binary>(input));
+            }
+            device = breaker;
+        }
+        else if (entry.kind == StateDeviceKind::SWITCH)
+        {
+            auto slow = SlowDevice::Create(name, 0, model, scheduler);
+            if (input && published.Point(entry.point).type == StatePointType::DOUBLE_BIT_INPUT)
+            {
+                slow->AssignInputPoint(std::static_pointer_cast<DoubleBit>(input));
+            }
+            switches.emplace_back(slow, d);
+            positions.push_back(-1.0);
+            device = slow;
+        }
+        else
+        {
+            auto setpoint = SetpointController::Create(name, 0.0, 0.0, table->GetWaveforms());
+            if (input && published.Point(entry.point).type == StatePointType::ANALOG_INPUT)
+            {
+                setpoint->AssignInputPoint(std::static_pointer_cast<Analog>(input));
+            }
+            if (!entry.readOnly)
+            {
+                setpoint->CreateControlSignal();
+            }
+            device = setpoint;
+        }
+        devices.push_back(device);
+    }
+}
+
+std::shared_ptr<StateMirror> StateMirror::Create(std::shared_ptr<StateRegion> region,
+                                                 std::shared_ptr<Scheduler> scheduler)
+{
+    return std::make_shared<StateMirror>(std::move(region), std::move(scheduler));
+}
+
+std::shared_ptr<IOTable> StateMirror::GetIOTable() const
+{
+    return table;
+}
+
+std::vector<std::shared_ptr<IDevice>> StateMirror::GetDevices() const
+{
+    return devices;
+}
+
+bool StateMirror::Sync()
+{
+    const auto& published = *region;
+    bool changed = false;
+
+    for (size_t p = 0; p < points.size(); ++p)
+    {
+        const auto& entry = published.Point(p);
+        auto version = entry.version.load(std::memory_order_acquire);
+        if (version == versions[p])
+        {
+            continue;
+        }
+        versions[p] = version;
+        changed = true;
+
+        auto value = entry.value.load(std::memory_order_relaxed);
+        switch (entry.type)
+        {
+        case StatePointType::BINARY_INPUT:
+            std::static_pointer_cast<Binary>(points[p])->Write(value != 0.0);
+            break;
+        case StatePointType::DOUBLE_BIT_INPUT:
+            std::static_pointer_cast<DoubleBit>(points[p])->Write(
+                opendnp3::DoubleBitSpec::from_type(static_cast<uint8_t>(value)));
+            break;
+        case StatePointType::ANALOG_INPUT:
+            std::static_pointer_cast<Analog>(points[p])->Write(value);
+            break;
+        default:
+            break;
+        }
+    }
+
+    for (size_t s = 0; s < switches.size(); ++s)
+    {
+        auto position = published.Device(switches[s].second).position.load(std::memory_order_relaxed);
+        if (position != positions[s])
+        {
+            positions[s] = position;
+            switches[s].first->SetPosition(position);
+            changed = true;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,259 @@
+#ifndef CALDERADNP3_OUTSTATION_STATE_REGION_H
+#define CALDERADNP3_OUTSTATION_STATE_REGION_H
+
+#include "outstation/devices.h"
+#include "outstation/io_table.h"
+#include "outstation/scheduler.h"
+
+#include <opendnp3/logging/ILogHandler.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class StatePointType : uint8_t
+{
+    BINARY_INPUT = 0,
+    DOUBLE_BIT_INPUT = 1,
+    ANALOG_INPUT = 2,
+    BINARY_OUTPUT = 3,
+    ANALOG_OUTPUT = 4
+};
+
+enum class StateDeviceKind : uint8_t
+{
+    SIMPLE = 0,
+    BREAKER = 1,
+    SWITCH = 2,
+    SETPOINT = 3
+};
+
+/**
+ * StateRegionHeader starts the memory-mapped region an outstation publishes
+ * its state to.
+ *
+ * The region is laid out as this 64 byte header, followed by the arrays it
+ * points to, each at a byte offset from the start of the region:
+ *
+ *   points    StatePoint[numPoints]         the points of the IOTable, in the order of its lists:
+ *                                           binary, double-bit and analog inputs, binary and analog outputs
+ *   devices   StateDevice[numDevices]       the devices, in the order they were registered
+ *   logs      StateLogRecord[logCapacity]   the latest log records, record n in slot n % logCapacity
+ *
+ * Point values are written before their version, so a reader which sees a
+ * version also sees the value. logEnd counts the log records ever written.
+ */
+struct StateRegionHeader
+{
+    static constexpr uint32_t MAGIC = 0x56504E44; // "DNPV"
+    static constexpr uint16_t VERSION = 1;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t numPoints;
+    uint32_t numDevices;
+    uint32_t logCapacity;
+    uint32_t reserved;
+    uint64_t pointOffset;
+    uint64_t deviceOffset;
+    uint64_t logOffset;
+    std::atomic<uint64_t> logEnd;
+    uint64_t padding;
+};
+
+struct StatePoint
+{
+    std::atomic<uint32_t> version; // the version of the point when its value was published
+    StatePointType type;
+    uint8_t reserved[3];
+    std::atomic<double> value; // 0 or 1 for binaries, the opendnp3::DoubleBit value for double-bits
+    char name[48];
+};
+
+struct StateDevice
+{
+    uint32_t point; // position in the point array of the input point carrying the device's state
+    StateDeviceKind kind;
+    uint8_t model; // the TwoSignalControlModel of breakers and switches
+    uint8_t readOnly;
+    uint8_t reserved;
+    std::atomic<double> position; // of switches, which move between their status changes
+    char name[48];
+};
+
+/**
+ * StateLogRecord is a slot of the log ring. sequence is 2n + 1 while record
+ * n is written to the slot and 2n + 2 once it is complete, so a reader can
+ * tell a record it copied was not overwritten meanwhile.
+ */
+struct StateLogRecord
+{
+    std::atomic<uint64_t> sequence;
+    uint32_t level;
+    uint32_t reserved;
+    char id[32];
+    char message[208];
+};
+
+/**
+ * StateRegion maps a published state region into this process.
+ *
+ * The outstation creates the region for its IOTable and devices and is its
+ * only writer; viewers open it read-only, so any number of them can attach.
+ * Only POSIX systems are supported.
+ */
+class StateRegion
+{
+private:
+    std::string path;
+    void* base = nullptr;
+    size_t size = 0;
+
+    StateRegionHeader* header = nullptr;
+    StatePoint* points = nullptr;
+    StateDevice* devices = nullptr;
+    StateLogRecord* logs = nullptr;
+
+    void bind();
+
+public:
+    static constexpr size_t DEFAULT_LOG_CAPACITY = 4096;
+
+    StateRegion() = default;
+    ~StateRegion();
+    StateRegion(const StateRegion&) = delete;
+    StateRegion& operator=(const StateRegion&) = delete;
+
+    // Both throw std::runtime_error when the region cannot be mapped
+    static std::shared_ptr<StateRegion> Create(const std::string& path,
+                                               size_t numPoints,
+                                               size_t numDevices,
+                                               size_t logCapacity);
+    static std::shared_ptr<StateRegion> Open(const std::string& path);
+
+    size_t NumPoints() const;
+    size_t NumDevices() const;
+    StatePoint& Point(size_t position);
+    const StatePoint& Point(size_t position) const;
+    StateDevice& Device(size_t position);
+    const StateDevice& Device(size_t position) const;
+
+    // Writer side. Publish marks the region ready for viewers once points and devices are described;
+    // WriteLog is safe to call from any thread.
+    void Publish();
+    void WriteLog(const char* id, opendnp3::LogLevel level, const char* message);
+
+    // Reader side; calls visit(id, level, message) for the records from next on, and advances next.
+    // Records overwritten before they were read are skipped.
+    void ReadLog(uint64_t& next, const std::function<void(const char*, opendnp3::LogLevel, const char*)>& visit) const;
+};
+
+/**
+ * StatePublisher publishes the points and devices of an outstation to a
+ * StateRegion.
+ *
+ * Names and types are written once; on every tick the value of each point
+ * whose version changed is written, and the position of each switch.
+ */
+class StatePublisher
+{
+private:
+    struct Published
+    {
+        const IMeasurement* point;
+        StatePointType type;
+    };
+
+    std::shared_ptr<IOTable> table;
+    std::vector<std::shared_ptr<IDevice>> devices;
+    std::shared_ptr<Scheduler> scheduler;
+    std::shared_ptr<StateRegion> region;
+    std::vector<Published> points;
+    std::vector<std::pair<std::shared_ptr<SlowDevice>, size_t>> switches; // and their position in the device array
+    Scheduler::TaskId tickTask = Scheduler::INVALID_TASK;
+
+public:
+    StatePublisher(std::shared_ptr<IOTable> table,
+                   std::vector<std::shared_ptr<IDevice>> devices,
+                   std::shared_ptr<Scheduler> scheduler,
+                   std::shared_ptr<StateRegion> region);
+    ~StatePublisher();
+
+    // Throws std::runtime_error when the region cannot be created
+    static std::shared_ptr<StatePublisher> Create(std::shared_ptr<IOTable> table,
+                                                  std::vector<std::shared_ptr<IDevice>> devices,
+                                                  std::shared_ptr<Scheduler> scheduler,
+                                                  const std::string& path);
+
+    void Start(std::chrono::milliseconds interval);
+    void Stop();
+    void Tick();
+
+    std::shared_ptr<StateRegion> GetRegion() const;
+};
+
+/**
+ * StateLogTap writes the log records of a handler to a StateRegion as well.
+ * Records logged before a region is attached are only passed on.
+ */
+class StateLogTap final : public opendnp3::ILogHandler
+{
+private:
+    std::shared_ptr<opendnp3::ILogHandler> handler;
+    std::shared_ptr<StateRegion> attached;
+    std::atomic<StateRegion*> region{nullptr};
+
+public:
+    explicit StateLogTap(std::shared_ptr<opendnp3::ILogHandler> handler);
+    static std::shared_ptr<StateLogTap> Create(std::shared_ptr<opendnp3::ILogHandler> handler);
+
+    // A region can be attached once
+    void Attach(std::shared_ptr<StateRegion> region);
+
+    void log(opendnp3::ModuleId module,
+             const char* id,
+             opendnp3::LogLevel level,
+             char const* location,
+             char const* message) override;
+};
+
+/**
+ * StateMirror rebuilds the IOTable and devices of a published outstation in
+ * a viewer, and keeps their state up to date with Sync.
+ *
+ * The mirrored points and devices are plain simulation objects without an
+ * outstation: points take the published values, and switches are placed
+ * at their published position.
+ */
+class StateMirror
+{
+private:
+    std::shared_ptr<StateRegion> region;
+    std::shared_ptr<IOTable> table;
+    std::vector<std::shared_ptr<IDevice>> devices;
+
+    std::vector<std::shared_ptr<IMeasurement>> points;
+    std::vector<uint32_t> versions; // of the published values last applied
+    std::vector<std::pair<std::shared_ptr<SlowDevice>, size_t>> switches;
+    std::vector<double> positions; // of the switches, last applied
+
+public:
+    StateMirror(std::shared_ptr<StateRegion> region, std::shared_ptr<Scheduler> scheduler);
+    static std::shared_ptr<StateMirror> Create(std::shared_ptr<StateRegion> region,
+                                               std::shared_ptr<Scheduler> scheduler);
+
+    std::shared_ptr<IOTable> GetIOTable() const;
+    std::vector<std::shared_ptr<IDevice>> GetDevices() const;
+
+    // Returns whether any point or device changed
+    bool Sync();
+};
+
+#endif // CALDERADNP3_OUTSTATION_STATE_REGION_H
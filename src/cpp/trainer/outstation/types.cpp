@@ -1,18 +1,91 @@
 #include "outstation/types.h"
 
-#include <opendnp3/outstation/UpdateBuilder.h>
+#include "outstation/historian.h"
+#include "outstation/metrics.h"
+#include "outstation/sim_clock.h"
 
+#include <cmath>
 #include <unordered_set>
 
 opendnp3::DNPTime now()
 {
-    auto duration = std::chrono::system_clock::now().time_since_epoch();
+    auto duration = SimClock::Default()->SystemNow().time_since_epoch();
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
     return opendnp3::DNPTime(ms);
 }
 
+namespace
+{
+template<class Static, class Event>
+PointSpec defaultSpec(Static svariation, Event evariation, double deadband = 0.0)
+{
+    PointSpec spec;
+    spec.staticVariation = static_cast<uint8_t>(svariation);
+    spec.eventVariation = static_cast<uint8_t>(evariation);
+    spec.deadband = deadband;
+    return spec;
+}
+
+const PointSpec& binarySpec()
+{
+    static const PointSpec spec
+        = defaultSpec(opendnp3::StaticBinaryVariation::Group1Var2, opendnp3::EventBinaryVariation::Group2Var2);
+    return spec;
+}
+
+const PointSpec& analogSpec()
+{
+    static const PointSpec spec
+        = defaultSpec(opendnp3::StaticAnalogVariation::Group30Var5, opendnp3::EventAnalogVariation::Group32Var7, 0.4);
+    return spec;
+}
+
+const PointSpec& doubleBitSpec()
+{
+    static const PointSpec spec = defaultSpec(opendnp3::StaticDoubleBinaryVariation::Group3Var2,
+                                              opendnp3::EventDoubleBinaryVariation::Group4Var2);
+    return spec;
+}
+} // namespace
+
+// PointSpec
+
+bool PointSpec::operator==(const PointSpec& other) const
+{
+    return (name == other.name) && (pointClass == other.pointClass) && (staticVariation == other.staticVariation)
+        && (eventVariation == other.eventVariation) && (deadband == other.deadband);
+}
+
 // IMeasurement
 
+IMeasurement::IMeasurement(const PointSpec& defaults) : spec(&defaults) {}
+
+PointSpec& IMeasurement::EditSpec()
+{
+    if (!ownSpec)
+    {
+        ownSpec = std::make_unique<PointSpec>(*spec);
+        spec = ownSpec.get();
+    }
+    return *ownSpec;
+}
+
+const PointSpec& IMeasurement::GetSpec() const
+{
+    return *spec;
+}
+
+bool IMeasurement::ShareSpec(const PointSpec& shared)
+{
+    if (!(shared == *spec))
+    {
+        return false;
+    }
+    spec = &shared;
+    ownSpec.reset();
+    return true;
+}
+
 void IMeasurement::SetName(const std::string& name_input)
 {
     std::string modified_name = name_input;
@@ -24,12 +97,16 @@ void IMeasurement::SetName(const std::string& name_input)
             ch = '_';
         }
     }
-    name = modified_name;
+    // Setting the name a point already has keeps its spec shared
+    if (modified_name != spec->name)
+    {
+        EditSpec().name = modified_name;
+    }
 }
 
 const std::string& IMeasurement::GetName() const
 {
-    return name;
+    return spec->name;
 }
 
 void IMeasurement::SetIndex(uint16_t idx)
@@ -42,6 +119,20 @@ std::optional<uint16_t> IMeasurement::GetIndex() const
     return index;
 }
 
+uint32_t IMeasurement::GetVersion() const
+{
+    return version.load(std::memory_order_acquire);
+}
+
+void IMeasurement::Changed(double value)
+{
+    if (history)
+    {
+        history->Record(ring, value, now().value);
+    }
+    version.fetch_add(1, std::memory_order_release);
+}
+
 void IMeasurement::RegisterOutstation(std::shared_ptr<opendnp3::IOutstation> os)
 {
     outstation = os;
@@ -54,10 +145,67 @@ void IMeasurement::UpdateOutstation(const opendnp3::Updates& updates)
         return;
     }
     outstation->Apply(updates);
+    if (metrics)
+    {
+        metrics->Applied();
+    }
+}
+
+void IMeasurement::RegisterEventStats(EventStats* stats)
+{
+    eventStats = stats;
+}
+
+void IMeasurement::ReportEvent(EventType type, opendnp3::PointClass pointClass)
+{
+    if (!eventStats)
+    {
+        return;
+    }
+    eventStats->Queued(type, pointClass);
+}
+
+void IMeasurement::RegisterHistorian(Historian* hist)
+{
+    historian = hist;
+}
+
+void IMeasurement::RegisterMetrics(OutstationMetrics* m)
+{
+    metrics = m;
+}
+
+void IMeasurement::RegisterHistory(PointHistory* hist)
+{
+    // Points left without a ring when the history is full keep no history
+    auto allocated = hist ? hist->Allocate() : std::nullopt;
+    history = allocated ? hist : nullptr;
+    ring = allocated.value_or(0);
+}
+
+void IMeasurement::ReadHistory(size_t count, std::vector<PointHistory::Sample>& samples) const
+{
+    if (!history)
+    {
+        samples.clear();
+        return;
+    }
+    history->Read(ring, count, samples);
+}
+
+void IMeasurement::RecordChange(EventType type, double value, const opendnp3::DNPTime& time)
+{
+    if (!historian || !index.has_value())
+    {
+        return;
+    }
+    historian->Record(type, index.value(), value, 0x1, time.value);
 }
 
 // Binary
 
+Binary::Binary() : IMeasurement(binarySpec()) {}
+
 std::shared_ptr<Binary> Binary::Create()
 {
     return std::make_shared<Binary>();
@@ -70,7 +218,18 @@ bool Binary::Read() const
 
 void Binary::Write(bool v)
 {
-    value.store(v);
+    auto builder = opendnp3::UpdateBuilder();
+    Write(v, builder);
+    UpdateOutstation(builder.Build());
+}
+
+void Binary::Write(bool v, opendnp3::UpdateBuilder& builder)
+{
+    bool previous = value.exchange(v);
+    if (previous != v)
+    {
+        Changed(v ? 1.0 : 0.0);
+    }
 
     auto idx = GetIndex();
     if (!idx.has_value())
@@ -78,29 +237,38 @@ void Binary::Write(bool v)
         return;
     }
 
-    auto builder = opendnp3::UpdateBuilder();
-    builder.Update(opendnp3::Binary(v, opendnp3::Flags(0x1), now()), idx.value());
-    UpdateOutstation(builder.Build());
+    // The first update also changes the flags from RESTART, so it is an event as well
+    auto time = now();
+    if (!reported.exchange(true) || (previous != v))
+    {
+        ReportEvent(EventType::BINARY, GetSpec().pointClass);
+        RecordChange(EventType::BINARY, v ? 1.0 : 0.0, time);
+    }
+
+    builder.Update(opendnp3::Binary(v, opendnp3::Flags(0x1), time), idx.value());
 }
 
 opendnp3::BinaryConfig Binary::Config() const
 {
-    return {svariation, point_class, evariation};
+    const auto& spec = GetSpec();
+    return {static_cast<opendnp3::StaticBinaryVariation>(spec.staticVariation),
+            spec.pointClass,
+            static_cast<opendnp3::EventBinaryVariation>(spec.eventVariation)};
 }
 
 void Binary::SetClass(opendnp3::PointClass c)
 {
-    point_class = c;
+    EditSpec().pointClass = c;
 }
 
 void Binary::SetVariation(opendnp3::StaticBinaryVariation v)
 {
-    svariation = v;
+    EditSpec().staticVariation = static_cast<uint8_t>(v);
 }
 
 void Binary::SetEventVariation(opendnp3::EventBinaryVariation v)
 {
-    evariation = v;
+    EditSpec().eventVariation = static_cast<uint8_t>(v);
 }
 
 uint8_t Binary::GetStaticGroup() const
@@ -193,7 +361,7 @@ TwoSignalControl::TwoSignalControl(TwoSignalControlModel model,
     }
 }
 
-TwoSignalControlModel TwoSignalControl::GetModel()
+TwoSignalControlModel TwoSignalControl::GetModel() const
 {
     return controlModel;
 }
@@ -354,7 +522,9 @@ opendnp3::CommandStatus TwoOutput::Operate(opendnp3::ControlRelayOutputBlock cro
 
 // Analog
 
-Analog::Analog(double value)
+Analog::Analog() : IMeasurement(analogSpec()) {}
+
+Analog::Analog(double value) : IMeasurement(analogSpec())
 {
     this->value.store(value);
 }
@@ -374,7 +544,18 @@ double Analog::Read() const
 
 void Analog::Write(double v)
 {
-    value.store(v);
+    auto builder = opendnp3::UpdateBuilder();
+    Write(v, builder);
+    UpdateOutstation(builder.Build());
+}
+
+void Analog::Write(double v, opendnp3::UpdateBuilder& builder)
+{
+    double previous = value.exchange(v);
+    if (previous != v)
+    {
+        Changed(v);
+    }
 
     auto idx = GetIndex();
     if (!idx.has_value())
@@ -382,24 +563,44 @@ void Analog::Write(double v)
         return;
     }
 
-    auto builder = opendnp3::UpdateBuilder();
-    builder.Update(opendnp3::Analog(v, opendnp3::Flags(0x1), now()), idx.value());
-    UpdateOutstation(builder.Build());
+    auto time = now();
+    bool first = !reported.exchange(true);
+    const auto& spec = GetSpec();
+    if (first || (std::fabs(v - lastEvent.load()) > spec.deadband))
+    {
+        lastEvent.store(v);
+        ReportEvent(EventType::ANALOG, spec.pointClass);
+    }
+
+    // The historian keeps every change, including those within the deadband
+    if (first || (previous != v))
+    {
+        RecordChange(EventType::ANALOG, v, time);
+    }
+
+    builder.Update(opendnp3::Analog(v, opendnp3::Flags(0x1), time), idx.value());
 }
 
 opendnp3::AnalogConfig Analog::Config() const
 {
-    return {svariation, point_class, evariation, deadband};
+    const auto& spec = GetSpec();
+    return {static_cast<opendnp3::StaticAnalogVariation>(spec.staticVariation),
+            spec.pointClass,
+            static_cast<opendnp3::EventAnalogVariation>(spec.eventVariation),
+            spec.deadband};
 }
 
 void Analog::SetClass(opendnp3::PointClass c)
 {
-    point_class = c;
+    EditSpec().pointClass = c;
 }
 
 void Analog::SetDeadband(double db)
 {
-    deadband = db;
+    if (db != GetSpec().deadband)
+    {
+        EditSpec().deadband = db;
+    }
 }
 
 uint8_t Analog::GetStaticGroup() const
@@ -434,6 +635,8 @@ opendnp3::CommandStatus AnalogOutput::Operate(const opendnp3::AnalogOutputDouble
 
 // DoubleBit
 
+DoubleBit::DoubleBit() : IMeasurement(doubleBitSpec()) {}
+
 std::shared_ptr<DoubleBit> DoubleBit::Create()
 {
     return std::make_shared<DoubleBit>();
@@ -447,7 +650,18 @@ opendnp3::DoubleBit DoubleBit::Read() const
 
 void DoubleBit::Write(opendnp3::DoubleBit v)
 {
-    value.store(uint8_t(v));
+    auto builder = opendnp3::UpdateBuilder();
+    Write(v, builder);
+    UpdateOutstation(builder.Build());
+}
+
+void DoubleBit::Write(opendnp3::DoubleBit v, opendnp3::UpdateBuilder& builder)
+{
+    uint8_t previous = value.exchange(uint8_t(v));
+    if (previous != uint8_t(v))
+    {
+        Changed(uint8_t(v));
+    }
 
     auto idx = GetIndex();
     if (!idx.has_value())
@@ -455,29 +669,37 @@ void DoubleBit::Write(opendnp3::DoubleBit v)
         return;
     }
 
-    auto builder = opendnp3::UpdateBuilder();
-    builder.Update(opendnp3::DoubleBitBinary(v, opendnp3::Flags(0x1), now()), idx.value());
-    UpdateOutstation(builder.Build());
+    auto time = now();
+    if (!reported.exchange(true) || (previous != uint8_t(v)))
+    {
+        ReportEvent(EventType::DOUBLE_BIT, GetSpec().pointClass);
+        RecordChange(EventType::DOUBLE_BIT, opendnp3::DoubleBitSpec::to_type(v), time);
+    }
+
+    builder.Update(opendnp3::DoubleBitBinary(v, opendnp3::Flags(0x1), time), idx.value());
 }
 
 opendnp3::DoubleBitBinaryConfig DoubleBit::Config() const
 {
-    return {svariation, point_class, evariation};
+    const auto& spec = GetSpec();
+    return {static_cast<opendnp3::StaticDoubleBinaryVariation>(spec.staticVariation),
+            spec.pointClass,
+            static_cast<opendnp3::EventDoubleBinaryVariation>(spec.eventVariation)};
 }
 
 void DoubleBit::SetClass(opendnp3::PointClass c)
 {
-    point_class = c;
+    EditSpec().pointClass = c;
 }
 
 void DoubleBit::SetVariation(opendnp3::StaticDoubleBinaryVariation v)
 {
-    svariation = v;
+    EditSpec().staticVariation = static_cast<uint8_t>(v);
 }
 
 void DoubleBit::SetEventVariation(opendnp3::EventDoubleBinaryVariation v)
 {
-    evariation = v;
+    EditSpec().eventVariation = static_cast<uint8_t>(v);
 }
 
 uint8_t DoubleBit::GetStaticGroup() const
@@ -1,53 +1,111 @@
 #ifndef CALDERADNP3_OUTSTATION_TYPES_H
 #define CALDERADNP3_OUTSTATION_TYPES_H
 
+#include "outstation/event_stats.h"
+#include "outstation/point_history.h"
+
 #include <opendnp3/app/MeasurementTypes.h>
 #include <opendnp3/outstation/ICommandHandler.h>
 #include <opendnp3/outstation/IOutstation.h>
 #include <opendnp3/outstation/MeasurementConfig.h>
+#include <opendnp3/outstation/UpdateBuilder.h>
 
 #include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
+#include <string>
+#include <vector>
+
+class Historian;
+class OutstationMetrics;
+
+/**
+ * PointSpec is what describes a point rather than its state: its name and
+ * how the outstation reports it.
+ *
+ * Every point type starts from a shared default spec, and only copies it
+ * when a setter changes it. Points laid out alike, such as the points of
+ * every instance of a profile template, can share one spec instead.
+ */
+struct PointSpec
+{
+    std::string name;
+    opendnp3::PointClass pointClass = opendnp3::PointClass::Class3;
+    uint8_t staticVariation = 0; // the static and event variations of the point type, as opendnp3 enum values
+    uint8_t eventVariation = 0;
+    double deadband = 0.0; // of analogs
+
+    bool operator==(const PointSpec& other) const;
+};
 
 class IMeasurement
 {
 private:
-    std::string name = "";
+    const PointSpec* spec;
+    std::unique_ptr<PointSpec> ownSpec = nullptr;
     std::optional<uint16_t> index = std::nullopt;
     std::shared_ptr<opendnp3::IOutstation> outstation = nullptr;
+    EventStats* eventStats = nullptr;
+    Historian* historian = nullptr;
+    OutstationMetrics* metrics = nullptr;
+    PointHistory* history = nullptr;
+    uint32_t ring = 0;
+
+    // Counts the changes of the value, so views can tell which points to refresh
+    std::atomic<uint32_t> version{0};
+
+protected:
+    explicit IMeasurement(const PointSpec& defaults);
+
+    void ReportEvent(EventType type, opendnp3::PointClass pointClass);
+    void RecordChange(EventType type, double value, const opendnp3::DNPTime& time);
+    void Changed(double value);
+
+    // The point's own copy of its spec, made on first use. Specs are only changed while a table is laid out.
+    PointSpec& EditSpec();
 
 public:
-    IMeasurement() = default;
     virtual ~IMeasurement() = default;
 
     void SetName(const std::string& point_name);
     const std::string& GetName() const;
+    const PointSpec& GetSpec() const;
+
+    // Describes the point by shared, which must outlive it, in place of its own spec.
+    // Returns false, keeping the point's spec, when the two differ.
+    bool ShareSpec(const PointSpec& shared);
     void SetIndex(uint16_t idx);
     std::optional<uint16_t> GetIndex() const;
+    uint32_t GetVersion() const;
     virtual uint8_t GetStaticGroup() const = 0;
     void RegisterOutstation(std::shared_ptr<opendnp3::IOutstation> os);
     void UpdateOutstation(const opendnp3::Updates& updates);
+    void RegisterEventStats(EventStats* stats);
+    void RegisterHistorian(Historian* hist);
+    void RegisterMetrics(OutstationMetrics* m);
+    void RegisterHistory(PointHistory* hist);
+
+    // The latest count changes of the value at most, oldest first; empty without a history
+    void ReadHistory(size_t count, std::vector<PointHistory::Sample>& samples) const;
 };
 
 class Binary : public IMeasurement
 {
 private:
     std::atomic<bool> value{false};
-
-    opendnp3::PointClass point_class = opendnp3::PointClass::Class3;
-    opendnp3::StaticBinaryVariation svariation = opendnp3::StaticBinaryVariation::Group1Var2;
-    opendnp3::EventBinaryVariation evariation = opendnp3::EventBinaryVariation::Group2Var2;
+    std::atomic<bool> reported{false};
 
 public:
-    Binary() = default;
+    Binary();
     ~Binary() override = default;
     static std::shared_ptr<Binary> Create();
 
     bool Read() const;
     void Write(bool v);
+    void Write(bool v, opendnp3::UpdateBuilder& builder);
 
     opendnp3::BinaryConfig Config() const;
     void SetClass(opendnp3::PointClass c);
@@ -96,7 +154,7 @@ public:
                               std::shared_ptr<BinaryAction> tripAction,
                               std::shared_ptr<BinaryAction> closeAction);
 
-    TwoSignalControlModel GetModel();
+    TwoSignalControlModel GetModel() const;
     std::vector<std::shared_ptr<BinaryOutput>> GetOutputs();
     void SetPointNames(const std::string& name);
 };
@@ -176,20 +234,18 @@ class Analog : public IMeasurement
 {
 private:
     std::atomic<double> value{100.0};
-    double deadband = 0.4;
-
-    opendnp3::PointClass point_class = opendnp3::PointClass::Class3;
-    opendnp3::StaticAnalogVariation svariation = opendnp3::StaticAnalogVariation::Group30Var5;
-    opendnp3::EventAnalogVariation evariation = opendnp3::EventAnalogVariation::Group32Var7;
+    std::atomic<bool> reported{false};
+    std::atomic<double> lastEvent{0.0};
 
 public:
-    Analog() = default;
+    Analog();
     explicit Analog(double value);
     static std::shared_ptr<Analog> Create();
     static std::shared_ptr<Analog> Create(double value);
 
     double Read() const;
     void Write(double v);
+    void Write(double v, opendnp3::UpdateBuilder& builder);
 
     opendnp3::AnalogConfig Config() const;
     void SetClass(opendnp3::PointClass c);
@@ -217,16 +273,15 @@ class DoubleBit : public IMeasurement
 {
 private:
     std::atomic<uint8_t> value{0x1};
-
-    opendnp3::PointClass point_class = opendnp3::PointClass::Class3;
-    opendnp3::StaticDoubleBinaryVariation svariation = opendnp3::StaticDoubleBinaryVariation::Group3Var2;
-    opendnp3::EventDoubleBinaryVariation evariation = opendnp3::EventDoubleBinaryVariation::Group4Var2;
+    std::atomic<bool> reported{false};
 
 public:
+    DoubleBit();
     static std::shared_ptr<DoubleBit> Create();
 
     opendnp3::DoubleBit Read() const;
     void Write(opendnp3::DoubleBit v);
+    void Write(opendnp3::DoubleBit v, opendnp3::UpdateBuilder& builder);
 
     opendnp3::DoubleBitBinaryConfig Config() const;
     void SetClass(opendnp3::PointClass c);
@@ -0,0 +1,382 @@
+#include "outstation/waveform.h"
+
+#include <cmath>
+#include <random>
+
+namespace
+{
+constexpr double TWO_PI = 6.283185307179586;
+
+// splitmix64 finalizer, used as a counter-based generator: each value depends
+// only on its counter, so a whole batch can be produced in one flat loop.
+inline uint64_t mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Maps 64 random bits to a double in (0, 1]
+inline double toUnit(uint64_t bits)
+{
+    return static_cast<double>((bits >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+bool isRandom(double walkSigma, double noiseSigma, double uniformNoise)
+{
+    return (walkSigma != 0.0) || (noiseSigma != 0.0) || (uniformNoise != 0.0);
+}
+} // namespace
+
+// Waveform
+
+Waveform Waveform::Constant(double value)
+{
+    Waveform waveform;
+    waveform.offset = value;
+    return waveform;
+}
+
+Waveform Waveform::Sine(double offset, double amplitude, double period)
+{
+    Waveform waveform;
+    waveform.offset = offset;
+    waveform.sineAmplitude = amplitude;
+    waveform.sinePeriod = period;
+    return waveform;
+}
+
+Waveform Waveform::Ramp(double offset, double rate)
+{
+    Waveform waveform;
+    waveform.offset = offset;
+    waveform.rampRate = rate;
+    return waveform;
+}
+
+Waveform Waveform::Step(double offset, double height, double time)
+{
+    Waveform waveform;
+    waveform.offset = offset;
+    waveform.stepHeight = height;
+    waveform.stepTime = time;
+    return waveform;
+}
+
+Waveform Waveform::RandomWalk(double offset, double sigma)
+{
+    Waveform waveform;
+    waveform.offset = offset;
+    waveform.walkSigma = sigma;
+    return waveform;
+}
+
+Waveform Waveform::Noise(double offset, double sigma)
+{
+    Waveform waveform;
+    waveform.offset = offset;
+    waveform.noiseSigma = sigma;
+    return waveform;
+}
+
+// WaveformGenerator
+
+WaveformGenerator::WaveformGenerator(std::shared_ptr<Scheduler> scheduler) : scheduler(std::move(scheduler))
+{
+    std::random_device rd;
+    seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+WaveformGenerator::~WaveformGenerator()
+{
+    Stop();
+}
+
+std::shared_ptr<WaveformGenerator> WaveformGenerator::Create(std::shared_ptr<Scheduler> scheduler)
+{
+    return std::make_shared<WaveformGenerator>(std::move(scheduler));
+}
+
+size_t WaveformGenerator::Add(std::shared_ptr<Analog> point, const Waveform& waveform)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    size_t slot = points.size();
+    slots[point.get()] = slot;
+    points.push_back(std::move(point));
+
+    for (auto* column : {&offset,
+                         &sineAmplitude,
+                         &sineOmega,
+                         &sinePhase,
+                         &rampRate,
+                         &stepTime,
+                         &stepHeight,
+                         &walkSigma,
+                         &walkState,
+                         &noiseSigma,
+                         &uniformNoise,
+                         &gain,
+                         &values,
+                         &normalA,
+                         &normalB,
+                         &uniform})
+    {
+        column->push_back(0.0);
+    }
+
+    gain[slot] = 1.0;
+    store(slot, waveform);
+    return slot;
+}
+
+void WaveformGenerator::SetWaveform(size_t slot, const Waveform& waveform)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (slot >= points.size())
+    {
+        return;
+    }
+    store(slot, waveform);
+}
+
+void WaveformGenerator::SetOffset(size_t slot, double value)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (slot >= points.size())
+    {
+        return;
+    }
+    offset[slot] = value;
+}
+
+void WaveformGenerator::SetGain(size_t slot, double value)
+{
+    {
+        std::lock_guard<std::mutex> serialized(applyMtx);
+        auto builder = opendnp3::UpdateBuilder();
+        if (!rescale(slot, value, builder))
+        {
+            return;
+        }
+        if (apply)
+        {
+            apply(builder.Build());
+        }
+    }
+
+    if (batchListener)
+    {
+        batchListener();
+    }
+}
+
+void WaveformGenerator::SetGain(size_t slot, double value, opendnp3::UpdateBuilder& builder)
+{
+    // Waits for a tick being applied, so it cannot report the old gain after the caller's batch
+    std::lock_guard<std::mutex> serialized(applyMtx);
+    rescale(slot, value, builder);
+}
+
+bool WaveformGenerator::rescale(size_t slot, double value, opendnp3::UpdateBuilder& builder)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (slot >= points.size())
+    {
+        return false;
+    }
+    gain[slot] = value;
+
+    // Before the first tick there is no signal to rescale: the tick reports the point
+    if (!computed)
+    {
+        return false;
+    }
+    points[slot]->Write(values[slot] * value, builder);
+    return true;
+}
+
+void WaveformGenerator::Pin(size_t slot, double value)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (slot >= points.size())
+    {
+        return;
+    }
+    store(slot, Waveform::Constant(value));
+    gain[slot] = 1.0;
+}
+
+std::optional<size_t> WaveformGenerator::Find(const Analog* point)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = slots.find(point);
+    if (it == slots.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+size_t WaveformGenerator::Size()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return points.size();
+}
+
+void WaveformGenerator::store(size_t slot, const Waveform& waveform)
+{
+    bool wasSine = (sineAmplitude[slot] != 0.0);
+    bool wasRandom = isRandom(walkSigma[slot], noiseSigma[slot], uniformNoise[slot]);
+
+    offset[slot] = waveform.offset;
+    sineAmplitude[slot] = waveform.sineAmplitude;
+    sineOmega[slot] = (waveform.sinePeriod > 0) ? TWO_PI / waveform.sinePeriod : 0.0;
+    sinePhase[slot] = waveform.sinePhase;
+    rampRate[slot] = waveform.rampRate;
+    stepTime[slot] = waveform.stepTime;
+    stepHeight[slot] = waveform.stepHeight;
+    walkSigma[slot] = waveform.walkSigma;
+    walkState[slot] = 0.0;
+    noiseSigma[slot] = waveform.noiseSigma;
+    uniformNoise[slot] = waveform.uniformNoise;
+
+    bool nowSine = (sineAmplitude[slot] != 0.0);
+    if (wasSine && !nowSine)
+    {
+        sineSlots--;
+    }
+    else if (!wasSine && nowSine)
+    {
+        sineSlots++;
+    }
+
+    bool nowRandom = isRandom(walkSigma[slot], noiseSigma[slot], uniformNoise[slot]);
+    if (wasRandom && !nowRandom)
+    {
+        randomSlots--;
+    }
+    else if (!wasRandom && nowRandom)
+    {
+        randomSlots++;
+    }
+}
+
+void WaveformGenerator::SetSeed(uint64_t value)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    seed = value;
+    counter = 0;
+}
+
+void WaveformGenerator::SetInterval(std::chrono::milliseconds value)
+{
+    interval = value;
+}
+
+void WaveformGenerator::SetBatchListener(std::function<void()> listener)
+{
+    batchListener = std::move(listener);
+}
+
+void WaveformGenerator::Start(ApplyFunction applyFunction)
+{
+    Stop();
+    apply = std::move(applyFunction);
+    startTime = scheduler->Now();
+    tickTask = scheduler->SchedulePeriodic(interval, [this]() { Tick(); });
+}
+
+void WaveformGenerator::Stop()
+{
+    scheduler->Cancel(tickTask);
+    tickTask = Scheduler::INVALID_TASK;
+}
+
+void WaveformGenerator::fillRandom(size_t n)
+{
+    // Three counters per point per tick: two for a pair of normals (Box-Muller), one for a uniform.
+    uint64_t base = seed + counter * 0x9E3779B97F4A7C15ULL;
+    counter += 3 * n;
+
+    double* a = normalA.data();
+    double* b = normalB.data();
+    double* u = uniform.data();
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t c = base + 3 * i * 0x9E3779B97F4A7C15ULL;
+        double u1 = toUnit(mix(c));
+        double u2 = toUnit(mix(c + 0x9E3779B97F4A7C15ULL));
+        u[i] = toUnit(mix(c + 2 * 0x9E3779B97F4A7C15ULL)) * 2.0 - 1.0;
+
+        double r = std::sqrt(-2.0 * std::log(u1));
+        a[i] = r * std::cos(TWO_PI * u2);
+        b[i] = r * std::sin(TWO_PI * u2);
+    }
+}
+
+void WaveformGenerator::compute(double t, double* out)
+{
+    const size_t n = points.size();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        out[i] = offset[i] + rampRate[i] * t;
+    }
+
+    if (sineSlots > 0)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i] += sineAmplitude[i] * std::sin(sineOmega[i] * t + sinePhase[i]);
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        out[i] += (t >= stepTime[i]) ? stepHeight[i] : 0.0;
+    }
+
+    if (randomSlots > 0)
+    {
+        fillRandom(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            walkState[i] += walkSigma[i] * normalB[i];
+            out[i] += walkState[i] + noiseSigma[i] * normalA[i] + uniformNoise[i] * uniform[i];
+        }
+    }
+}
+
+void WaveformGenerator::Tick()
+{
+    {
+        std::lock_guard<std::mutex> serialized(applyMtx);
+        auto builder = opendnp3::UpdateBuilder();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (points.empty())
+            {
+                return;
+            }
+
+            auto t = std::chrono::duration<double>(scheduler->Now() - startTime).count();
+            compute(t, values.data());
+            computed = true;
+
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                points[i]->Write(values[i] * gain[i], builder);
+            }
+        }
+
+        if (apply)
+        {
+            apply(builder.Build());
+        }
+    }
+
+    if (batchListener)
+    {
+        batchListener();
+    }
+}
@@ -0,0 +1,143 @@
+#ifndef CALDERADNP3_OUTSTATION_WAVEFORM_H
+#define CALDERADNP3_OUTSTATION_WAVEFORM_H
+
+#include "outstation/scheduler.h"
+#include "outstation/types.h"
+
+#include <opendnp3/outstation/UpdateBuilder.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Waveform describes an analog signal as the sum of its components.
+ *
+ * Components left at zero contribute nothing, so a single Waveform can be
+ * a constant, a sine, a ramp, a step, a random walk, noise, or any
+ * composite of those. Time is measured in seconds of simulation time since
+ * the generator started.
+ */
+struct Waveform
+{
+    double offset = 0.0;
+
+    double sineAmplitude = 0.0;
+    double sinePeriod = 1.0; // seconds
+    double sinePhase = 0.0;  // radians
+
+    double rampRate = 0.0; // units per second
+
+    double stepTime = 0.0; // seconds
+    double stepHeight = 0.0;
+
+    double walkSigma = 0.0;     // standard deviation of each random walk step
+    double noiseSigma = 0.0;    // standard deviation of Gaussian noise
+    double uniformNoise = 0.0;  // half-width of uniform noise
+
+    static Waveform Constant(double value);
+    static Waveform Sine(double offset, double amplitude, double period);
+    static Waveform Ramp(double offset, double rate);
+    static Waveform Step(double offset, double height, double time);
+    static Waveform RandomWalk(double offset, double sigma);
+    static Waveform Noise(double offset, double sigma);
+};
+
+/**
+ * WaveformGenerator computes every generated Analog point in one batch per tick.
+ *
+ * Waveform parameters are stored as one contiguous array per component
+ * (structure of arrays) and each component is evaluated in its own loop
+ * over all points, so the loops are free of branches and per-point calls
+ * and can be vectorized by the compiler. Noise is drawn from a seeded,
+ * counter-based generator, making a run reproducible for a given seed.
+ * The resulting values are pushed to the outstation in a single Apply.
+ *
+ * Points are written with the generator's mutex held. A gain change writes
+ * the last computed signal of the point at its new gain, into the batch of
+ * the caller when it passes one. Batches are built and applied under a
+ * second lock, so a tick built at the old gain is applied before the gain
+ * changes and never overwrites the rescaled value.
+ */
+class WaveformGenerator
+{
+public:
+    using ApplyFunction = std::function<void(const opendnp3::Updates&)>;
+
+    explicit WaveformGenerator(std::shared_ptr<Scheduler> scheduler);
+    ~WaveformGenerator();
+    static std::shared_ptr<WaveformGenerator> Create(std::shared_ptr<Scheduler> scheduler);
+
+    size_t Add(std::shared_ptr<Analog> point, const Waveform& waveform);
+    void SetWaveform(size_t slot, const Waveform& waveform);
+    void SetOffset(size_t slot, double offset);
+    // Reported at the new gain right away once a value was computed, instead of on the next tick: in a
+    // batch of its own, or in the given batch, e.g. with the breaker status change that caused it
+    void SetGain(size_t slot, double gain);
+    void SetGain(size_t slot, double gain, opendnp3::UpdateBuilder& builder);
+    // Holds the point at a constant value, ignoring its gain, until its waveform or gain is set again
+    void Pin(size_t slot, double value);
+    std::optional<size_t> Find(const Analog* point);
+    size_t Size();
+
+    void SetSeed(uint64_t seed);
+    void SetInterval(std::chrono::milliseconds interval);
+    void SetBatchListener(std::function<void()> listener);
+
+    void Start(ApplyFunction apply);
+    void Stop();
+
+    void Tick();
+
+private:
+    std::shared_ptr<Scheduler> scheduler;
+    std::chrono::milliseconds interval{1000};
+    Scheduler::TaskId tickTask = Scheduler::INVALID_TASK;
+    Scheduler::Clock::time_point startTime;
+    ApplyFunction apply;
+    std::function<void()> batchListener;
+
+    std::mutex applyMtx; // held while a batch of the generator is built and applied, taken before mtx
+    std::mutex mtx;
+    std::vector<std::shared_ptr<Analog>> points;
+    std::unordered_map<const Analog*, size_t> slots;
+
+    std::vector<double> offset;
+    std::vector<double> sineAmplitude;
+    std::vector<double> sineOmega;
+    std::vector<double> sinePhase;
+    std::vector<double> rampRate;
+    std::vector<double> stepTime;
+    std::vector<double> stepHeight;
+    std::vector<double> walkSigma;
+    std::vector<double> walkState;
+    std::vector<double> noiseSigma;
+    std::vector<double> uniformNoise;
+    std::vector<double> gain;
+
+    std::vector<double> values; // the signal of each point before its gain, as last computed
+    std::vector<double> normalA;
+    std::vector<double> normalB;
+    std::vector<double> uniform;
+
+    uint64_t seed = 0;
+    uint64_t counter = 0;
+    size_t sineSlots = 0;
+    size_t randomSlots = 0;
+    bool computed = false;
+
+    void store(size_t slot, const Waveform& waveform);
+    void fillRandom(size_t n);
+    // Computes the signals of all points at time t (seconds), before their gain, into out, which must hold
+    // Size() values. Advances the random walks, so it is only called by Tick, with mtx held.
+    void compute(double t, double* out);
+    // Stores the gain and writes the point at it into builder, if a value was computed; applyMtx is held
+    bool rescale(size_t slot, double gain, opendnp3::UpdateBuilder& builder);
+};
+
+#endif // CALDERADNP3_OUTSTATION_WAVEFORM_H
@@ -0,0 +1,53 @@
+#include "ui/device_view.h"
+
+#include "ui/trend.h"
+
+using namespace ftxui;
+
+namespace
+{
+Element tile(const std::string& name, const IDevice& device, Element state, const std::string& model)
+{
+    // Inside the border, the trend line spans the tile; it stays blank until an input point is assigned
+    const size_t width = DeviceView::TILE_WIDTH - 2;
+    const auto* input = device.GetInputPoint();
+    auto trend = text(input ? TrendLine(*input, width) : std::string(width, ' ')) | color(Color::Blue);
+    return window(text(name), vbox({std::move(state) | color(Color::Red), trend, paragraph(model)}))
+        | size(WIDTH, EQUAL, DeviceView::TILE_WIDTH) | size(HEIGHT, EQUAL, DeviceView::TILE_HEIGHT) | notflex;
+}
+} // namespace
+
+Element DeviceView::Render(IDevice& device)
+{
+    DeviceView view;
+    device.Accept(view);
+    return view.element;
+}
+
+void DeviceView::Visit(SimpleDevice& device)
+{
+    element = tile(device.GetName(), device, gauge(device.IsOn() ? 1 : 0), "Latch Model");
+}
+
+void DeviceView::Visit(Breaker& device)
+{
+    std::string model = TwoSignalControlModelSpec::to_human_string(device.GetModel());
+    element = tile(device.GetName(), device, gauge(device.IsClosed() ? 1 : 0), model);
+}
+
+void DeviceView::Visit(SlowDevice& device)
+{
+    std::string model = TwoSignalControlModelSpec::to_human_string(device.GetModel());
+    auto fill = static_cast<float>(device.Position());
+    element = tile(device.GetName(), device, gauge(fill), model);
+}
+
+void DeviceView::Visit(SetpointController& device)
+{
+    std::string model = "Analog Output (Double64)";
+    if (device.IsReadOnly())
+    {
+        model = "Read-Only";
+    }
+    element = tile(device.GetName(), device, text(std::to_string(device.Read())), model);
+}
@@ -0,0 +1,32 @@
+#ifndef CALDERADNP3_OUTSTATION_DEVICE_VIEW_H
+#define CALDERADNP3_OUTSTATION_DEVICE_VIEW_H
+
+#include "outstation/devices.h"
+
+#include <ftxui/dom/elements.hpp>
+
+/**
+ * DeviceView renders the System View tile of any device.
+ *
+ * Every tile has the same size, so the System View lays them out as a grid.
+ * Below the state, a trend line shows the latest changes of the device's
+ * input point.
+ */
+class DeviceView : public DeviceVisitor
+{
+private:
+    ftxui::Element element;
+
+public:
+    static constexpr int TILE_WIDTH = 18;
+    static constexpr int TILE_HEIGHT = 6; // the border, the state, the trend and two lines of model
+
+    static ftxui::Element Render(IDevice& device);
+
+    void Visit(SimpleDevice& device) override;
+    void Visit(Breaker& device) override;
+    void Visit(SlowDevice& device) override;
+    void Visit(SetpointController& device) override;
+};
+
+#endif // CALDERADNP3_OUTSTATION_DEVICE_VIEW_H
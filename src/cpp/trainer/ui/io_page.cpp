@@ -1,12 +1,47 @@
 #include "ui/io_page.h"
 
+#include <algorithm>
+#include <cctype>
+
 using namespace ftxui;
 
+namespace
+{
+// Point references are an index of at most five digits, typed alone or after a point type (dbi:65535)
+bool is_reference_char(const Event& event, const std::string& typed)
+{
+    auto c = static_cast<unsigned char>(event.character()[0]);
+    return (std::isdigit(c) || std::islower(c) || (c == ':')) && (typed.size() < 9);
+}
+
+// Parses N, matched against every row, or a typed reference such as ao:3
+bool parse_reference(const std::string& text, PointType& type, uint16_t& index)
+{
+    auto colon = text.find(':');
+    auto digits = (colon == std::string::npos) ? text : text.substr(colon + 1);
+    type = (colon == std::string::npos) ? PointType::UNDEFINED : PointTypeSpec::from_string(text.substr(0, colon));
+    auto is_digit = [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; };
+    if (digits.empty() || (digits.size() > 5) || !std::all_of(digits.begin(), digits.end(), is_digit)
+        || ((colon != std::string::npos) && (type == PointType::UNDEFINED)))
+    {
+        return false;
+    }
+    auto value = std::stoul(digits);
+    index = static_cast<uint16_t>(value);
+    return value <= UINT16_MAX;
+}
+} // namespace
+
 std::shared_ptr<IOPage> IOPage::Create()
 {
     return std::make_shared<IOPage>();
 }
 
+size_t IOPage::num_rows() const
+{
+    return std::max(view->NumInputs(), view->NumOutputs());
+}
+
 Element IOPage::Render()
 {
     if (!io_table)
@@ -14,6 +49,11 @@ Element IOPage::Render()
         return vbox() | border | flex;
     }
 
+    // The menu, page border, table titles, table borders and header, separators between
+    // the three input types, scroll indicator and status bar take 14 rows
+    page = static_cast<size_t>(std::max(Terminal::Size().dimy - 14, 1));
+    first = std::min(first, (num_rows() > page) ? num_rows() - page : 0);
+
     auto box_color = color(Color::Default);
     if (Focused())
     {
@@ -22,20 +62,112 @@ Element IOPage::Render()
 
     auto inputs = vbox({
                       text("Inputs"),
-                      io_table->RenderInputs(),
+                      view->RenderInputs(first, page),
                   })
         | color(Color::Default);
 
     auto outputs = vbox({
                        text("Outputs"),
-                       io_table->RenderOutputs(),
+                       view->RenderOutputs(first, page),
                    })
         | color(Color::Default);
 
-    auto tables = hbox({inputs, separatorEmpty(), outputs}) | focusPositionRelative(x_focus, y_focus)
-        | vscroll_indicator | frame | flex;
+    auto tables = hbox({inputs, separatorEmpty(), outputs}) | focusPositionRelative(x_focus, 0.0f) | frame | flex;
+
+    return vbox({tables, hscroll_indicator(), status_bar()}) | border | box_color | flex;
+}
+
+Element IOPage::status_bar()
+{
+    auto rows = num_rows();
+    auto shown = std::to_string(std::min(first + 1, rows)) + "-" + std::to_string(std::min(first + page, rows));
+
+    Elements items = {
+        text("rows " + shown + " of " + std::to_string(view->NumInputs()) + " inputs, "
+             + std::to_string(view->NumOutputs()) + " outputs"),
+        text("  filter: "),
+        (prompt == Prompt::FILTER) ? text(filter) | underlined : text(filter),
+    };
+    if (prompt == Prompt::JUMP)
+    {
+        items.push_back(text("  point: "));
+        items.push_back(text(jump) | underlined);
+    }
+    if (!error.empty())
+    {
+        items.push_back(text("  " + error) | color(Color::Red));
+    }
+    return hbox(std::move(items)) | dim;
+}
+
+bool IOPage::on_prompt_event(Event event)
+{
+    auto& typed = (prompt == Prompt::FILTER) ? filter : jump;
+
+    if (event == ftxui::Event::Escape)
+    {
+        typed.clear();
+    }
+    else if (event == ftxui::Event::Backspace)
+    {
+        if (!typed.empty())
+        {
+            typed.pop_back();
+        }
+    }
+    else if (event.is_character() && (prompt == Prompt::FILTER || is_reference_char(event, typed)))
+    {
+        typed += event.character();
+    }
+    else if (event != ftxui::Event::Return)
+    {
+        return true;
+    }
+
+    if (prompt == Prompt::FILTER)
+    {
+        // Names do not change, so the rows are selected again only when the filter does
+        view->SetFilter(filter);
+        first = 0;
+    }
+    else if (event == ftxui::Event::Return && !jump.empty())
+    {
+        auto type = PointType::UNDEFINED;
+        uint16_t index = 0;
+        std::optional<size_t> position;
+        if (!parse_reference(jump, type, index))
+        {
+            error = "bad point " + jump;
+        }
+        else if (type != PointType::UNDEFINED)
+        {
+            position = view->Find(type, index);
+        }
+        else
+        {
+            position = view->FindInput(index);
+            if (!position)
+            {
+                position = view->FindOutput(index);
+            }
+        }
+
+        if (position)
+        {
+            first = position.value();
+        }
+        else if (error.empty())
+        {
+            error = "no point " + jump;
+        }
+        jump.clear();
+    }
 
-    return vbox({tables, hscroll_indicator()}) | border | box_color | flex;
+    if (event == ftxui::Event::Return || event == ftxui::Event::Escape)
+    {
+        prompt = Prompt::NONE;
+    }
+    return true;
 }
 
 bool IOPage::OnEvent(Event event)
@@ -44,18 +176,36 @@ bool IOPage::OnEvent(Event event)
     {
         return false;
     }
+    if (prompt != Prompt::NONE)
+    {
+        return on_prompt_event(event);
+    }
 
+    size_t start_first = first;
     float start_x_focus = x_focus;
-    float start_y_focus = y_focus;
+    auto last = (num_rows() > page) ? num_rows() - page : 0;
 
-    // Use arrows or vim motions to navigate logs
-    if ((event == ftxui::Event::ArrowUp || event == ftxui::Event::Character('k')) && y_focus > 0.1f)
+    if (event == ftxui::Event::Character('/'))
     {
-        y_focus = y_focus - 0.1f;
+        prompt = Prompt::FILTER;
+        error.clear();
+        return true;
     }
-    if ((event == ftxui::Event::ArrowDown || event == ftxui::Event::Character('j')) && y_focus < 1.0f)
+    if (event == ftxui::Event::Character(':'))
     {
-        y_focus = y_focus + 0.1f;
+        prompt = Prompt::JUMP;
+        error.clear();
+        return true;
+    }
+
+    // Use arrows or vim motions to navigate the tables
+    if ((event == ftxui::Event::ArrowUp || event == ftxui::Event::Character('k')) && first > 0)
+    {
+        first--;
+    }
+    if ((event == ftxui::Event::ArrowDown || event == ftxui::Event::Character('j')) && first < last)
+    {
+        first++;
     }
     if ((event == ftxui::Event::ArrowLeft || event == ftxui::Event::Character('h')) && x_focus > 0.1f)
     {
@@ -65,15 +215,27 @@ bool IOPage::OnEvent(Event event)
     {
         x_focus = x_focus + 0.1f;
     }
+    if (event == ftxui::Event::PageUp)
+    {
+        first = (first > page) ? first - page : 0;
+    }
+    if (event == ftxui::Event::PageDown)
+    {
+        first = std::min(first + page, last);
+    }
+    if (event == ftxui::Event::Home || event == ftxui::Event::Character('g'))
+    {
+        first = 0;
+    }
 
-    // Jump to newest (last) line on Enter
-    if (event == ftxui::Event::Return)
+    // Jump to the last rows on Enter
+    if (event == ftxui::Event::End || event == ftxui::Event::Character('G') || event == ftxui::Event::Return)
     {
+        first = last;
         x_focus = 0.0f;
-        y_focus = 1.0f;
     }
 
-    return (x_focus != start_x_focus) || (y_focus != start_y_focus);
+    return (first != start_first) || (x_focus != start_x_focus);
 }
 
 Element IOPage::hscroll_indicator()
@@ -91,6 +253,12 @@ Element IOPage::hscroll_indicator()
 void IOPage::RegisterIOTable(std::shared_ptr<IOTable> io_table)
 {
     this->io_table = io_table;
+    view = std::make_unique<IOTableView>(*io_table);
+}
+
+bool IOPage::Editing() const
+{
+    return prompt != Prompt::NONE;
 }
 
 bool IOPage::Focusable() const
@@ -100,4 +268,4 @@ bool IOPage::Focusable() const
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
@@ -2,17 +2,46 @@
 #define CALDERADNP3_OUTSTATION_IO_PAGE_H
 
 #include "outstation/io_table.h"
+#include "ui/io_table_view.h"
 
 #include <ftxui/component/component.hpp>
 
 #include <memory>
+#include <string>
 
+/**
+ * IOPage shows the points of an IOTable a page at a time.
+ *
+ * j/k and Page Up/Down scroll the input and output tables together, g/G go
+ * to their start and end. / filters the points by name as it is typed and
+ * : jumps to a point, typed and then confirmed with Enter; Esc clears what
+ * was typed. A point is either a typed reference (bi:N, dbi:N, ai:N, bo:N,
+ * ao:N) or an index alone, which goes to the first row with that index.
+ */
 class IOPage : public ftxui::ComponentBase
 {
 private:
+    enum class Prompt
+    {
+        NONE,
+        FILTER,
+        JUMP
+    };
+
     std::shared_ptr<IOTable> io_table = nullptr;
+    std::unique_ptr<IOTableView> view = nullptr;
+    size_t first = 0; // position of the first row shown
+    size_t page = 1;  // number of rows shown when last rendered
     float x_focus = 0.0f;
-    float y_focus = 0.0f;
+
+    Prompt prompt = Prompt::NONE;
+    std::string filter;
+    std::string jump;
+    std::string error;
+
+    size_t num_rows() const;
+    bool on_prompt_event(ftxui::Event event);
+    ftxui::Element status_bar();
     ftxui::Element hscroll_indicator();
 
 public:
@@ -22,6 +51,7 @@ public:
     bool Focusable() const final;
     bool OnEvent(ftxui::Event event) override;
     void RegisterIOTable(std::shared_ptr<IOTable> io_table);
+    bool Editing() const;
 };
 
-#endif // CALDERADNP3_OUTSTATION_IO_PAGE_H
\ No newline at end of file
+#endif // CALDERADNP3_OUTSTATION_IO_PAGE_H
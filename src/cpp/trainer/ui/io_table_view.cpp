@@ -0,0 +1,212 @@
+#include "ui/io_table_view.h"
+
+#include "ui/trend.h"
+
+#include <ftxui/dom/table.hpp>
+
+#include <algorithm>
+
+namespace
+{
+// Renders rows as a table below a header, with a border wherever the point type changes
+template<class Cells>
+ftxui::Element render_table(std::vector<std::string> header, const std::vector<EventType>& types, Cells cells)
+{
+    std::vector<std::vector<std::string>> data;
+    data.push_back(std::move(header));
+    for (size_t r = 0; r < types.size(); ++r)
+    {
+        data.push_back(cells(r));
+    }
+
+    auto table = ftxui::Table(data);
+
+    // Add border around full table
+    table.SelectAll().Border(ftxui::LIGHT);
+
+    // Add border between point types
+    for (size_t r = 1; r < types.size(); ++r)
+    {
+        if (types[r] != types[r - 1])
+        {
+            table.SelectRows(0, static_cast<int>(r)).Border(ftxui::LIGHT);
+        }
+    }
+
+    // Decorate header row
+    table.SelectRow(0).Decorate(ftxui::bold);
+    table.SelectRow(0).SeparatorVertical(ftxui::LIGHT);
+    table.SelectRow(0).Border(ftxui::DOUBLE);
+
+    return table.Render();
+}
+} // namespace
+
+IOTableView::IOTableView(const IOTable& io_table)
+{
+    auto add = [](std::vector<Row>& rows, const auto& points, EventType type) {
+        for (const auto& point : points)
+        {
+            auto index = point->GetIndex();
+            if (!index.has_value())
+            {
+                continue;
+            }
+
+            // The version is one behind, so the value is formatted when the row is first shown
+            rows.push_back({point.get(),
+                            type,
+                            std::to_string(point->GetStaticGroup()),
+                            std::to_string(index.value()),
+                            index.value(),
+                            point->GetVersion() - 1,
+                            "",
+                            ""});
+        }
+    };
+
+    add(inputs, io_table.GetBinaryInputs(), EventType::BINARY);
+    add(inputs, io_table.GetDoubleBitInputs(), EventType::DOUBLE_BIT);
+    add(inputs, io_table.GetAnalogInputs(), EventType::ANALOG);
+    add(outputs, io_table.GetBinaryOutputs(), EventType::BINARY);
+    add(outputs, io_table.GetAnalogOutputs(), EventType::ANALOG);
+
+    SetFilter("");
+}
+
+void IOTableView::SetFilter(const std::string& text)
+{
+    auto select = [&text](const std::vector<Row>& rows, std::vector<size_t>& shown) {
+        shown.clear();
+        for (size_t r = 0; r < rows.size(); ++r)
+        {
+            if (text.empty() || rows[r].point->GetName().find(text) != std::string::npos)
+            {
+                shown.push_back(r);
+            }
+        }
+    };
+
+    select(inputs, shownInputs);
+    select(outputs, shownOutputs);
+}
+
+size_t IOTableView::NumInputs() const
+{
+    return shownInputs.size();
+}
+
+size_t IOTableView::NumOutputs() const
+{
+    return shownOutputs.size();
+}
+
+std::optional<size_t> IOTableView::find(const std::vector<Row>& rows,
+                                        const std::vector<size_t>& shown,
+                                        uint16_t index,
+                                        std::optional<EventType> type)
+{
+    for (size_t position = 0; position < shown.size(); ++position)
+    {
+        const auto& row = rows[shown[position]];
+        if ((row.number == index) && (!type || (row.type == type.value())))
+        {
+            return position;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<size_t> IOTableView::FindInput(uint16_t index) const
+{
+    return find(inputs, shownInputs, index);
+}
+
+std::optional<size_t> IOTableView::FindOutput(uint16_t index) const
+{
+    return find(outputs, shownOutputs, index);
+}
+
+std::optional<size_t> IOTableView::Find(PointType type, uint16_t index) const
+{
+    switch (type)
+    {
+    case PointType::BINARY_INPUT:
+        return find(inputs, shownInputs, index, EventType::BINARY);
+    case PointType::DOUBLE_BIT_INPUT:
+        return find(inputs, shownInputs, index, EventType::DOUBLE_BIT);
+    case PointType::ANALOG_INPUT:
+        return find(inputs, shownInputs, index, EventType::ANALOG);
+    case PointType::BINARY_OUTPUT:
+        return find(outputs, shownOutputs, index, EventType::BINARY);
+    case PointType::ANALOG_OUTPUT:
+        return find(outputs, shownOutputs, index, EventType::ANALOG);
+    default:
+        return std::nullopt;
+    }
+}
+
+void IOTableView::refresh(Row& row)
+{
+    auto version = row.point->GetVersion();
+    if (version == row.version)
+    {
+        return;
+    }
+
+    // Read the version first: a change made while formatting is picked up by the next frame
+    row.version = version;
+    row.trend = TrendLine(*row.point, TREND_WIDTH);
+    switch (row.type)
+    {
+    case EventType::BINARY:
+        row.value = static_cast<const Binary*>(row.point)->Read() ? "TRUE" : "FALSE";
+        break;
+    case EventType::DOUBLE_BIT:
+        row.value = opendnp3::DoubleBitSpec::to_human_string(static_cast<const DoubleBit*>(row.point)->Read());
+        break;
+    case EventType::ANALOG:
+        row.value = std::to_string(static_cast<const Analog*>(row.point)->Read());
+        break;
+    default:
+        break;
+    }
+}
+
+ftxui::Element IOTableView::RenderInputs(size_t first, size_t count)
+{
+    auto last = std::min(first + count, shownInputs.size());
+    first = std::min(first, last);
+
+    std::vector<EventType> types;
+    for (auto position = first; position < last; ++position)
+    {
+        auto& row = inputs[shownInputs[position]];
+        refresh(row);
+        types.push_back(row.type);
+    }
+
+    return render_table({"Group", "Index", "Name", "Value", "Trend"}, types, [&](size_t r) {
+        const auto& row = inputs[shownInputs[first + r]];
+        return std::vector<std::string>{row.group, row.index, row.point->GetName(), row.value, row.trend};
+    });
+}
+
+ftxui::Element IOTableView::RenderOutputs(size_t first, size_t count)
+{
+    auto last = std::min(first + count, shownOutputs.size());
+    first = std::min(first, last);
+
+    std::vector<EventType> types;
+    for (auto position = first; position < last; ++position)
+    {
+        auto& row = outputs[shownOutputs[position]];
+        refresh(row);
+        types.push_back(row.type);
+    }
+
+    return render_table({"Index", "Name", "Trend"}, types, [&](size_t r) {
+        const auto& row = outputs[shownOutputs[first + r]];
+        return std::vector<std::string>{row.index, row.point->GetName(), row.trend};
+    });
+}
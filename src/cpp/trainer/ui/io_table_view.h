@@ -0,0 +1,71 @@
+#ifndef CALDERADNP3_OUTSTATION_IO_TABLE_VIEW_H
+#define CALDERADNP3_OUTSTATION_IO_TABLE_VIEW_H
+
+#include "outstation/io_table.h"
+#include "outstation/point_index.h"
+
+#include <ftxui/dom/elements.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * IOTableView renders the input and output point tables of an IOTable.
+ *
+ * The text of every row is built once and kept: when a row is rendered
+ * again its value is only formatted if the version of its point changed.
+ * Each render draws the rows from a position in the table, as many as
+ * asked for, so the cost of a frame does not grow with the number of points.
+ * A filter limits the rows to the points whose name contains a text.
+ * The Trend column shows the latest changes of each point, refreshed with
+ * its value.
+ */
+class IOTableView
+{
+public:
+    static constexpr size_t TREND_WIDTH = 16;
+
+    explicit IOTableView(const IOTable& io_table);
+
+    void SetFilter(const std::string& text);
+    size_t NumInputs() const;
+    size_t NumOutputs() const;
+
+    // Positions of the first input and output rows shown with the given point index
+    std::optional<size_t> FindInput(uint16_t index) const;
+    std::optional<size_t> FindOutput(uint16_t index) const;
+
+    // Position of the row shown for a point of the given type and index, e.g. from ao:3
+    std::optional<size_t> Find(PointType type, uint16_t index) const;
+
+    ftxui::Element RenderInputs(size_t first, size_t count);
+    ftxui::Element RenderOutputs(size_t first, size_t count);
+
+private:
+    struct Row
+    {
+        const IMeasurement* point;
+        EventType type;
+        std::string group;
+        std::string index;
+        uint16_t number;
+        uint32_t version;
+        std::string value;
+        std::string trend;
+    };
+
+    std::vector<Row> inputs;
+    std::vector<Row> outputs;
+    std::vector<size_t> shownInputs;
+    std::vector<size_t> shownOutputs;
+
+    static void refresh(Row& row);
+    static std::optional<size_t> find(const std::vector<Row>& rows,
+                                      const std::vector<size_t>& shown,
+                                      uint16_t index,
+                                      std::optional<EventType> type = std::nullopt);
+};
+
+#endif // CALDERADNP3_OUTSTATION_IO_TABLE_VIEW_H
@@ -0,0 +1,293 @@
+#include "ui/log_buffer.h"
+
+// LogBuffer
+
+LogBuffer::LogBuffer(size_t capacity) : capacity(std::max<size_t>(capacity, 1)) {}
+
+void LogBuffer::Push(const char* id, opendnp3::LogLevel level, char const* location, char const* message)
+{
+    auto now = std::chrono::system_clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (records.size() < capacity)
+    {
+        records.emplace_back();
+        records.back().Capture(now, id, level, location, message);
+    }
+    else
+    {
+        records[first].Capture(now, id, level, location, message);
+        first = (first + 1) % capacity;
+    }
+    end++;
+}
+
+void LogBuffer::SetCapacity(size_t size)
+{
+    size = std::max<size_t>(size, 1);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Keep the newest records, oldest first so the buffer can grow again
+    std::vector<LogRecord> kept;
+    auto count = std::min<uint64_t>(records.size(), size);
+    kept.reserve(count);
+    for (auto id = end - count; id < end; ++id)
+    {
+        kept.push_back(std::move(records[index(id)]));
+    }
+
+    records = std::move(kept);
+    capacity = size;
+    first = 0;
+}
+
+size_t LogBuffer::GetCapacity() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return capacity;
+}
+
+std::pair<uint64_t, uint64_t> LogBuffer::Range() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return {end - records.size(), end};
+}
+
+std::vector<std::string> LogBuffer::Format(const std::vector<uint64_t>& ids) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto oldest = end - records.size();
+
+    // Records overwritten since their ids were taken are left blank
+    std::vector<std::string> lines(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        if (ids[i] >= oldest && ids[i] < end)
+        {
+            lines[i] = FormatLogRecord(records[index(ids[i])]);
+        }
+    }
+    return lines;
+}
+
+size_t LogBuffer::index(uint64_t id) const
+{
+    return (first + (id - (end - records.size()))) % records.size();
+}
+
+void LogBuffer::copy_to(std::vector<std::pair<uint64_t, LogRecord>>& chunk, size_t n, uint64_t id) const
+{
+    if (n < chunk.size())
+    {
+        chunk[n].first = id;
+        chunk[n].second = records[index(id)];
+        return;
+    }
+    chunk.emplace_back(id, records[index(id)]);
+}
+
+// LogFilter
+
+bool LogFilter::Active() const
+{
+    return level.has_value() || id.has_value() || !text.empty();
+}
+
+// LogIndex
+
+LogIndex::LogIndex(std::shared_ptr<LogBuffer> buffer) : buffer(std::move(buffer)) {}
+
+void LogIndex::Sync()
+{
+    auto [oldest, end] = buffer->Range();
+    prune(oldest);
+
+    bool selective = filter.level.has_value() || filter.id.has_value();
+    buffer->VisitRange(std::max(indexed, oldest), end, [&](uint64_t id, const LogRecord& record) {
+        byLevel.try_emplace(record.level.value, LevelIds{record.level, {}}).first->second.ids.push_back(id);
+        byId[record.id].push_back(id);
+
+        if (!filter.Active() || !selects(record))
+        {
+            return;
+        }
+        if (selective)
+        {
+            candidates.push_back(id);
+        }
+        if (pattern)
+        {
+            if (std::regex_search(record.message, *pattern))
+            {
+                searches.back().matches.push_back(id);
+            }
+            return;
+        }
+
+        // A message containing a text contains the shorter texts it extends
+        for (auto search = searches.size(); search > 0; --search)
+        {
+            if (record.message.find(searches[search - 1].text) != std::string::npos)
+            {
+                for (size_t s = 0; s < search; ++s)
+                {
+                    searches[s].matches.push_back(id);
+                }
+                break;
+            }
+        }
+    });
+    indexed = end;
+}
+
+void LogIndex::SetFilter(const LogFilter& next)
+{
+    std::optional<std::regex> compiled;
+    if (next.regex && !next.text.empty())
+    {
+        compiled.emplace(next.text, std::regex::ECMAScript | std::regex::optimize);
+    }
+
+    auto [oldest, end] = buffer->Range();
+    prune(oldest);
+
+    bool refine = (next.level == filter.level) && (next.id == filter.id) && !next.regex && !filter.regex;
+    if (!refine)
+    {
+        candidates = select_candidates_of(next);
+        searches.clear();
+    }
+
+    // Erasing characters goes back to the matches of a text typed before
+    while (!searches.empty() && (next.text.find(searches.back().text) == std::string::npos))
+    {
+        searches.pop_back();
+    }
+
+    filter = next;
+    pattern = std::move(compiled);
+    if (filter.text.empty() || (!searches.empty() && searches.back().text == filter.text))
+    {
+        return;
+    }
+
+    Search search{filter.text, {}};
+    auto visit = [&](uint64_t id, const LogRecord& record) {
+        bool match = pattern ? std::regex_search(record.message, *pattern)
+                             : (record.message.find(search.text) != std::string::npos);
+        if (match)
+        {
+            search.matches.push_back(id);
+        }
+    };
+    if (!searches.empty())
+    {
+        buffer->VisitIds(searches.back().matches, visit);
+    }
+    else if (filter.level || filter.id)
+    {
+        buffer->VisitIds(candidates, visit);
+    }
+    else
+    {
+        buffer->VisitRange(oldest, indexed, visit);
+    }
+    searches.push_back(std::move(search));
+}
+
+const LogFilter& LogIndex::GetFilter() const
+{
+    return filter;
+}
+
+const std::deque<uint64_t>& LogIndex::Matches() const
+{
+    return searches.empty() ? candidates : searches.back().matches;
+}
+
+std::vector<std::pair<uint32_t, opendnp3::LogLevel>> LogIndex::GetLevels() const
+{
+    std::vector<std::pair<uint32_t, opendnp3::LogLevel>> levels;
+    for (const auto& [value, entry] : byLevel)
+    {
+        levels.emplace_back(value, entry.level);
+    }
+    return levels;
+}
+
+std::vector<std::string> LogIndex::GetIds() const
+{
+    std::vector<std::string> ids;
+    for (const auto& [id, entries] : byId)
+    {
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+bool LogIndex::selects(const LogRecord& record) const
+{
+    return (!filter.level || record.level.value == *filter.level) && (!filter.id || record.id == *filter.id);
+}
+
+std::deque<uint64_t> LogIndex::select_candidates_of(const LogFilter& next) const
+{
+    const std::deque<uint64_t>* levelIds = nullptr;
+    const std::deque<uint64_t>* idIds = nullptr;
+    static const std::deque<uint64_t> none;
+
+    if (next.level)
+    {
+        auto entry = byLevel.find(*next.level);
+        levelIds = (entry != byLevel.end()) ? &entry->second.ids : &none;
+    }
+    if (next.id)
+    {
+        auto entry = byId.find(*next.id);
+        idIds = (entry != byId.end()) ? &entry->second : &none;
+    }
+
+    if (levelIds && idIds)
+    {
+        std::deque<uint64_t> both;
+        std::set_intersection(
+            levelIds->begin(), levelIds->end(), idIds->begin(), idIds->end(), std::back_inserter(both));
+        return both;
+    }
+    if (levelIds)
+    {
+        return *levelIds;
+    }
+    if (idIds)
+    {
+        return *idIds;
+    }
+    return {};
+}
+
+void LogIndex::prune(uint64_t oldest)
+{
+    auto drop = [oldest](std::deque<uint64_t>& ids) {
+        while (!ids.empty() && ids.front() < oldest)
+        {
+            ids.pop_front();
+        }
+    };
+
+    for (auto it = byLevel.begin(); it != byLevel.end();)
+    {
+        drop(it->second.ids);
+        it = it->second.ids.empty() ? byLevel.erase(it) : std::next(it);
+    }
+    for (auto it = byId.begin(); it != byId.end();)
+    {
+        drop(it->second);
+        it = it->second.empty() ? byId.erase(it) : std::next(it);
+    }
+    drop(candidates);
+    for (auto& search : searches)
+    {
+        drop(search.matches);
+    }
+}
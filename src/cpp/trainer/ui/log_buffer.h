@@ -0,0 +1,186 @@
+#ifndef CALDERADNP3_OUTSTATION_LOG_BUFFER_H
+#define CALDERADNP3_OUTSTATION_LOG_BUFFER_H
+
+#include "logger.hpp"
+
+#include <opendnp3/logging/LogLevels.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * LogBuffer keeps the latest log records, up to a fixed capacity.
+ *
+ * Records are numbered from 0 as they are pushed and keep their id while
+ * they are buffered, so the oldest ones are overwritten without renumbering
+ * the others. Loggers push from the DNP3 threads and the UI reads, so every
+ * access takes the buffer's lock, and visitors only ever see copies.
+ */
+class LogBuffer
+{
+private:
+    static constexpr size_t VISIT_CHUNK = 4096;
+
+    std::vector<LogRecord> records;
+    size_t capacity;
+    size_t first = 0; // index of the oldest record once the buffer is full
+    uint64_t end = 0;
+    mutable std::mutex mutex;
+
+    size_t index(uint64_t id) const;
+
+    // Copies a record into slot n of a chunk, reusing the strings of the previous chunk; takes no lock
+    void copy_to(std::vector<std::pair<uint64_t, LogRecord>>& chunk, size_t n, uint64_t id) const;
+
+public:
+    explicit LogBuffer(size_t capacity);
+
+    void Push(const char* id, opendnp3::LogLevel level, char const* location, char const* message);
+    void SetCapacity(size_t capacity);
+    size_t GetCapacity() const;
+
+    // Ids of the oldest record kept and of the next record pushed
+    std::pair<uint64_t, uint64_t> Range() const;
+
+    // Formats the records with the given ids, leaving those no longer buffered blank
+    std::vector<std::string> Format(const std::vector<uint64_t>& ids) const;
+
+    // Calls visit(id, record) for the records from id begin up to end which are still buffered.
+    // Records are copied a few thousand at a time under the lock and visited after releasing it,
+    // so a slow visitor, e.g. a regular expression, does not hold up the loggers.
+    template<class Visit> void VisitRange(uint64_t begin, uint64_t end, Visit&& visit) const
+    {
+        std::vector<std::pair<uint64_t, LogRecord>> chunk;
+        while (begin < end)
+        {
+            size_t count = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                begin = std::max<uint64_t>(begin, this->end - records.size());
+                auto last = std::min<uint64_t>(end, begin + VISIT_CHUNK);
+                for (; begin < last; ++begin)
+                {
+                    copy_to(chunk, count++, begin);
+                }
+            }
+            for (size_t n = 0; n < count; ++n)
+            {
+                visit(chunk[n].first, chunk[n].second);
+            }
+        }
+    }
+
+    // The same for a sorted list of ids
+    template<class Ids, class Visit> void VisitIds(const Ids& ids, Visit&& visit) const
+    {
+        std::vector<std::pair<uint64_t, LogRecord>> chunk;
+        auto it = ids.begin();
+        while (it != ids.end())
+        {
+            size_t count = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto oldest = end - records.size();
+                for (size_t n = 0; (n < VISIT_CHUNK) && (it != ids.end()); ++n, ++it)
+                {
+                    if (*it >= oldest)
+                    {
+                        copy_to(chunk, count++, *it);
+                    }
+                }
+            }
+            for (size_t n = 0; n < count; ++n)
+            {
+                visit(chunk[n].first, chunk[n].second);
+            }
+        }
+    }
+};
+
+/**
+ * LogFilter selects the log records shown by the Logs page: those of one
+ * level, one logger id, and whose message contains a text or matches a
+ * regular expression. Criteria left empty select every record.
+ */
+struct LogFilter
+{
+    std::optional<uint32_t> level; // the value of a single level flag
+    std::optional<std::string> id;
+    std::string text;
+    bool regex = false;
+
+    bool Active() const;
+};
+
+/**
+ * LogIndex keeps the ids of the records of a LogBuffer matching a LogFilter.
+ *
+ * Sync indexes the records pushed since it was last called: their ids are
+ * appended to one list per level and one per logger id, and to the matches
+ * of the filter, and the ids of overwritten records are dropped from the
+ * front of every list. Setting a filter scans only the list of its level or
+ * logger id, or the intersection of both.
+ *
+ * Text matches are refined as a search is typed: the matches of each text
+ * typed are kept, so a longer text only scans the matches of the text it
+ * extends and erasing characters restores earlier matches without a scan.
+ * Regular expressions are matched against every candidate record.
+ */
+class LogIndex
+{
+public:
+    explicit LogIndex(std::shared_ptr<LogBuffer> buffer);
+
+    void Sync();
+
+    // Throws std::regex_error when a regular expression does not compile
+    void SetFilter(const LogFilter& filter);
+    const LogFilter& GetFilter() const;
+
+    // Ids of the buffered records matching the filter, oldest first
+    const std::deque<uint64_t>& Matches() const;
+
+    // Levels and logger ids of the buffered records
+    std::vector<std::pair<uint32_t, opendnp3::LogLevel>> GetLevels() const;
+    std::vector<std::string> GetIds() const;
+
+private:
+    struct LevelIds
+    {
+        opendnp3::LogLevel level;
+        std::deque<uint64_t> ids;
+    };
+
+    struct Search
+    {
+        std::string text;
+        std::deque<uint64_t> matches;
+    };
+
+    std::shared_ptr<LogBuffer> buffer;
+    uint64_t indexed = 0; // id of the next record to index
+
+    std::map<uint32_t, LevelIds> byLevel;
+    std::map<std::string, std::deque<uint64_t>> byId;
+
+    LogFilter filter;
+    std::optional<std::regex> pattern;
+    std::deque<uint64_t> candidates; // matches of the level and logger id, when either is set
+    std::vector<Search> searches;    // matches of each text typed, every text extending the previous
+
+    bool selects(const LogRecord& record) const;
+    std::deque<uint64_t> select_candidates_of(const LogFilter& next) const;
+    void prune(uint64_t oldest);
+};
+
+#endif // CALDERADNP3_OUTSTATION_LOG_BUFFER_H
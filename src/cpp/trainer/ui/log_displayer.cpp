@@ -1,83 +1,132 @@
 #include "ui/log_displayer.h"
 
-#include "date/date.h"
+#include <algorithm>
+#include <tuple>
 
 using namespace ftxui;
 
 // TuiLogger
 
-TuiLogger::TuiLogger(ftxui::Sender<std::string> sender, bool printLocation)
-    : sender(std::move(sender)), printLocation(printLocation)
+TuiLogger::TuiLogger(std::shared_ptr<LogBuffer> buffer, bool printLocation)
+    : buffer(std::move(buffer)), printLocation(printLocation)
 {
 }
 
-std::shared_ptr<TuiLogger> TuiLogger::Create(ftxui::Sender<std::string> sender)
+std::shared_ptr<TuiLogger> TuiLogger::Create(std::shared_ptr<LogBuffer> buffer)
 {
-    return std::make_shared<TuiLogger>(std::move(sender), false);
+    return std::make_shared<TuiLogger>(std::move(buffer), false);
 };
 
-std::shared_ptr<TuiLogger> TuiLogger::Create(ftxui::Sender<std::string> sender, bool printLocation)
+std::shared_ptr<TuiLogger> TuiLogger::Create(std::shared_ptr<LogBuffer> buffer, bool printLocation)
 {
-    return std::make_shared<TuiLogger>(std::move(sender), printLocation);
+    return std::make_shared<TuiLogger>(std::move(buffer), printLocation);
 };
 
-void TuiLogger::RegisterScreen(ftxui::ScreenInteractive* screen_ptr)
+void TuiLogger::RegisterRedraws(std::shared_ptr<RedrawCoalescer> coalescer)
 {
-    screen = screen_ptr;
+    redraws = std::move(coalescer);
 }
 
 void TuiLogger::log(
     opendnp3::ModuleId module_id, const char* id, opendnp3::LogLevel level, char const* location, char const* message)
 {
-    using namespace date;
-    std::ostringstream oss;
+    buffer->Push(id, level, printLocation ? location : nullptr, message);
 
-    auto now = std::chrono::system_clock::now();
-    oss << now << "Z ";
-    oss << "[ " << LogFlagToString(level) << "] ";
-    oss << "(" << id << ") ";
-    if (printLocation)
+    if (redraws)
     {
-        oss << location << " ";
+        redraws->Request();
     }
-    oss << message;
+}
 
-    std::unique_lock<std::mutex> lock(mutex);
-    sender->Send(oss.str());
+void TuiLogger::OnStateChange(opendnp3::ChannelState state)
+{
+    auto message = std::string("state change: ") + opendnp3::ChannelStateSpec::to_human_string(state);
+    buffer->Push("channel", opendnp3::flags::INFO, nullptr, message.c_str());
 
-    if (screen)
+    if (redraws)
     {
-        screen->PostEvent(ftxui::Event::Custom);
+        redraws->Request();
     }
 }
 
-void TuiLogger::OnStateChange(opendnp3::ChannelState state)
+// LogDisplayer
+
+std::shared_ptr<LogDisplayer> LogDisplayer::Create()
 {
-    using namespace date;
-    std::ostringstream oss;
+    return std::make_shared<LogDisplayer>();
+}
 
-    auto now = std::chrono::system_clock::now();
-    oss << now << "Z [ INFO   ] (channel) state change: " << opendnp3::ChannelStateSpec::to_human_string(state);
+void LogDisplayer::sync()
+{
+    index.Sync();
+    std::tie(oldest, end) = lines->Range();
+}
 
-    sender->Send(oss.str());
+uint64_t LogDisplayer::view_size() const
+{
+    return index.GetFilter().Active() ? index.Matches().size() : end - oldest;
 }
 
-// LogDisplayer
+uint64_t LogDisplayer::view_id(uint64_t position) const
+{
+    return index.GetFilter().Active() ? index.Matches()[position] : oldest + position;
+}
 
-std::shared_ptr<LogDisplayer> LogDisplayer::Create()
+uint64_t LogDisplayer::view_position(uint64_t id) const
 {
-    return std::make_shared<LogDisplayer>();
+    if (index.GetFilter().Active())
+    {
+        const auto& matches = index.Matches();
+        return std::lower_bound(matches.begin(), matches.end(), id) - matches.begin();
+    }
+    return (id > oldest) ? id - oldest : 0;
+}
+
+int LogDisplayer::visible_lines() const
+{
+    // The menu takes two rows, the border two more, the scroll indicator and status bar one each
+    return std::max(ftxui::Terminal::Size().dimy - 6, 1);
 }
 
 Element LogDisplayer::Render()
 {
+    sync();
+    height = visible_lines();
+
     Elements list;
-    int index = 0;
-    for (const std::string& line : lines)
+    auto count = view_size();
+    uint64_t top_position = 0;
+    if (count > 0)
     {
-        Element document = RenderLine(line, index);
-        list.push_back(document);
-        index++;
+        auto position = following ? count - 1 : std::min(view_position(selected), count - 1);
+
+        // Scroll as little as needed to show the selected line, keeping the window full
+        auto window = static_cast<uint64_t>(height);
+        top_position = std::min(view_position(top), count - 1);
+        if (position < top_position)
+        {
+            top_position = position;
+        }
+        if (position >= top_position + window)
+        {
+            top_position = position - window + 1;
+        }
+        top_position = std::min(top_position, (count > window) ? count - window : 0);
+
+        selected = view_id(position);
+        top = view_id(top_position);
+
+        std::vector<uint64_t> ids;
+        for (auto p = top_position; p < std::min(top_position + window, count); ++p)
+        {
+            ids.push_back(view_id(p));
+        }
+        lineno_width = std::max<int>(std::to_string(end - 1).size(), 4);
+        auto formatted = lines->Format(ids);
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            list.push_back(RenderLine(formatted[i], ids[i]));
+        }
     }
 
     auto box_color = color(Color::Default);
@@ -86,21 +135,26 @@ Element LogDisplayer::Render()
         box_color = color(Color::Green);
     }
 
-    auto text_box = vbox(std::move(list)) | focusPositionRelative(x_focus, y_focus) | vscroll_indicator | frame | flex;
+    auto text_box = hbox({
+                        vbox(std::move(list)) | focusPositionRelative(x_focus, 0.0f) | frame | flex,
+                        vscroll_indicator(top_position, count),
+                    })
+                    | flex;
 
     return vbox({
                text_box,
                hscroll_indicator(),
+               status_bar(),
            })
         | border | box_color | flex;
 }
 
-Element LogDisplayer::RenderLine(const std::string& line, int lineno)
+Element LogDisplayer::RenderLine(const std::string& line, uint64_t lineno)
 {
     bool line_focus = (lineno == GetSelected());
     bool box_focus = Focused();
 
-    Element lineno_element = text(std::to_string(lineno)) | align_right | dim | size(WIDTH, EQUAL, 4);
+    Element lineno_element = text(std::to_string(lineno)) | align_right | dim | size(WIDTH, EQUAL, lineno_width);
     Element document = hbox({lineno_element, separator(), text(line) | flex});
 
     Decorator line_decorator = color(Color::Default);
@@ -115,6 +169,61 @@ Element LogDisplayer::RenderLine(const std::string& line, int lineno)
     return document | line_decorator;
 }
 
+Element LogDisplayer::status_bar()
+{
+    const auto& filter = index.GetFilter();
+
+    std::string level = "all";
+    if (filter.level)
+    {
+        level = std::to_string(*filter.level);
+        for (const auto& [value, flag] : index.GetLevels())
+        {
+            if (value == *filter.level)
+            {
+                level = LogFlagToString(flag);
+            }
+        }
+    }
+
+    auto search = editing ? query : filter.text;
+    auto regex = editing ? query_regex : filter.regex;
+    Elements items = {
+        text("level: " + level),
+        text("  id: " + filter.id.value_or("all")),
+        text(regex ? "  regex: " : "  text: "),
+        editing ? text(search) | underlined : text(search),
+    };
+    if (!error.empty())
+    {
+        items.push_back(text("  " + error) | color(Color::Red));
+    }
+    items.push_back(filler());
+    items.push_back(text(std::to_string(view_size()) + " of " + std::to_string(end - oldest) + " lines"));
+    return hbox(std::move(items)) | dim;
+}
+
+Element LogDisplayer::vscroll_indicator(uint64_t top_position, uint64_t count)
+{
+    auto window = static_cast<uint64_t>(height);
+    if (count <= window)
+    {
+        return text("");
+    }
+
+    // The thumb spans the share of the lines shown in the window, at least one row
+    auto thumb = std::max<uint64_t>(window * window / count, 1);
+    auto offset = top_position * (window - thumb) / (count - window);
+
+    Elements rows;
+    for (uint64_t row = 0; row < window; ++row)
+    {
+        bool in_thumb = (row >= offset) && (row < offset + thumb);
+        rows.push_back(in_thumb ? text("┃") | bold : text("│") | dim);
+    }
+    return vbox(std::move(rows));
+}
+
 Element LogDisplayer::hscroll_indicator()
 {
     int x_dim = ftxui::Terminal::Size().dimx;
@@ -127,25 +236,145 @@ Element LogDisplayer::hscroll_indicator()
     return hbox(text(hscroll_text) | bold | align_right | color(Color::Default) | size(WIDTH, EQUAL, indicator_width));
 }
 
+void LogDisplayer::apply(const LogFilter& filter)
+{
+    try
+    {
+        index.SetFilter(filter);
+        error.clear();
+    }
+    catch (const std::regex_error& e)
+    {
+        error = e.what();
+    }
+}
+
+bool LogDisplayer::on_search_event(Event event)
+{
+    sync();
+    auto filter = index.GetFilter();
+
+    if (event == ftxui::Event::Return)
+    {
+        editing = false;
+        filter.text = query;
+        filter.regex = query_regex;
+        apply(filter);
+        return true;
+    }
+    if (event == ftxui::Event::Escape)
+    {
+        editing = false;
+        filter.text.clear();
+        filter.regex = false;
+        apply(filter);
+        return true;
+    }
+    if (event == ftxui::Event::Tab)
+    {
+        query_regex = !query_regex;
+    }
+    else if (event == ftxui::Event::Backspace)
+    {
+        if (!query.empty())
+        {
+            query.pop_back();
+        }
+    }
+    else if (event.is_character())
+    {
+        query += event.character();
+    }
+    else
+    {
+        return true;
+    }
+
+    // Plain text is searched as it is typed, regular expressions once they are complete
+    if (!query_regex)
+    {
+        filter.text = query;
+        filter.regex = false;
+        apply(filter);
+    }
+    return true;
+}
+
 bool LogDisplayer::OnEvent(Event event)
 {
     if (!Focused())
     {
         return false;
     }
+    if (editing)
+    {
+        return on_search_event(event);
+    }
+
+    sync();
+    auto filter = index.GetFilter();
+
+    // The next of the levels or ids buffered, after the last one back to all of them
+    auto cycle = [](const auto& values, auto current) {
+        auto it = values.begin();
+        if (current)
+        {
+            it = std::upper_bound(values.begin(), values.end(), *current);
+        }
+        return (it != values.end()) ? decltype(current)(*it) : std::nullopt;
+    };
+    if (event == ftxui::Event::Character('v'))
+    {
+        std::vector<uint32_t> levels;
+        for (const auto& level : index.GetLevels())
+        {
+            levels.push_back(level.first);
+        }
+        filter.level = cycle(levels, filter.level);
+        apply(filter);
+        return true;
+    }
+    if (event == ftxui::Event::Character('c'))
+    {
+        filter.id = cycle(index.GetIds(), filter.id);
+        apply(filter);
+        return true;
+    }
+    if (event == ftxui::Event::Character('/'))
+    {
+        editing = true;
+        query = filter.text;
+        query_regex = filter.regex;
+        return true;
+    }
+    if (event == ftxui::Event::Character('x'))
+    {
+        query.clear();
+        apply(LogFilter{});
+        return true;
+    }
 
-    int start_selected = selected;
+    auto count = view_size();
+    if (count == 0)
+    {
+        return false;
+    }
+
+    auto newest = count - 1;
+    auto position = following ? newest : std::min(view_position(selected), newest);
+    auto start_position = position;
     float start_x_focus = x_focus;
-    float start_y_focus = y_focus;
+
+    auto page = static_cast<uint64_t>(height);
 
     // Use arrows or vim motions to navigate logs
-    if ((event == ftxui::Event::ArrowUp || event == ftxui::Event::Character('k')) && selected > 0)
+    if ((event == ftxui::Event::ArrowUp || event == ftxui::Event::Character('k')) && position > 0)
     {
-        selected--;
+        position--;
     }
-    if ((event == ftxui::Event::ArrowDown || event == ftxui::Event::Character('j')) && selected < n_lines - 1)
+    if ((event == ftxui::Event::ArrowDown || event == ftxui::Event::Character('j')) && position < newest)
     {
-        selected++;
+        position++;
     }
     if ((event == ftxui::Event::ArrowLeft || event == ftxui::Event::Character('h')) && x_focus > 0.1f)
     {
@@ -155,38 +384,39 @@ bool LogDisplayer::OnEvent(Event event)
     {
         x_focus = x_focus + 0.1f;
     }
+    if (event == ftxui::Event::PageUp)
+    {
+        position = (position > page) ? position - page : 0;
+    }
+    if (event == ftxui::Event::PageDown)
+    {
+        position = std::min(position + page, newest);
+    }
+    if (event == ftxui::Event::Home || event == ftxui::Event::Character('g'))
+    {
+        position = 0;
+    }
+    if (event == ftxui::Event::End || event == ftxui::Event::Character('G'))
+    {
+        position = newest;
+    }
 
     // Jump to newest (last) line on Enter
     if (event == ftxui::Event::Return)
     {
-        selected = n_lines - 1;
+        position = newest;
         x_focus = 0.0f;
     }
 
-    // Calculate y_focus from selected
-    if (n_lines <= 1)
-    {
-        y_focus = 1.0f;
-    }
-    else
-    {
-        y_focus = static_cast<float>(selected) / static_cast<float>(n_lines - 1);
-    }
+    following = (position == newest);
+    selected = view_id(position);
 
-    return (selected != start_selected) || (x_focus != start_x_focus) || (y_focus != start_y_focus);
+    return (position != start_position) || (x_focus != start_x_focus);
 }
 
-void LogDisplayer::AddLine(const std::string& line)
+std::shared_ptr<LogBuffer> LogDisplayer::GetBuffer() const
 {
-    bool last_line_selected = (selected == n_lines - 1) || (n_lines == 0);
-
-    lines.push_back(line);
-    n_lines = lines.size();
-
-    if (last_line_selected)
-    {
-        selected = n_lines - 1;
-    }
+    return lines;
 }
 
 Element LogDisplayer::debug_info()
@@ -194,18 +424,23 @@ Element LogDisplayer::debug_info()
     return hbox({
         text(std::to_string(x_focus)),
         separator(),
-        text(std::to_string(y_focus)),
+        text(std::to_string(top)),
         separator(),
-        text(std::to_string(selected) + " / " + std::to_string(n_lines)),
+        text(std::to_string(selected) + " / " + std::to_string(end)),
     });
 }
 
-int LogDisplayer::GetSelected() const
+uint64_t LogDisplayer::GetSelected() const
 {
     return selected;
 }
 
+bool LogDisplayer::Editing() const
+{
+    return editing;
+}
+
 bool LogDisplayer::Focusable() const
 {
     return true;
-}
\ No newline at end of file
+}
@@ -1,29 +1,34 @@
 #ifndef CALDERADNP3_OUTSTATION_LOG_DISPLAYER_H
 #define CALDERADNP3_OUTSTATION_LOG_DISPLAYER_H
 
+#include "ui/log_buffer.h"
+#include "ui/redraw_coalescer.h"
+
 #include <opendnp3/channel/IChannelListener.h>
 #include <opendnp3/logging/ILogHandler.h>
 
 #include <ftxui/component/component.hpp>
-#include <ftxui/component/screen_interactive.hpp>
 
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
 
 class TuiLogger final : public opendnp3::ILogHandler, public opendnp3::IChannelListener
 {
 private:
-    ftxui::ScreenInteractive* screen = nullptr;
-    ftxui::Sender<std::string> sender;
+    std::shared_ptr<RedrawCoalescer> redraws = nullptr;
+    std::shared_ptr<LogBuffer> buffer;
     bool printLocation;
-    std::mutex mutex;
 
 public:
-    explicit TuiLogger(ftxui::Sender<std::string> sender, bool printLocation);
-    static std::shared_ptr<TuiLogger> Create(ftxui::Sender<std::string> sender);
-    static std::shared_ptr<TuiLogger> Create(ftxui::Sender<std::string> sender, bool printLocation);
+    explicit TuiLogger(std::shared_ptr<LogBuffer> buffer, bool printLocation);
+    static std::shared_ptr<TuiLogger> Create(std::shared_ptr<LogBuffer> buffer);
+    static std::shared_ptr<TuiLogger> Create(std::shared_ptr<LogBuffer> buffer, bool printLocation);
 
-    void RegisterScreen(ftxui::ScreenInteractive* screen_ptr);
+    void RegisterRedraws(std::shared_ptr<RedrawCoalescer> coalescer);
 
     void log(opendnp3::ModuleId module_id,
              const char* id,
@@ -33,17 +38,54 @@ public:
     void OnStateChange(opendnp3::ChannelState state) override;
 };
 
+/**
+ * LogDisplayer shows the log records kept in a LogBuffer.
+ *
+ * Only the records in the window around the selected line are formatted and
+ * rendered, so drawing a frame does not depend on how many are buffered.
+ * While the newest line is selected the selection follows new records.
+ *
+ * The records shown can be filtered by level (v), by logger id (c) and by
+ * the text of their message (/, where Tab switches to a regular expression
+ * applied on Enter); x clears the filter. Filtering goes through a LogIndex
+ * kept up to date with the buffer, so it does not rescan every record.
+ */
 class LogDisplayer : public ftxui::ComponentBase
 {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 10000;
+
 private:
-    std::vector<std::string> lines = {};
+    std::shared_ptr<LogBuffer> lines = std::make_shared<LogBuffer>(DEFAULT_CAPACITY);
+    LogIndex index{lines};
+    uint64_t oldest = 0;
+    uint64_t end = 0;
 
-    int selected = 0;
-    int n_lines = 0;
+    uint64_t selected = 0;
+    bool following = true;
+    uint64_t top = 0; // id of the first line in the window
+    int height = 1;   // number of lines in the window when last rendered
+    int lineno_width = 4;
 
     float x_focus = 0.0f;
-    float y_focus = 1.0f;
 
+    bool editing = false;
+    std::string query;
+    bool query_regex = false;
+    std::string error; // why the last regular expression was rejected
+
+    // Positions in the records shown: all buffered records or the matches of the filter
+    void sync();
+    uint64_t view_size() const;
+    uint64_t view_id(uint64_t position) const;
+    uint64_t view_position(uint64_t id) const;
+
+    void apply(const LogFilter& filter);
+    bool on_search_event(ftxui::Event event);
+
+    int visible_lines() const;
+    ftxui::Element status_bar();
+    ftxui::Element vscroll_indicator(uint64_t top_position, uint64_t count);
     ftxui::Element hscroll_indicator();
     ftxui::Element debug_info();
 
@@ -52,10 +94,11 @@ public:
     static std::shared_ptr<LogDisplayer> Create();
 
     ftxui::Element Render() override;
-    virtual ftxui::Element RenderLine(const std::string& line, int lineno);
-    void AddLine(const std::string& line);
+    virtual ftxui::Element RenderLine(const std::string& line, uint64_t lineno);
     bool OnEvent(ftxui::Event) override;
-    int GetSelected() const;
+    std::shared_ptr<LogBuffer> GetBuffer() const;
+    uint64_t GetSelected() const;
+    bool Editing() const;
     bool Focusable() const final;
 };
 
@@ -15,6 +15,7 @@ MainComponent::MainComponent()
                 system_page,
                 io_page,
                 log_displayer,
+                stats_page,
             },
             &selected_page),
     }));
@@ -25,18 +26,6 @@ std::shared_ptr<MainComponent> MainComponent::Create()
     return std::make_shared<MainComponent>();
 }
 
-bool MainComponent::OnEvent(Event event)
-{
-    while (log_receiver && log_receiver->HasPending())
-    {
-        std::string line;
-        log_receiver->Receive(&line);
-        log_displayer->AddLine(line);
-    }
-
-    return ComponentBase::OnEvent(event);
-}
-
 Element MainComponent::Render()
 {
     if (selected_page == 1)
@@ -53,15 +42,22 @@ Element MainComponent::Render()
             log_displayer->Render(),
         });
     }
+    else if (selected_page == 3)
+    {
+        return vbox({
+            menu->Render(),
+            stats_page->Render(),
+        });
+    }
     return vbox({
         menu->Render(),
         system_page->Render(),
     });
 }
 
-void MainComponent::RegisterLogReceiver(ftxui::Receiver<std::string> receiver)
+std::shared_ptr<LogBuffer> MainComponent::GetLogBuffer() const
 {
-    log_receiver = std::move(receiver);
+    return log_displayer->GetBuffer();
 }
 
 void MainComponent::RegisterDevices(std::vector<std::shared_ptr<IDevice>> devices)
@@ -72,4 +68,34 @@ void MainComponent::RegisterDevices(std::vector<std::shared_ptr<IDevice>> device
 void MainComponent::RegisterIOTable(std::shared_ptr<IOTable> io_table)
 {
     io_page->RegisterIOTable(io_table);
+}
+
+void MainComponent::RegisterMetrics(std::shared_ptr<OutstationMetrics> metrics)
+{
+    stats_page->RegisterMetrics(metrics);
+}
+
+void MainComponent::RegisterRedraws(std::shared_ptr<RedrawCoalescer> redraws)
+{
+    stats_page->RegisterRedraws(redraws);
+}
+
+void MainComponent::SetLogCapacity(size_t capacity)
+{
+    log_displayer->GetBuffer()->SetCapacity(capacity);
+}
+
+void MainComponent::SampleStats()
+{
+    stats_page->Sample();
+}
+
+bool MainComponent::ShowsStats() const
+{
+    return selected_page == 3;
+}
+
+bool MainComponent::CapturesKeys() const
+{
+    return (selected_page == 1 && io_page->Editing()) || (selected_page == 2 && log_displayer->Editing());
 }
\ No newline at end of file
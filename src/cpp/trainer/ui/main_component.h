@@ -3,10 +3,10 @@
 
 #include "ui/io_page.h"
 #include "ui/log_displayer.h"
+#include "ui/stats_page.h"
 #include "ui/system_page.h"
 
 #include <ftxui/component/component.hpp>
-#include <ftxui/component/receiver.hpp>
 
 #include <functional>
 #include <string>
@@ -14,30 +14,39 @@
 class MainComponent : public ftxui::ComponentBase
 {
 private:
-    ftxui::Receiver<std::string> log_receiver = nullptr;
-
     int selected_page = 0;
     std::vector<std::string> pages = {
         "System View",
         "IO Table",
         "Logs",
+        "Stats",
     };
 
     ftxui::Component menu = ftxui::Menu(&pages, &selected_page, ftxui::MenuOption::HorizontalAnimated());
     std::shared_ptr<SystemPage> system_page = SystemPage::Create();
     std::shared_ptr<LogDisplayer> log_displayer = LogDisplayer::Create();
     std::shared_ptr<IOPage> io_page = IOPage::Create();
+    std::shared_ptr<StatsPage> stats_page = StatsPage::Create();
 
 public:
     MainComponent();
     static std::shared_ptr<MainComponent> Create();
 
     ftxui::Element Render() override;
-    bool OnEvent(ftxui::Event) override;
 
-    void RegisterLogReceiver(ftxui::Receiver<std::string> receiver);
+    std::shared_ptr<LogBuffer> GetLogBuffer() const;
     void RegisterDevices(std::vector<std::shared_ptr<IDevice>> devices);
     void RegisterIOTable(std::shared_ptr<IOTable> io_table);
+    void RegisterMetrics(std::shared_ptr<OutstationMetrics> metrics);
+    void RegisterRedraws(std::shared_ptr<RedrawCoalescer> redraws);
+    void SetLogCapacity(size_t capacity);
+
+    // Called by the renderer's sampling thread; ShowsStats only from the UI thread
+    void SampleStats();
+    bool ShowsStats() const;
+
+    // True while keys are typed into a search or prompt rather than used as commands
+    bool CapturesKeys() const;
 };
 
 #endif // CALDERADNP3_OUTSTATION_MAIN_COMPONENT_H
\ No newline at end of file
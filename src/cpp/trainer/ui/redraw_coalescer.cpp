@@ -0,0 +1,91 @@
+#include "ui/redraw_coalescer.h"
+
+#include <algorithm>
+
+RedrawCoalescer::RedrawCoalescer(ftxui::ScreenInteractive* screen) : screen(screen) {}
+
+RedrawCoalescer::~RedrawCoalescer()
+{
+    Stop();
+}
+
+std::shared_ptr<RedrawCoalescer> RedrawCoalescer::Create(ftxui::ScreenInteractive* screen)
+{
+    return std::make_shared<RedrawCoalescer>(screen);
+}
+
+void RedrawCoalescer::SetFrameRate(unsigned int fps)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    interval = std::chrono::microseconds(1000000 / std::max(fps, 1u));
+}
+
+void RedrawCoalescer::Request()
+{
+    requests.fetch_add(1, std::memory_order_relaxed);
+    if (dirty.exchange(true, std::memory_order_acq_rel))
+    {
+        coalesced.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RedrawCoalescer::Start()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running)
+    {
+        return;
+    }
+    running = true;
+    thread = std::thread([this]() { run(); });
+}
+
+void RedrawCoalescer::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_one();
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+}
+
+uint64_t RedrawCoalescer::NumRequests() const
+{
+    return requests.load(std::memory_order_relaxed);
+}
+
+uint64_t RedrawCoalescer::NumCoalesced() const
+{
+    return coalesced.load(std::memory_order_relaxed);
+}
+
+uint64_t RedrawCoalescer::NumRedraws() const
+{
+    return redraws.load(std::memory_order_relaxed);
+}
+
+void RedrawCoalescer::run()
+{
+    auto next = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running)
+    {
+        // Frames keep a steady pace, without catching up on those missed while the screen was busy
+        next = std::max(next + interval, std::chrono::steady_clock::now());
+        if (wake.wait_until(lock, next, [this]() { return !running; }))
+        {
+            break;
+        }
+
+        if (dirty.exchange(false, std::memory_order_acq_rel))
+        {
+            redraws.fetch_add(1, std::memory_order_relaxed);
+            screen->PostEvent(ftxui::Event::Custom);
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef CALDERADNP3_OUTSTATION_REDRAW_COALESCER_H
+#define CALDERADNP3_OUTSTATION_REDRAW_COALESCER_H
+
+#include <ftxui/component/screen_interactive.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * RedrawCoalescer caps the redraws of the screen to a frame rate.
+ *
+ * Devices, loggers and generators request a redraw whenever what they show
+ * changes, which only sets a flag. Once per frame interval the coalescer's
+ * thread posts a single redraw event if any request came in since the last
+ * one, so a burst of changes costs one frame. Requests made while a redraw
+ * is already pending are counted as coalesced.
+ */
+class RedrawCoalescer
+{
+public:
+    static constexpr unsigned int DEFAULT_FPS = 30;
+
+    explicit RedrawCoalescer(ftxui::ScreenInteractive* screen);
+    ~RedrawCoalescer();
+    static std::shared_ptr<RedrawCoalescer> Create(ftxui::ScreenInteractive* screen);
+
+    void SetFrameRate(unsigned int fps);
+    void Request();
+    void Start();
+    void Stop();
+
+    uint64_t NumRequests() const;
+    uint64_t NumCoalesced() const;
+    uint64_t NumRedraws() const;
+
+private:
+    ftxui::ScreenInteractive* screen;
+    std::atomic<bool> dirty{false};
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> coalesced{0};
+    std::atomic<uint64_t> redraws{0};
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::chrono::microseconds interval{1000000 / DEFAULT_FPS};
+    bool running = false;
+    std::thread thread;
+
+    void run();
+};
+
+#endif // CALDERADNP3_OUTSTATION_REDRAW_COALESCER_H
@@ -4,6 +4,15 @@
 
 #include <ftxui/component/screen_interactive.hpp>
 
+TuiRenderer::~TuiRenderer()
+{
+    sampling = false;
+    if (sampler.joinable())
+    {
+        sampler.join();
+    }
+}
+
 std::shared_ptr<TuiRenderer> TuiRenderer::Create()
 {
     return std::make_shared<TuiRenderer>();
@@ -11,12 +20,8 @@ std::shared_ptr<TuiRenderer> TuiRenderer::Create()
 
 std::shared_ptr<TuiLogger> TuiRenderer::GetLogger()
 {
-    auto log_receiver = ftxui::MakeReceiver<std::string>();
-    auto log_sender = log_receiver->MakeSender();
-
-    app->RegisterLogReceiver(std::move(log_receiver));
-    auto logger = TuiLogger::Create(std::move(log_sender));
-    logger->RegisterScreen(&screen);
+    auto logger = TuiLogger::Create(app->GetLogBuffer());
+    logger->RegisterRedraws(redraws);
 
     return logger;
 }
@@ -25,20 +30,61 @@ void TuiRenderer::RegisterDevices(std::vector<std::shared_ptr<IDevice>> devices)
 {
     for (auto device : devices)
     {
-        device->RegisterScreen(&screen);
+        device->SetRedrawCallback([this]() { redraws->Request(); });
     }
     app->RegisterDevices(devices);
 }
 
 void TuiRenderer::RegisterIOTable(std::shared_ptr<IOTable> io_table)
 {
+    // One redraw request per batch of generated analog values
+    io_table->GetWaveforms()->SetBatchListener([this]() { redraws->Request(); });
+    io_table->GetPowerModel()->SetBatchListener([this]() { redraws->Request(); });
     app->RegisterIOTable(io_table);
 }
 
+void TuiRenderer::RegisterMetrics(std::shared_ptr<OutstationMetrics> metrics)
+{
+    app->RegisterMetrics(metrics);
+    app->RegisterRedraws(redraws);
+}
+
+void TuiRenderer::SetLogCapacity(size_t capacity)
+{
+    app->SetLogCapacity(capacity);
+}
+
+void TuiRenderer::SetFrameRate(unsigned int fps)
+{
+    redraws->SetFrameRate(fps);
+}
+
+void TuiRenderer::RequestRedraw()
+{
+    redraws->Request();
+}
+
 void TuiRenderer::Init()
 {
+    sampling = true;
+    sampler = std::thread([this]() {
+        while (sampling)
+        {
+            std::this_thread::sleep_for(StatsPage::SAMPLE_INTERVAL);
+            app->SampleStats();
+
+            // Only the Stats page changes with a sample, so other pages are not redrawn
+            screen.Post([this]() {
+                if (app->ShowsStats())
+                {
+                    redraws->Request();
+                }
+            });
+        }
+    });
+
     auto controlled_app = ftxui::CatchEvent(app, [this](ftxui::Event event) {
-        if (event == ftxui::Event::Character('q'))
+        if (event == ftxui::Event::Character('q') && !app->CapturesKeys())
         {
             screen.ExitLoopClosure()();
             return true;
@@ -46,5 +92,10 @@ void TuiRenderer::Init()
         return false;
     });
 
+    redraws->Start();
     screen.Loop(controlled_app);
+    redraws->Stop();
+
+    sampling = false;
+    sampler.join();
 }
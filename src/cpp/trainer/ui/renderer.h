@@ -3,6 +3,7 @@
 
 #include "outstation/devices.h"
 #include "ui/main_component.h"
+#include "ui/redraw_coalescer.h"
 
 #include <ftxui/component/screen_interactive.hpp>
 
@@ -15,14 +16,23 @@ class TuiRenderer
 private:
     ftxui::ScreenInteractive screen = ftxui::ScreenInteractive::Fullscreen();
     std::shared_ptr<MainComponent> app = MainComponent::Create();
+    std::shared_ptr<RedrawCoalescer> redraws = RedrawCoalescer::Create(&screen);
+
+    // Samples the statistics at a fixed rate; the redraws it requests are coalesced like any other
+    std::atomic<bool> sampling{false};
+    std::thread sampler;
 
 public:
     TuiRenderer() = default;
-    ~TuiRenderer() = default;
+    ~TuiRenderer();
     static std::shared_ptr<TuiRenderer> Create();
 
     void RegisterDevices(std::vector<std::shared_ptr<IDevice>> devices);
     void RegisterIOTable(std::shared_ptr<IOTable> io_table);
+    void RegisterMetrics(std::shared_ptr<OutstationMetrics> metrics);
+    void SetLogCapacity(size_t capacity);
+    void SetFrameRate(unsigned int fps);
+    void RequestRedraw();
     std::shared_ptr<TuiLogger> GetLogger();
 
     void Init();
@@ -0,0 +1,271 @@
+#include "ui/stats_page.h"
+
+#include <algorithm>
+#include <cstdio>
+
+using namespace ftxui;
+
+namespace
+{
+const char* const BLOCKS[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+
+// Latency below which the given fraction of the commands in the histogram were handled, in milliseconds
+double percentile(const OutstationMetrics::Latencies& buckets, double fraction)
+{
+    uint64_t total = 0;
+    for (auto count : buckets)
+    {
+        total += count;
+    }
+    if (total == 0)
+    {
+        return 0.0;
+    }
+
+    auto rank = fraction * static_cast<double>(total);
+    double cumulative = 0.0;
+    for (size_t b = 0; b < buckets.size(); ++b)
+    {
+        if (buckets[b] == 0)
+        {
+            continue;
+        }
+        if (cumulative + static_cast<double>(buckets[b]) >= rank)
+        {
+            // Bucket b holds the durations from 2^(b-1) up to 2^b microseconds
+            double lower = (b == 0) ? 0.0 : static_cast<double>(uint64_t(1) << (b - 1));
+            double upper = static_cast<double>(uint64_t(1) << b);
+            double within = (rank - cumulative) / static_cast<double>(buckets[b]);
+            return (lower + (upper - lower) * within) / 1000.0;
+        }
+        cumulative += static_cast<double>(buckets[b]);
+    }
+    return static_cast<double>(uint64_t(1) << (buckets.size() - 1)) / 1000.0;
+}
+
+std::string format(double value, const char* unit)
+{
+    char text[32];
+    if (value >= 1e6)
+    {
+        std::snprintf(text, sizeof(text), "%.1fM%s", value / 1e6, unit);
+    }
+    else if (value >= 1e4)
+    {
+        std::snprintf(text, sizeof(text), "%.1fk%s", value / 1e3, unit);
+    }
+    else
+    {
+        std::snprintf(text, sizeof(text), "%.1f%s", value, unit);
+    }
+    return text;
+}
+} // namespace
+
+// StatsSeries
+
+void StatsSeries::Push(double value)
+{
+    values[next] = value;
+    next = (next + 1) % CAPACITY;
+    count = std::min(count + 1, CAPACITY);
+}
+
+double StatsSeries::at(size_t age) const
+{
+    return values[(next + CAPACITY - 1 - age) % CAPACITY];
+}
+
+double StatsSeries::Last() const
+{
+    return (count == 0) ? 0.0 : at(0);
+}
+
+double StatsSeries::Peak() const
+{
+    double peak = 0.0;
+    for (size_t age = 0; age < count; ++age)
+    {
+        peak = std::max(peak, at(age));
+    }
+    return peak;
+}
+
+std::string StatsSeries::Sparkline(size_t width) const
+{
+    auto shown = std::min(width, count);
+    double peak = 0.0;
+    for (size_t age = 0; age < shown; ++age)
+    {
+        peak = std::max(peak, at(age));
+    }
+
+    // Samples not taken yet are blank, so the line grows from the right
+    std::string line(width - shown, ' ');
+    for (size_t age = shown; age > 0; --age)
+    {
+        auto level = (peak > 0.0) ? static_cast<size_t>(at(age - 1) / peak * 7.0 + 0.5) : 0;
+        line += BLOCKS[std::min<size_t>(level, 7)];
+    }
+    return line;
+}
+
+// StatsPage
+
+std::shared_ptr<StatsPage> StatsPage::Create()
+{
+    return std::make_shared<StatsPage>();
+}
+
+void StatsPage::RegisterMetrics(std::shared_ptr<OutstationMetrics> metrics)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->metrics = metrics;
+
+    if (auto events = metrics->GetEventStats())
+    {
+        capacity = 0;
+        for (size_t t = 0; t < EventStats::NUM_TYPES; ++t)
+        {
+            capacity += events->Get(static_cast<EventType>(t)).capacity;
+        }
+    }
+}
+
+void StatsPage::RegisterRedraws(std::shared_ptr<RedrawCoalescer> redraws)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->redraws = redraws;
+}
+
+void StatsPage::Sample()
+{
+    std::shared_ptr<OutstationMetrics> source;
+    std::shared_ptr<RedrawCoalescer> screen;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        source = metrics;
+        screen = redraws;
+    }
+    if (!source)
+    {
+        return;
+    }
+
+    // Gather the counters outside the lock: channel statistics are fetched from the DNP3 threads
+    Totals totals;
+    totals.time = std::chrono::steady_clock::now();
+    for (const auto& [function, count] : source->GetRequests())
+    {
+        totals.requests += count;
+    }
+    totals.commands = source->NumCommands(CommandType::CROB) + source->NumCommands(CommandType::ANALOG);
+    uint64_t occupancy = 0;
+    if (auto events = source->GetEventStats())
+    {
+        for (size_t t = 0; t < EventStats::NUM_TYPES; ++t)
+        {
+            auto counters = events->Get(static_cast<EventType>(t));
+            totals.queued += counters.queued;
+            totals.confirmed += counters.confirmed;
+            occupancy += counters.occupancy;
+        }
+    }
+    if (auto channel = source->GetChannel())
+    {
+        auto stats = channel->GetStatistics();
+        totals.bytesIn = stats.channel.numBytesRx;
+        totals.bytesOut = stats.channel.numBytesTx;
+    }
+    totals.latencies = source->GetLatencies();
+    if (screen)
+    {
+        totals.redraws = screen->NumRedraws();
+        totals.coalesced = screen->NumCoalesced();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (last.has_value())
+    {
+        auto seconds = std::chrono::duration<double>(totals.time - last->time).count();
+        auto rate = [seconds](uint64_t now, uint64_t before) {
+            return (seconds > 0.0) ? static_cast<double>(now - before) / seconds : 0.0;
+        };
+        series[REQUESTS].Push(rate(totals.requests, last->requests));
+        series[COMMANDS].Push(rate(totals.commands, last->commands));
+        series[EVENTS_QUEUED].Push(rate(totals.queued, last->queued));
+        series[EVENTS_CONFIRMED].Push(rate(totals.confirmed, last->confirmed));
+        series[EVENT_OCCUPANCY].Push(static_cast<double>(occupancy));
+        series[BYTES_IN].Push(rate(totals.bytesIn, last->bytesIn));
+        series[BYTES_OUT].Push(rate(totals.bytesOut, last->bytesOut));
+
+        OutstationMetrics::Latencies recent{};
+        for (size_t b = 0; b < recent.size(); ++b)
+        {
+            recent[b] = totals.latencies[b] - last->latencies[b];
+        }
+        series[LATENCY_P50].Push(percentile(recent, 0.50));
+        series[LATENCY_P99].Push(percentile(recent, 0.99));
+        series[REDRAWS].Push(rate(totals.redraws, last->redraws));
+        series[REDRAWS_COALESCED].Push(rate(totals.coalesced, last->coalesced));
+    }
+    last = totals;
+}
+
+Element StatsPage::Render()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!metrics)
+    {
+        return vbox() | border | flex;
+    }
+
+    struct Row
+    {
+        Series series;
+        const char* name;
+        const char* unit;
+    };
+    static const Row rows[] = {
+        {REQUESTS, "Requests", "/s"},
+        {COMMANDS, "Commands", "/s"},
+        {EVENTS_QUEUED, "Events generated", "/s"},
+        {EVENTS_CONFIRMED, "Events confirmed", "/s"},
+        {EVENT_OCCUPANCY, "Event buffer", ""},
+        {BYTES_IN, "Bytes in", "/s"},
+        {BYTES_OUT, "Bytes out", "/s"},
+        {LATENCY_P50, "Command latency p50", " ms"},
+        {LATENCY_P99, "Command latency p99", " ms"},
+        {REDRAWS, "Screen redraws", "/s"},
+        {REDRAWS_COALESCED, "Redraws coalesced", "/s"},
+    };
+
+    // Label, current value and peak take 46 columns, the sparklines the rest
+    auto width = static_cast<size_t>(std::max(Terminal::Size().dimx - 50, 10));
+    width = std::min(width, StatsSeries::CAPACITY);
+
+    Elements lines;
+    for (const auto& row : rows)
+    {
+        const auto& values = series[row.series];
+        auto current = format(values.Last(), row.unit);
+        if (row.series == EVENT_OCCUPANCY)
+        {
+            current += " of " + std::to_string(capacity);
+        }
+        lines.push_back(hbox({
+            text(row.name) | size(WIDTH, EQUAL, 22),
+            text(current) | align_right | size(WIDTH, EQUAL, 14),
+            text(" "),
+            text(values.Sparkline(width)) | color(Color::Green),
+            text(" peak " + format(values.Peak(), row.unit)) | dim,
+        }));
+        lines.push_back(separatorEmpty());
+    }
+    return vbox(std::move(lines)) | border | flex;
+}
+
+bool StatsPage::OnEvent(Event)
+{
+    return false;
+}
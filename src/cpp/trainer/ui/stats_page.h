@@ -0,0 +1,105 @@
+#ifndef CALDERADNP3_OUTSTATION_STATS_PAGE_H
+#define CALDERADNP3_OUTSTATION_STATS_PAGE_H
+
+#include "outstation/metrics.h"
+#include "ui/redraw_coalescer.h"
+
+#include <ftxui/component/component.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+/**
+ * StatsSeries is a fixed-size ring of the latest samples of one statistic.
+ */
+class StatsSeries
+{
+public:
+    static constexpr size_t CAPACITY = 240;
+
+    void Push(double value);
+    double Last() const;
+    double Peak() const;
+
+    // One block character per sample, newest on the right, scaled to the peak of the samples shown
+    std::string Sparkline(size_t width) const;
+
+private:
+    std::array<double, CAPACITY> values{};
+    size_t next = 0;
+    size_t count = 0;
+
+    double at(size_t age) const;
+};
+
+/**
+ * StatsPage shows the rolling throughput of an outstation as sparklines.
+ *
+ * The cumulative counters of the outstation's metrics are sampled every
+ * SAMPLE_INTERVAL by the renderer and turned into rates, so rendering only
+ * reads the rings and the page is redrawn at most once per sample.
+ * Command latency percentiles are estimated from the commands handled since
+ * the previous sample, interpolating within their histogram bucket. The
+ * redraws of the screen, and the requests coalesced into them, are shown
+ * as well.
+ */
+class StatsPage : public ftxui::ComponentBase
+{
+public:
+    static constexpr std::chrono::milliseconds SAMPLE_INTERVAL{500};
+
+    StatsPage() = default;
+    static std::shared_ptr<StatsPage> Create();
+
+    ftxui::Element Render() override;
+    bool OnEvent(ftxui::Event) override;
+    void RegisterMetrics(std::shared_ptr<OutstationMetrics> metrics);
+    void RegisterRedraws(std::shared_ptr<RedrawCoalescer> redraws);
+    void Sample();
+
+private:
+    enum Series : size_t
+    {
+        REQUESTS,
+        COMMANDS,
+        EVENTS_QUEUED,
+        EVENTS_CONFIRMED,
+        EVENT_OCCUPANCY,
+        BYTES_IN,
+        BYTES_OUT,
+        LATENCY_P50,
+        LATENCY_P99,
+        REDRAWS,
+        REDRAWS_COALESCED,
+        NUM_SERIES
+    };
+
+    struct Totals
+    {
+        std::chrono::steady_clock::time_point time;
+        uint64_t requests = 0;
+        uint64_t commands = 0;
+        uint64_t queued = 0;
+        uint64_t confirmed = 0;
+        uint64_t bytesIn = 0;
+        uint64_t bytesOut = 0;
+        OutstationMetrics::Latencies latencies{};
+        uint64_t redraws = 0;
+        uint64_t coalesced = 0;
+    };
+
+    std::shared_ptr<OutstationMetrics> metrics = nullptr;
+    std::shared_ptr<RedrawCoalescer> redraws = nullptr;
+
+    std::mutex mutex;
+    std::optional<Totals> last;
+    std::array<StatsSeries, NUM_SERIES> series;
+    uint64_t capacity = 0;
+};
+
+#endif // CALDERADNP3_OUTSTATION_STATS_PAGE_H
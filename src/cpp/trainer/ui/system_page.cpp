@@ -1,29 +1,351 @@
 #include "ui/system_page.h"
 
+#include "ui/device_view.h"
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <utility>
+
 using namespace ftxui;
 
+namespace
+{
+// Names the group of a device after its type
+class DeviceKind : public DeviceVisitor
+{
+public:
+    std::string name;
+
+    void Visit(SimpleDevice&) override
+    {
+        name = "Devices";
+    }
+
+    void Visit(Breaker&) override
+    {
+        name = "Breakers";
+    }
+
+    void Visit(SlowDevice&) override
+    {
+        name = "Switches";
+    }
+
+    void Visit(SetpointController&) override
+    {
+        name = "Setpoints";
+    }
+};
+
+int line_height(size_t count)
+{
+    return (count == 0) ? 1 : DeviceView::TILE_HEIGHT;
+}
+} // namespace
+
 std::shared_ptr<SystemPage> SystemPage::Create()
 {
     return std::make_shared<SystemPage>();
 }
 
+int SystemPage::visible_rows() const
+{
+    // The menu takes two rows, the border two more and the status bar one
+    return std::max(ftxui::Terminal::Size().dimy - 5, 1);
+}
+
+void SystemPage::layout(size_t columns)
+{
+    // Keep the line at the top of the page in view
+    size_t anchor_group = 0;
+    size_t anchor_tile = tiles.size();
+    if (top < lines.size())
+    {
+        anchor_group = lines[top].group;
+        anchor_tile = (lines[top].count == 0) ? tiles.size() : lines[top].first;
+    }
+
+    lines.clear();
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        const auto& group = groups[g];
+        lines.push_back({g, group.first, 0});
+        if (group.collapsed)
+        {
+            continue;
+        }
+        auto end = group.first + group.count;
+        for (auto first = group.first; first < end; first += columns)
+        {
+            lines.push_back({g, first, std::min(columns, end - first)});
+        }
+    }
+    this->columns = columns;
+
+    top = 0;
+    for (size_t l = 0; l < lines.size(); ++l)
+    {
+        const auto& line = lines[l];
+        if (line.group != anchor_group)
+        {
+            continue;
+        }
+        if (line.count == 0)
+        {
+            top = l;
+        }
+        else if (anchor_tile >= line.first && anchor_tile < line.first + line.count)
+        {
+            top = l;
+            break;
+        }
+    }
+}
+
+void SystemPage::toggle(size_t group)
+{
+    groups[group].collapsed = !groups[group].collapsed;
+    layout(columns);
+}
+
+void SystemPage::show_group(size_t group)
+{
+    for (size_t l = 0; l < lines.size(); ++l)
+    {
+        if (lines[l].group == group && lines[l].count == 0)
+        {
+            top = std::min(l, last_top());
+            return;
+        }
+    }
+}
+
+size_t SystemPage::last_top() const
+{
+    // The first line from which the remaining lines fit on the page
+    auto rows = visible_rows();
+    int used = 0;
+    for (auto l = lines.size(); l > 0; --l)
+    {
+        used += line_height(lines[l - 1].count);
+        if (used > rows)
+        {
+            return std::min(l, lines.size() - 1);
+        }
+    }
+    return 0;
+}
+
+Element SystemPage::render_tile(Tile& tile)
+{
+    // Read the version first: a change made while rendering is picked up by the next frame
+    auto version = tile.device->GetVersion();
+    if (!tile.element || version != tile.version)
+    {
+        tile.version = version;
+        tile.element = DeviceView::Render(*tile.device);
+    }
+    return tile.element;
+}
+
+Element SystemPage::render_line(const Line& line)
+{
+    if (line.count == 0)
+    {
+        const auto& group = groups[line.group];
+        auto header = text(std::string(group.collapsed ? "▶ " : "▼ ") + group.title) | bold;
+        if (Focused() && top < lines.size() && lines[top].group == line.group)
+        {
+            header = header | inverted;
+        }
+        return header;
+    }
+
+    Elements row;
+    for (auto position = line.first; position < line.first + line.count; ++position)
+    {
+        row.push_back(render_tile(tiles[position]));
+    }
+    return hbox(std::move(row));
+}
+
 Element SystemPage::Render()
 {
+    if (tiles.empty())
+    {
+        return vbox() | border | flex;
+    }
+
+    auto width = std::max(ftxui::Terminal::Size().dimx - 2, DeviceView::TILE_WIDTH);
+    auto fit = static_cast<size_t>(width / DeviceView::TILE_WIDTH);
+    if (fit != columns)
+    {
+        layout(fit);
+    }
+    top = std::min(top, last_top());
+
     Elements list;
-    for (auto device : devices)
+    auto rows = visible_rows();
+    int used = 0;
+    page = 0;
+    for (auto l = top; l < lines.size(); ++l)
     {
-        list.push_back(device->Render());
+        auto height = line_height(lines[l].count);
+        if (used + height > rows && page > 0)
+        {
+            break;
+        }
+        list.push_back(render_line(lines[l]));
+        used += height;
+        page++;
     }
+    page = std::max<size_t>(page, 1);
 
-    return vflow(std::move(list)) | border | flex;
+    auto box_color = color(Color::Default);
+    if (Focused())
+    {
+        box_color = color(Color::Green);
+    }
+
+    return vbox({vbox(std::move(list)) | color(Color::Default) | flex, status_bar()}) | border | box_color | flex;
 }
 
-bool SystemPage::OnEvent(Event)
+Element SystemPage::status_bar() const
 {
-    return false;
+    // Positions of the first and last tiles on the page
+    std::optional<std::pair<size_t, size_t>> shown;
+    for (auto l = top; l < std::min(top + page, lines.size()); ++l)
+    {
+        const auto& line = lines[l];
+        if (line.count == 0)
+        {
+            continue;
+        }
+        auto last = line.first + line.count;
+        shown = shown ? std::make_pair(shown->first, last) : std::make_pair(line.first + 1, last);
+    }
+
+    std::string devices = "no devices shown";
+    if (shown)
+    {
+        devices = "devices " + std::to_string(shown->first) + "-" + std::to_string(shown->second);
+    }
+    devices += " of " + std::to_string(tiles.size()) + " in " + std::to_string(groups.size()) + " groups";
+
+    std::string group;
+    if (top < lines.size())
+    {
+        group = "  group: " + groups[lines[top].group].title;
+    }
+    return hbox({text(devices), text(group)}) | dim;
+}
+
+bool SystemPage::OnEvent(Event event)
+{
+    if (!Focused() || lines.empty())
+    {
+        return false;
+    }
+
+    auto start_top = top;
+    auto last = last_top();
+    auto group = lines[top].group;
+
+    if (event == ftxui::Event::Return)
+    {
+        toggle(group);
+        return true;
+    }
+    if (event == ftxui::Event::Character('c') || event == ftxui::Event::Character('e'))
+    {
+        for (auto& g : groups)
+        {
+            g.collapsed = (event == ftxui::Event::Character('c'));
+        }
+        layout(columns);
+        return true;
+    }
+
+    // Use arrows or vim motions to scroll the lines
+    if ((event == ftxui::Event::ArrowUp || event == ftxui::Event::Character('k')) && top > 0)
+    {
+        top--;
+    }
+    if ((event == ftxui::Event::ArrowDown || event == ftxui::Event::Character('j')) && top < last)
+    {
+        top++;
+    }
+    if (event == ftxui::Event::PageUp)
+    {
+        top = (top > page) ? top - page : 0;
+    }
+    if (event == ftxui::Event::PageDown)
+    {
+        top = std::min(top + page, last);
+    }
+    if (event == ftxui::Event::Home || event == ftxui::Event::Character('g'))
+    {
+        top = 0;
+    }
+    if (event == ftxui::Event::End || event == ftxui::Event::Character('G'))
+    {
+        top = last;
+    }
+
+    // Go to the header of the group shown, or of the previous one when already there
+    if (event == ftxui::Event::Character('['))
+    {
+        show_group((lines[top].count == 0 && group > 0) ? group - 1 : group);
+    }
+    if (event == ftxui::Event::Character(']') && group + 1 < groups.size())
+    {
+        show_group(group + 1);
+    }
+
+    return top != start_top;
 }
 
 void SystemPage::RegisterDevices(std::vector<std::shared_ptr<IDevice>> devices)
 {
-    this->devices = devices;
+    // Gather the devices of each type, in the order the types first appear
+    std::vector<std::pair<std::string, std::vector<std::shared_ptr<IDevice>>>> kinds;
+    for (const auto& device : devices)
+    {
+        DeviceKind kind;
+        device->Accept(kind);
+        auto it = std::find_if(kinds.begin(), kinds.end(), [&kind](const auto& k) { return k.first == kind.name; });
+        if (it == kinds.end())
+        {
+            kinds.emplace_back(kind.name, std::vector<std::shared_ptr<IDevice>>{});
+            it = std::prev(kinds.end());
+        }
+        it->second.push_back(device);
+    }
+
+    tiles.clear();
+    groups.clear();
+    auto collapsed = devices.size() > GROUP_SIZE;
+    for (const auto& [name, members] : kinds)
+    {
+        for (size_t n = 0; n < members.size(); n += GROUP_SIZE)
+        {
+            auto count = std::min(GROUP_SIZE, members.size() - n);
+            auto title = name + " " + std::to_string(n) + "-" + std::to_string(n + count - 1);
+            groups.push_back({title, tiles.size(), count, collapsed});
+            for (size_t m = n; m < n + count; ++m)
+            {
+                tiles.push_back({members[m], 0, nullptr});
+            }
+        }
+    }
+
+    lines.clear();
+    top = 0;
+    columns = 0;
+}
+
+bool SystemPage::Focusable() const
+{
+    return !tiles.empty();
 }
@@ -5,19 +5,76 @@
 
 #include <ftxui/component/component.hpp>
 
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
+/**
+ * SystemPage shows the devices as a grid of tiles, in groups.
+ *
+ * Devices are grouped by type, at most GROUP_SIZE to a group (e.g.
+ * "Breakers 0-499"), and each group is a header line followed by lines of
+ * tiles as wide as the page. Only the lines on screen are rendered, and the
+ * tile of a device is kept until its version changes, so the cost of a frame
+ * does not grow with the number of devices.
+ *
+ * j/k and Page Up/Down scroll the lines, g/G go to the start and end and
+ * [/] to the previous and next group. Enter collapses or expands the group
+ * at the top of the page; c collapses every group and e expands them.
+ * Groups start collapsed when there are more devices than fit in one.
+ */
 class SystemPage : public ftxui::ComponentBase
 {
 public:
+    static constexpr size_t GROUP_SIZE = 500;
+
     SystemPage() = default;
     static std::shared_ptr<SystemPage> Create();
     ftxui::Element Render() override;
+    bool Focusable() const final;
     bool OnEvent(ftxui::Event) override;
     void RegisterDevices(std::vector<std::shared_ptr<IDevice>> devices);
 
 private:
-    std::vector<std::shared_ptr<IDevice>> devices{};
+    struct Tile
+    {
+        std::shared_ptr<IDevice> device;
+        uint32_t version;
+        ftxui::Element element;
+    };
+
+    struct Group
+    {
+        std::string title;
+        size_t first; // position of the first tile of the group
+        size_t count;
+        bool collapsed;
+    };
+
+    // The header of a group when count is 0, otherwise a line of tiles
+    struct Line
+    {
+        size_t group;
+        size_t first;
+        size_t count;
+    };
+
+    std::vector<Tile> tiles{};
+    std::vector<Group> groups{};
+    std::vector<Line> lines{};
+    size_t columns = 0; // tiles per line when the lines were laid out
+    size_t top = 0;     // first line shown
+    size_t page = 1;    // number of lines shown when last rendered
+
+    int visible_rows() const;
+    void layout(size_t columns);
+    void toggle(size_t group);
+    void show_group(size_t group);
+    size_t last_top() const;
+    ftxui::Element render_line(const Line& line);
+    ftxui::Element render_tile(Tile& tile);
+    ftxui::Element status_bar() const;
 };
 
-#endif // CALDERADNP3_OUTSTATION_SYSTEM_PAGE_H
\ No newline at end of file
+#endif // CALDERADNP3_OUTSTATION_SYSTEM_PAGE_H
@@ -0,0 +1,35 @@
+#include "ui/trend.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+const char* const BLOCKS[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+} // namespace
+
+std::string TrendLine(const IMeasurement& point, size_t width)
+{
+    // Rendering happens on the UI thread only, so the samples can be read into the same buffer every time
+    static std::vector<PointHistory::Sample> samples;
+    point.ReadHistory(width, samples);
+
+    double low = 0.0;
+    double high = 0.0;
+    if (!samples.empty())
+    {
+        auto [min, max] = std::minmax_element(
+            samples.begin(), samples.end(), [](const auto& a, const auto& b) { return a.value < b.value; });
+        low = min->value;
+        high = max->value;
+    }
+
+    // A point which held one value is drawn as a flat line in the middle
+    std::string line(width - samples.size(), ' ');
+    for (const auto& sample : samples)
+    {
+        auto level = (high > low) ? static_cast<size_t>((sample.value - low) / (high - low) * 7.0 + 0.5) : 3;
+        line += BLOCKS[std::min<size_t>(level, 7)];
+    }
+    return line;
+}
@@ -0,0 +1,19 @@
+#ifndef CALDERADNP3_OUTSTATION_TREND_H
+#define CALDERADNP3_OUTSTATION_TREND_H
+
+#include "outstation/types.h"
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Renders the latest changes of a point as a line of width block characters,
+ * scaled from the lowest to the highest of the values shown.
+ *
+ * Each character is one recorded change, whatever the time between them,
+ * and the line grows from the right until the history fills it. A point
+ * without a history, or which never changed, renders as blanks.
+ */
+std::string TrendLine(const IMeasurement& point, size_t width);
+
+#endif // CALDERADNP3_OUTSTATION_TREND_H
@@ -0,0 +1,85 @@
+#include "outstation/point_history.h"
+#include "outstation/scheduler.h"
+#include "outstation/sim_clock.h"
+#include "outstation/state_region.h"
+#include "ui/renderer.h"
+
+#include <CLI11/CLI11.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+int main(int argc, char* argv[])
+{
+    std::string path;
+    size_t logLines = LogDisplayer::DEFAULT_CAPACITY;
+    unsigned int tuiFps = RedrawCoalescer::DEFAULT_FPS;
+    unsigned int interval = 50;
+    size_t historyDepth = PointHistory::DEFAULT_DEPTH;
+
+    CLI::App cli{"MITRE Caldera for OT DNP3 Outstation Viewer"};
+    cli.add_option("file", path, "file the outstation publishes its state to (--publish-state)")->required();
+    cli.add_option("--log-lines", logLines, "number of log lines kept by the visualization (default: 10000)")
+        ->check(CLI::PositiveNumber);
+    cli.add_option("--tui-fps", tuiFps, "maximum redraws per second of the visualization (default: 30)")
+        ->check(CLI::PositiveNumber);
+    cli.add_option("--history-depth", historyDepth, "changes of each point kept for the trends (default: 64)")
+        ->check(CLI::PositiveNumber);
+    cli.add_option("--interval", interval, "milliseconds between reads of the published state (default: 50)")
+        ->check(CLI::PositiveNumber);
+    CLI11_PARSE(cli, argc, argv);
+
+    std::shared_ptr<StateRegion> region;
+    try
+    {
+        region = StateRegion::Open(path);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cout << "failed to attach to the outstation, exiting" << std::endl;
+        return 1;
+    }
+
+    // The mirrored switches need a scheduler, although they never move on their own
+    auto scheduler = Scheduler::Create(1, SimClock::Default());
+    auto mirror = StateMirror::Create(region, scheduler);
+
+    // The trends start when the viewer attaches: only the changes it reads are recorded
+    auto table = mirror->GetIOTable();
+    table->RegisterHistory(PointHistory::Create(table->NumPoints(), historyDepth));
+
+    auto tui = TuiRenderer::Create();
+    tui->SetLogCapacity(logLines);
+    tui->SetFrameRate(tuiFps);
+    auto logger = tui->GetLogger();
+    tui->RegisterDevices(mirror->GetDevices());
+    tui->RegisterIOTable(table);
+
+    // Published records are logged as they were in the outstation, from the first one still buffered
+    std::atomic<bool> running{true};
+    std::thread reader([&]() {
+        uint64_t next = 0;
+        while (running)
+        {
+            region->ReadLog(next, [&logger](const char* id, opendnp3::LogLevel level, const char* message) {
+                logger->log(opendnp3::ModuleId(), id, level, "", message);
+            });
+            if (mirror->Sync())
+            {
+                tui->RequestRedraw();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+        }
+    });
+
+    tui->Init();
+
+    running = false;
+    reader.join();
+    return EXIT_SUCCESS;
+}